@@ -5,7 +5,18 @@
 
 #include <Windows.h> //https://docs.microsoft.com/en-us/previous-versions//aa383686(v=vs.85)
 #include <chrono>
-#include <map>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <coroutine>
+#include <cfloat>
+#include <emmintrin.h> //SSE2
+#pragma comment(lib, "Winmm.lib") //timeBeginPeriod() / timeEndPeriod()
 
 #define PI 3.14159265f
 #define RAD 0.01745329f
@@ -59,8 +70,38 @@
 
 namespace cmde
 {
+	//On x64 the vectors are kept in an SSE register, so the 4 components get worked on with 1 instruction
+	//	(Defining CMDE_SCALAR_MATH goes back to plain floats, for comparing; 32-bit builds also use floats since MSVC can't pass aligned structs by value there)
+#if defined(_M_X64) && !defined(CMDE_SCALAR_MATH)
+#define CMDE_SIMD_MATH
+#endif
+
 	struct VEC4F
 	{
+#ifdef CMDE_SIMD_MATH
+		union
+		{
+			__m128 m;
+			struct
+			{
+				float x;
+				float y;
+				float z;
+				float w;
+			};
+		};
+
+		VEC4F() : m(_mm_setzero_ps()) {}
+		VEC4F(float x, float y, float z, float w) : m(_mm_set_ps(w, z, y, x)) {}
+		explicit VEC4F(__m128 m) : m(m) {}
+
+		VEC4F operator* (float a) const { return VEC4F(_mm_mul_ps(m, _mm_set1_ps(a))); }
+		VEC4F operator/ (float a) const { return VEC4F(_mm_div_ps(m, _mm_set1_ps(a))); }
+		VEC4F operator* (const VEC4F& a) const { return VEC4F(_mm_mul_ps(m, a.m)); }
+		VEC4F operator+ (const VEC4F& a) const { return VEC4F(_mm_add_ps(m, a.m)); }
+		VEC4F operator- (const VEC4F& a) const { return VEC4F(_mm_sub_ps(m, a.m)); }
+		bool operator== (const VEC4F& a) const { return _mm_movemask_ps(_mm_cmpeq_ps(m, a.m)) == 0xF; }
+#else
 		float x;
 		float y;
 		float z;
@@ -75,38 +116,127 @@ namespace cmde
 			this->w = w;
 		}
 
-		VEC4F operator* (const float& a) { return VEC4F(x * a, y * a, z * a, w * a); }
-		VEC4F operator* (const double& a) { return *this * (float)a; }
-		VEC4F operator* (const int& a) { return *this * (float)a; }
-		VEC4F operator/ (const float& a) { return VEC4F(x / a, y / a, z / a, w / a); }
-		VEC4F operator* (const VEC4F& a) { return VEC4F(x * a.x, y * a.y, z * a.z, w * a.w); }
-		VEC4F operator+ (const VEC4F& a) { return VEC4F(x + a.x, y + a.y, z + a.z, w + a.w); }
-		VEC4F operator- (const VEC4F& a) { return VEC4F(x - a.x, y - a.y, z - a.z, w - a.w); }
-		bool operator== (const VEC4F& a) { return (x == a.x && y == a.y && z == a.z && w == a.w); }
+		VEC4F operator* (float a) const { return VEC4F(x * a, y * a, z * a, w * a); }
+		VEC4F operator/ (float a) const { return VEC4F(x / a, y / a, z / a, w / a); }
+		VEC4F operator* (const VEC4F& a) const { return VEC4F(x * a.x, y * a.y, z * a.z, w * a.w); }
+		VEC4F operator+ (const VEC4F& a) const { return VEC4F(x + a.x, y + a.y, z + a.z, w + a.w); }
+		VEC4F operator- (const VEC4F& a) const { return VEC4F(x - a.x, y - a.y, z - a.z, w - a.w); }
+		bool operator== (const VEC4F& a) const { return (x == a.x && y == a.y && z == a.z && w == a.w); }
+#endif
+		VEC4F operator* (double a) const { return *this * (float)a; }
+		VEC4F operator* (int a) const { return *this * (float)a; }
 	};
 	struct VEC3F : public VEC4F
 	{
-		VEC3F() { x = y = z = w = 0; }
-		VEC3F(float x, float y, float z)
-		{
-			this->x = x;
-			this->y = y;
-			this->z = z;
-			w = 0;
-		}
-		VEC3F(VEC4F v) { x = v.x; y = v.y; z = v.z; w = 0; }
+		VEC3F() {}
+		VEC3F(float x, float y, float z) : VEC4F(x, y, z, 0) {}
+#ifdef CMDE_SIMD_MATH
+		//Only for registers that already have w = 0
+		explicit VEC3F(__m128 m) : VEC4F(m) {}
+		VEC3F(const VEC4F& v) : VEC4F(_mm_and_ps(v.m, _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)))) {}
+#else
+		VEC3F(const VEC4F& v) : VEC4F(v.x, v.y, v.z, 0) {}
+#endif
 	};
 	struct VEC2F : public VEC4F
 	{
-		VEC2F() { x = y = z = w = 0; }
-		VEC2F(float x, float y)
+		VEC2F() {}
+		VEC2F(float x, float y) : VEC4F(x, y, 0, 0) {}
+#ifdef CMDE_SIMD_MATH
+		VEC2F(const VEC4F& v) : VEC4F(_mm_and_ps(v.m, _mm_castsi128_ps(_mm_set_epi32(0, 0, -1, -1)))) {}
+#else
+		VEC2F(const VEC4F& v) : VEC4F(v.x, v.y, 0, 0) {}
+#endif
+	};
+
+	//Stored as columns, so transforming a vector is adding up the columns scaled by its components
+	struct MAT4
+	{
+		VEC4F columns[4];
+
+		MAT4() : columns{ VEC4F(1, 0, 0, 0), VEC4F(0, 1, 0, 0), VEC4F(0, 0, 1, 0), VEC4F(0, 0, 0, 1) } {}
+		MAT4(VEC4F c1, VEC4F c2, VEC4F c3, VEC4F c4) : columns{ c1, c2, c3, c4 } {}
+
+						/// <summary>Builds a matrix out of its rows instead of its columns</summary>
+		static MAT4 FromRows(VEC4F r1, VEC4F r2, VEC4F r3, VEC4F r4) { return MAT4(r1, r2, r3, r4).Transposed(); }
+
+		MAT4 Transposed() const
 		{
-			this->x = x;
-			this->y = y;
-			z = 0;
-			w = 0;
+#ifdef CMDE_SIMD_MATH
+			__m128 c1 = columns[0].m;
+			__m128 c2 = columns[1].m;
+			__m128 c3 = columns[2].m;
+			__m128 c4 = columns[3].m;
+			_MM_TRANSPOSE4_PS(c1, c2, c3, c4);
+			return MAT4(VEC4F(c1), VEC4F(c2), VEC4F(c3), VEC4F(c4));
+#else
+			return MAT4({ columns[0].x, columns[1].x, columns[2].x, columns[3].x }, { columns[0].y, columns[1].y, columns[2].y, columns[3].y },
+				{ columns[0].z, columns[1].z, columns[2].z, columns[3].z }, { columns[0].w, columns[1].w, columns[2].w, columns[3].w });
+#endif
+		}
+
+		VEC4F operator* (const VEC4F& v) const
+		{
+#ifdef CMDE_SIMD_MATH
+			__m128 r = _mm_mul_ps(columns[0].m, _mm_shuffle_ps(v.m, v.m, _MM_SHUFFLE(0, 0, 0, 0)));
+			r = _mm_add_ps(r, _mm_mul_ps(columns[1].m, _mm_shuffle_ps(v.m, v.m, _MM_SHUFFLE(1, 1, 1, 1))));
+			r = _mm_add_ps(r, _mm_mul_ps(columns[2].m, _mm_shuffle_ps(v.m, v.m, _MM_SHUFFLE(2, 2, 2, 2))));
+			r = _mm_add_ps(r, _mm_mul_ps(columns[3].m, _mm_shuffle_ps(v.m, v.m, _MM_SHUFFLE(3, 3, 3, 3))));
+			return VEC4F(r);
+#else
+			return columns[0] * v.x + columns[1] * v.y + columns[2] * v.z + columns[3] * v.w;
+#endif
+		}
+		MAT4 operator* (const MAT4& a) const { return MAT4(*this * a.columns[0], *this * a.columns[1], *this * a.columns[2], *this * a.columns[3]); }
+
+						/// <summary>Transforms 'count' vectors from 'input' into 'output' (They can be the same array)</summary>
+		void Transform(const VEC4F* input, VEC4F* output, size_t count) const
+		{
+			size_t i = 0;
+#ifdef CMDE_SIMD_MATH
+			//Groups of 4 get turned sideways, so that each register holds 1 component of all 4 vectors and every instruction works on the whole group
+			__m128 m[16];
+			Broadcast(m);
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128 v[4] = { input[i].m, input[i + 1].m, input[i + 2].m, input[i + 3].m };
+				_MM_TRANSPOSE4_PS(v[0], v[1], v[2], v[3]);
+				__m128 r[4];
+				TransformGroup(m, v, r);
+				_MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+				output[i].m = r[0];
+				output[i + 1].m = r[1];
+				output[i + 2].m = r[2];
+				output[i + 3].m = r[3];
+			}
+#endif
+			for (; i < count; i++)
+			{
+				output[i] = *this * input[i];
+			}
+		}
+
+#ifdef CMDE_SIMD_MATH
+						/// <summary>Fills 'm' with every element of the matrix repeated across a register (Row by row), for TransformGroup()</summary>
+		void Broadcast(__m128 m[16]) const
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				m[c] = _mm_set1_ps(columns[c].x);
+				m[4 + c] = _mm_set1_ps(columns[c].y);
+				m[8 + c] = _mm_set1_ps(columns[c].z);
+				m[12 + c] = _mm_set1_ps(columns[c].w);
+			}
+		}
+						/// <summary>Transforms 4 vectors that have been turned sideways ('v' holds all the x's, then all the y's...), giving them back sideways in 'r'</summary>
+		static void TransformGroup(const __m128 m[16], const __m128 v[4], __m128 r[4])
+		{
+			for (int row = 0; row < 4; row++)
+			{
+				r[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[row * 4], v[0]), _mm_mul_ps(m[row * 4 + 1], v[1])), _mm_add_ps(_mm_mul_ps(m[row * 4 + 2], v[2]), _mm_mul_ps(m[row * 4 + 3], v[3])));
+			}
 		}
-		VEC2F(VEC4F v) { x = v.x; y = v.y; z = 0; w = 0; }
+#endif
 	};
 
 	struct FUNC
@@ -161,6 +291,222 @@ namespace cmde
 		}
 	};
 
+	//A value that changes linearly across a triangle on the screen (Like its depth), set up once per triangle
+	//	so that the raster loops only add 'dx' for every step sideways and 'dy' for every step down, instead of evaluating a FUNC for every cell
+	//	More attributes just need a GRADIENT each
+	struct GRADIENT
+	{
+		float dx;
+		float dy;
+		//The value at (0, 0)
+		float origin;
+
+		GRADIENT() { dx = dy = origin = 0; }
+		//Takes the screen positions of the 3 vertices in x and y, and the value at each of them in z
+		GRADIENT(VEC3F v1, VEC3F v2, VEC3F v3)
+		{
+			float area = (v2.x - v1.x) * (v3.y - v1.y) - (v3.x - v1.x) * (v2.y - v1.y);
+			if (area != 0)
+			{
+				dx = ((v2.z - v1.z) * (v3.y - v1.y) - (v3.z - v1.z) * (v2.y - v1.y)) / area;
+				dy = ((v3.z - v1.z) * (v2.x - v1.x) - (v2.z - v1.z) * (v3.x - v1.x)) / area;
+			}
+			else
+			{
+				//No area means no plane, so it just goes from the top vertex to the bottom one
+				VEC3F top = (v1.y <= v2.y ? (v1.y <= v3.y ? v1 : v3) : (v2.y <= v3.y ? v2 : v3));
+				VEC3F bottom = (v1.y > v2.y ? (v1.y > v3.y ? v1 : v3) : (v2.y > v3.y ? v2 : v3));
+				dx = 0;
+				dy = (bottom.y != top.y ? (bottom.z - top.z) / (bottom.y - top.y) : 0);
+				v1 = top;
+			}
+			origin = v1.z - dx * v1.x - dy * v1.y;
+		}
+
+		float At(float x, float y) const { return origin + dx * x + dy * y; }
+	};
+
+	//Coroutine for long one-off jobs (File parsing, mesh building, etc.) that would otherwise hitch the frame that starts them
+	//	Put 'co_await TASKSCHEDULER::Checkpoint();' between pieces of work, and TASKSCHEDULER::Run() will pause the task there once the frame's budget is spent
+	//	A TASK can 'co_await' another TASK, which runs it to completion (Across as many frames as it needs) before continuing
+	//	Starts suspended, and destroys its coroutine when it goes out of scope
+	class TASK
+	{
+	public:
+		struct promise_type;
+		typedef std::coroutine_handle<promise_type> HANDLE;
+
+	private:
+		struct FINALAWAITER
+		{
+			bool await_ready() noexcept { return false; }
+			//Goes straight back to whatever was awaiting this task (If anything)
+			std::coroutine_handle<> await_suspend(HANDLE finished) noexcept
+			{
+				std::coroutine_handle<> continuation = finished.promise().continuation;
+				return (continuation ? continuation : std::noop_coroutine());
+			}
+			void await_resume() noexcept {}
+		};
+
+		HANDLE handle;
+
+	public:
+		struct promise_type
+		{
+			std::coroutine_handle<> continuation;
+
+			TASK get_return_object() { return TASK(HANDLE::from_promise(*this)); }
+			std::suspend_always initial_suspend() noexcept { return {}; }
+			FINALAWAITER final_suspend() noexcept { return {}; }
+			void return_void() {}
+			void unhandled_exception() { std::terminate(); }
+		};
+
+		TASK() : handle(nullptr) {}
+		explicit TASK(HANDLE h) : handle(h) {}
+		TASK(TASK&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+		TASK& operator= (TASK&& other) noexcept
+		{
+			if (this != &other)
+			{
+				if (handle)
+				{
+					handle.destroy();
+				}
+				handle = other.handle;
+				other.handle = nullptr;
+			}
+			return *this;
+		}
+		TASK(const TASK&) = delete;
+		TASK& operator= (const TASK&) = delete;
+		~TASK()
+		{
+			if (handle)
+			{
+				handle.destroy();
+			}
+		}
+
+						/// <summary>Whether the task has run to the end (An empty TASK counts as done)</summary>
+		bool Done() const { return !handle || handle.done(); }
+						/// <summary>The coroutine to resume the first time the task runs</summary>
+		std::coroutine_handle<> Handle() const { return handle; }
+
+		//Awaiting a task from inside another one
+		bool await_ready() const { return Done(); }
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting)
+		{
+			handle.promise().continuation = awaiting;
+			return handle;
+		}
+		void await_resume() {}
+	};
+
+	//Runs TASKs a slice at a time, inside a time budget each frame
+	//	Tasks are resumed round-robin so 1 long task can't starve the others, and always on the thread calling Run()
+	//	Completion callbacks are held back until FlushCompleted(), so results can be swapped in at a point where nothing else is reading them
+	class TASKSCHEDULER
+	{
+	private:
+		typedef std::chrono::steady_clock Clock;
+
+		struct ENTRY
+		{
+			TASK task;
+			//The innermost coroutine that paused at a checkpoint (The task itself, or a TASK it's awaiting)
+			std::coroutine_handle<> resumePoint;
+			std::function<void()> onComplete;
+		};
+
+		std::deque<ENTRY> tasks;
+		std::vector<std::function<void()>> completed;
+
+		//Set only while Run() is resuming a task, so checkpoints outside of a scheduler never pause
+		static inline thread_local std::coroutine_handle<>* runningResumePoint = nullptr;
+		static inline thread_local Clock::time_point deadline;
+
+	public:
+		struct CHECKPOINT
+		{
+			bool await_ready() const { return runningResumePoint == nullptr || Clock::now() < deadline; }
+			void await_suspend(std::coroutine_handle<> paused) { *runningResumePoint = paused; }
+			void await_resume() const {}
+		};
+
+						/// <summary>Pauses the task until the next Run() if this frame's budget has been used up ('co_await TASKSCHEDULER::Checkpoint();')</summary>
+		static CHECKPOINT Checkpoint() { return CHECKPOINT(); }
+
+						/// <summary>
+						/// Queues a task to be run by Run()
+						/// </summary>
+						/// <param name="task">The task to run (Ownership is taken over by the scheduler)</param>
+						/// <param name="onComplete">Called from FlushCompleted() once the task has finished</param>
+		void Start(TASK task, std::function<void()> onComplete = nullptr)
+		{
+			if (task.Done())
+			{
+				if (onComplete)
+				{
+					completed.push_back(std::move(onComplete));
+				}
+				return;
+			}
+			ENTRY entry;
+			entry.resumePoint = task.Handle();
+			entry.task = std::move(task);
+			entry.onComplete = std::move(onComplete);
+			tasks.push_back(std::move(entry));
+		}
+
+						/// <summary>
+						/// Resumes queued tasks until they've all finished or 'budget' seconds have passed (At least 1 task always gets resumed, so a budget of 0 still makes progress). Returns the amount of tasks still unfinished
+						/// </summary>
+						/// <param name="budget">How long this call can spend running tasks, in seconds</param>
+		int Run(float budget)
+		{
+			deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(budget));
+			size_t resumes = 0;
+			while (!tasks.empty() && (resumes == 0 || Clock::now() < deadline))
+			{
+				ENTRY entry = std::move(tasks.front());
+				tasks.pop_front();
+				runningResumePoint = &entry.resumePoint;
+				entry.resumePoint.resume();
+				runningResumePoint = nullptr;
+				resumes++;
+				if (entry.task.Done())
+				{
+					if (entry.onComplete)
+					{
+						completed.push_back(std::move(entry.onComplete));
+					}
+				}
+				else
+				{
+					tasks.push_back(std::move(entry));
+				}
+			}
+			return (int)tasks.size();
+		}
+
+						/// <summary>Calls the completion callbacks of every task that has finished since the last call</summary>
+		void FlushCompleted()
+		{
+			//Swapped out first so callbacks can start more tasks
+			std::vector<std::function<void()>> callbacks;
+			callbacks.swap(completed);
+			for (std::function<void()>& callback : callbacks)
+			{
+				callback();
+			}
+		}
+
+						/// <summary>The amount of tasks that haven't finished yet</summary>
+		int Pending() const { return (int)tasks.size(); }
+	};
+
 	struct FILE
 	{
 		OPENFILENAMEW fileName = { 0 };
@@ -203,54 +549,11 @@ namespace cmde
 					//Reads CHUNK_SIZE at a time
 					if (ReadFile(fileHandle, &buffer, CHUNK_SIZE, &readCount, NULL))
 					{
-						if (!output->utf16)
-						{
-							//UTF-8
-							for (DWORD i = 0; i < readCount; i++)
-							{
-								//For every byte that was read, convert it into a wchar and store it at the end of what is currently stored in lineBuffer
-								lineBuffer[lineBufferPos] = (wchar_t)buffer[i];
-								lineBufferPos++;
-								if (lineBuffer[lineBufferPos - 1] == L'\n')
-								{
-									//If reached a newline character, lineBuffer now has a full line, and store where that line ends in the wbuffer
-									output->ProcessLine(lineBuffer, lineBufferPos);
-									lineBufferPos = 0;
-								}
-								if (lineBufferPos >= CHUNK_SIZE)
-								{
-									//If the line that is being read is longer than the current CHUNK_SIZE can allow
-									output = new T();
-									return false;
-								}
-							}
-						}
-						else
+						if (!DecodeChunk(output, buffer, readCount, lineBuffer, lineBufferPos))
 						{
-							//UTF-16
-							char wcharBytes[3] = { 0 };
-							wchar_t wchar[2] = { 0 };
-							for (DWORD i = 0; i < readCount; i += 2)
-							{
-								//For every byte that was read, convert it into a wchar and store it at the end of what is currently stored in lineBuffer
-								wcharBytes[0] = buffer[i];
-								wcharBytes[1] = buffer[i + 1];
-								MultiByteToWideChar(CP_UTF8, 0, wcharBytes, 3, wchar, 2);
-								lineBuffer[lineBufferPos] = wchar[0];
-								lineBufferPos++;
-								if (lineBuffer[lineBufferPos - 1] == L'\n')
-								{
-									//If reached a newline character, lineBuffer now has a full line, and store where that line ends in the wbuffer
-									output->ProcessLine(lineBuffer, lineBufferPos);
-									lineBufferPos = 0;
-								}
-								if (lineBufferPos >= CHUNK_SIZE)
-								{
-									//If the line that is being read is longer than the current CHUNK_SIZE can allow
-									output = new T();
-									return false;
-								}
-							}
+							//If the line that is being read is longer than the current CHUNK_SIZE can allow
+							output = new T();
+							return false;
 						}
 					}
 					else
@@ -295,42 +598,10 @@ namespace cmde
 			//tempLow bytes remain unread in the file (Less than CHUNK_SIZE)
 			if (ReadFile(fileHandle, &buffer, tempLow, &readCount, NULL))
 			{
-				if (!output->utf16)
-				{
-					//UTF-8
-					for (DWORD i = 0; i < readCount; i++)
-					{
-						//For every byte that was read, convert it into a wchar and store it at the end of what is currently stored in lineBuffer
-						lineBuffer[lineBufferPos] = (wchar_t)buffer[i];
-						lineBufferPos++;
-						if (lineBuffer[lineBufferPos - 1] == L'\n')
-						{
-							//If reached a newline character, lineBuffer now has a full line, and store where that line ends in the wbuffer
-							output->ProcessLine(lineBuffer, lineBufferPos);
-							lineBufferPos = 0;
-						}
-					}
-				}
-				else
+				if (!DecodeChunk(output, buffer, readCount, lineBuffer, lineBufferPos))
 				{
-					//UTF-16
-					char wcharBytes[3] = { 0 };
-					wchar_t wchar[2] = { 0 };
-					for (DWORD i = 0; i < readCount; i += 2)
-					{
-						//For every byte that was read, convert it into a wchar and store it at the end of what is currently stored in lineBuffer
-						wcharBytes[0] = buffer[i];
-						wcharBytes[1] = buffer[i + 1];
-						MultiByteToWideChar(CP_UTF8, 0, wcharBytes, 3, wchar, 2);
-						lineBuffer[lineBufferPos] = wchar[0];
-						lineBufferPos++;
-						if (lineBuffer[lineBufferPos - 1] == L'\n')
-						{
-							//If reached a newline character, lineBuffer now has a full line, and store where that line ends in the wbuffer
-							output->ProcessLine(lineBuffer, lineBufferPos);
-							lineBufferPos = 0;
-						}
-					}
+					output = new T();
+					return false;
 				}
 			}
 			else
@@ -350,6 +621,40 @@ namespace cmde
 			return false;
 		}
 
+						/// <summary>
+						/// Same as ProcessFile(), but as a TASK that reads 1 chunk at a time and checks the task budget between chunks, so big files get spread across frames
+						/// </summary>
+						/// <param name="file">The file to read (Taken by value, since the task can outlive the variable it was started from)</param>
+						/// <param name="output">Where the data read will be stored. Only safe to use once the task has finished</param>
+		template <class T>
+		static TASK ProcessFileAsync(FILE file, std::shared_ptr<T> output)
+		{
+			byte buffer[CHUNK_SIZE] = { 0 };
+			wchar_t lineBuffer[CHUNK_SIZE] = { 0 };
+			unsigned long lineBufferPos = 0; //The position in lineBuffer where the last line stopped
+			DWORD readCount = 0;
+
+			//Synchronous reads only come back with 0 bytes once the end of the file has been reached
+			while (ReadFile(file.fileHandle, &buffer, CHUNK_SIZE, &readCount, NULL) && readCount > 0)
+			{
+				if (!DecodeChunk(output.get(), buffer, readCount, lineBuffer, lineBufferPos))
+				{
+					//If the line that is being read is longer than the current CHUNK_SIZE can allow
+					CloseHandle(file.fileHandle);
+					co_return;
+				}
+				co_await TASKSCHEDULER::Checkpoint();
+			}
+			if (lineBufferPos != 0)
+			{
+				//If the document doesn't end with a new line character, stick one on the end and pass the line to the function
+				lineBuffer[lineBufferPos] = L'\n';
+				lineBufferPos++;
+				output->ProcessLine(lineBuffer, lineBufferPos);
+			}
+			CloseHandle(file.fileHandle);
+		}
+
 						/// <summary>
 						/// Compares this file's extension to the one passed to this function
 						/// </summary>
@@ -358,6 +663,61 @@ namespace cmde
 		{
 			return wcscmp(this->extension, extension) == 0;
 		}
+
+	private:
+						/// <summary>
+						/// Converts 'readCount' bytes of 'buffer' into characters at the end of lineBuffer, passing every full line to the output. Returns false if a line doesn't fit within CHUNK_SIZE
+						/// </summary>
+		template <class T>
+		static bool DecodeChunk(T* output, byte* buffer, DWORD readCount, wchar_t* lineBuffer, unsigned long& lineBufferPos)
+		{
+			if (!output->utf16)
+			{
+				//UTF-8
+				for (DWORD i = 0; i < readCount; i++)
+				{
+					//For every byte that was read, convert it into a wchar and store it at the end of what is currently stored in lineBuffer
+					lineBuffer[lineBufferPos] = (wchar_t)buffer[i];
+					lineBufferPos++;
+					if (lineBuffer[lineBufferPos - 1] == L'\n')
+					{
+						//If reached a newline character, lineBuffer now has a full line, and store where that line ends in the wbuffer
+						output->ProcessLine(lineBuffer, lineBufferPos);
+						lineBufferPos = 0;
+					}
+					if (lineBufferPos >= CHUNK_SIZE)
+					{
+						return false;
+					}
+				}
+			}
+			else
+			{
+				//UTF-16
+				char wcharBytes[3] = { 0 };
+				wchar_t wchar[2] = { 0 };
+				for (DWORD i = 0; i < readCount; i += 2)
+				{
+					//For every byte that was read, convert it into a wchar and store it at the end of what is currently stored in lineBuffer
+					wcharBytes[0] = buffer[i];
+					wcharBytes[1] = buffer[i + 1];
+					MultiByteToWideChar(CP_UTF8, 0, wcharBytes, 3, wchar, 2);
+					lineBuffer[lineBufferPos] = wchar[0];
+					lineBufferPos++;
+					if (lineBuffer[lineBufferPos - 1] == L'\n')
+					{
+						//If reached a newline character, lineBuffer now has a full line, and store where that line ends in the wbuffer
+						output->ProcessLine(lineBuffer, lineBufferPos);
+						lineBufferPos = 0;
+					}
+					if (lineBufferPos >= CHUNK_SIZE)
+					{
+						return false;
+					}
+				}
+			}
+			return true;
+		}
 	};
 	struct PROCESSEDFILE
 	{
@@ -396,1174 +756,4065 @@ namespace cmde
 	};
 
 
-	class CMDEngine
+	//Keeps frames evenly spaced without burning a whole core on a busy-wait
+	//	Sleep() is only as precise as the scheduler tick (~1ms with 'timeBeginPeriod(1)', ~15.6ms without), so it sleeps in small slices
+	//	until the remaining time falls within the worst oversleep seen so far, and then spins the rest of the way on the steady clock
+	//	(steady_clock, unlike system_clock, never jumps when the wall clock gets adjusted)
+	struct FRAMEPACER
 	{
-	private:
-		HANDLE console;
-		HANDLE consoleInput;
-		HWND window;
-		SMALL_RECT sr;
-		bool upscale;
-		wchar_t _msg[128];
-		COORD _screenSize;
-		int _pixelCount;
-		float _deltaTime;
-		CHAR_INFO* screen;
-	public:
-		const COORD& screenSize = _screenSize;
-		const int& pixelCount = _pixelCount;
-		const float& deltaTime = _deltaTime;
-		bool running;
-		CHAR_INFO emptyChar;
-		bool autoClearScreen;
-		wchar_t title[256];
-		float fpsLimit;
-		float* zBuffer;
+		typedef std::chrono::steady_clock Clock;
 
-		//More data: float quickest = 100; float sum = 0; float frameAmount = 0;
+		Clock::time_point lastFrame;
+		Clock::time_point nextFrame;
+		//How far a 1ms sleep has been seen to overshoot (Starts pessimistic and adapts to the machine)
+		Clock::duration sleepOvershoot;
+		//How long the last frame spent sleeping and spinning, in seconds (For profiling)
+		float sleptTime;
+		float spunTime;
 
-						/// <summary>0 -> nothing ; 1 -> released ; 2 -> pressed ; 3 -> held ; MOUSE_X and MOUSE_Y -> point on the command prompt</summary>
-		std::map<wchar_t, short> inputs;
+		FRAMEPACER()
+		{
+			Reset();
+			sleepOvershoot = std::chrono::milliseconds(2);
+			sleptTime = spunTime = 0;
+		}
+
+						/// <summary>Restarts the timing, so that the next frame is measured from now</summary>
+		void Reset()
+		{
+			lastFrame = nextFrame = Clock::now();
+		}
 
 						/// <summary>
-						/// Constructor for the command prompt engine
+						/// Blocks until at least 'frameTime' seconds have passed since the previous frame, and returns how long it has actually been (The new deltaTime)
 						/// </summary>
-						/// <param name="screenWidth">The width of the command prompt in characters</param>
-						/// <param name="screenHeight">The height of the command prompt in characters</param>
-						/// <param name="fontWidth">The width of the characters in pixels</param>
-						/// <param name="fontHeight">The height of the characters in pixels (Less than 3 may cause lines between pixels; 1 may cause distortions for some resolutions)</param>
-						/// <param name="autoUpscale">Whether to automatically scale the font up so that it occupies the most amount of screen space</param>
-						/// <param name="clearScreen">Whether to automatically clear the screen at the beginning of 'Update()' (You can do so manually with the 'ClearFrame()' function)</param>
-						/// <param name="maxFPS">The minimum amount of time before the next frame is drawn (1/fps). Setting this to 0 or less will allow for infinte framerate</param>
-		CMDEngine(short screenWidth, short screenHeight, short fontWidth = 1, short fontHeight = 1, bool autoUpscale = true, bool clearScreen = true, float maxFPS = FPS60)
+						/// <param name="frameTime">The minimum amount of time between frames (1/fps). 0 or less doesn't wait at all</param>
+		float WaitForNextFrame(float frameTime)
 		{
-			upscale = autoUpscale;
-			_screenSize = { (short)screenWidth, (short)screenHeight };
-			_pixelCount = screenWidth * screenHeight;
-			autoClearScreen = clearScreen;
-			running = true;
-			if (fontWidth > 30 || fontHeight > 30)
-			{
-				ThrowError(L"FontTooBig (30)");
-				return;
-			}
-			if (screenWidth < 15 || screenHeight < 2 || fontWidth < 1 || fontHeight < 1)
+			Clock::time_point now = Clock::now();
+			Clock::time_point start = now;
+			sleptTime = spunTime = 0;
+			if (frameTime > 0)
 			{
-				ThrowError(L"SmallerThanMin (15, 2, 1, 1)");
-				return;
+				Clock::duration step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(frameTime));
+				nextFrame += step;
+				if (nextFrame < now)
+				{
+					//Fell more than a whole frame behind, so there's no point in trying to catch up (It would only produce a burst of 0 length frames)
+					nextFrame = now;
+				}
+				//Coarse wait
+				while (nextFrame - now > sleepOvershoot + std::chrono::milliseconds(1))
+				{
+					Clock::time_point before = now;
+					Sleep(1);
+					now = Clock::now();
+					//Learns how much a 1ms sleep can overshoot, and slowly forgets old spikes so a single hiccup doesn't make it spin forever
+					Clock::duration overshoot = now - before - std::chrono::milliseconds(1);
+					sleepOvershoot = (overshoot > sleepOvershoot ? overshoot : sleepOvershoot - (sleepOvershoot - overshoot) / 64);
+				}
+				sleptTime = std::chrono::duration<float>(now - start).count();
+				//Fine wait
+				while (now < nextFrame)
+				{
+					_mm_pause();
+					now = Clock::now();
+				}
+				spunTime = std::chrono::duration<float>(now - start).count() - sleptTime;
 			}
-			screen = new CHAR_INFO[_pixelCount];
-			zBuffer = new float[pixelCount];
-			_deltaTime = 0;
-			emptyChar.Char.UnicodeChar = 0x2588;
-			emptyChar.Attributes = 0x0000;
-			inputs.insert(std::pair<wchar_t, short>(RALT, 0));
-			inputs.insert(std::pair<wchar_t, short>(LALT, 0));
-			inputs.insert(std::pair<wchar_t, short>(RCTRL, 0));
-			inputs.insert(std::pair<wchar_t, short>(LCTRL, 0));
-			inputs.insert(std::pair<wchar_t, short>(SHIFT, 0));
-			inputs.insert(std::pair<wchar_t, short>(MOUSE_DCLICK, 0));
-			inputs.insert(std::pair<wchar_t, short>(MOUSE_SCROLL, 0));
-			inputs.insert(std::pair<wchar_t, short>(MOUSE_BTN + 0, 0));
-			inputs.insert(std::pair<wchar_t, short>(MOUSE_BTN + 1, 0));
-			inputs.insert(std::pair<wchar_t, short>(MOUSE_BTN + 2, 0));
-			inputs.insert(std::pair<wchar_t, short>(MOUSE_BTN + 3, 0));
-			inputs.insert(std::pair<wchar_t, short>(MOUSE_BTN + 4, 0));
-			inputs.insert(std::pair<wchar_t, short>(MOUSE_BTN + 5, 0));
-			inputs.insert(std::pair<wchar_t, short>(MOUSE_BTN + 6, 0));
-			inputs.insert(std::pair<wchar_t, short>(MOUSE_BTN + 7, 0));
-			inputs.insert(std::pair<wchar_t, short>(MOUSE_X, 0));
-			inputs.insert(std::pair<wchar_t, short>(MOUSE_Y, 0));
-			SetTitle(L"CMDEngine Program");
-			if (maxFPS > 0)
+			else
 			{
-				fpsLimit = maxFPS;
+				nextFrame = now;
 			}
+			float delta = std::chrono::duration<float>(now - lastFrame).count();
+			lastFrame = now;
+			return delta;
+		}
+	};
 
-			//Setting up the console window (Not entirely sure about what everything here does, had to copy most of it due to the complexity)
-#pragma region ConsoleWindowSetup
-		//Creates an object that then basically functions as the console
-			console = CreateConsoleScreenBuffer(GENERIC_READ | GENERIC_WRITE, 0, NULL, CONSOLE_TEXTMODE_BUFFER, NULL);
-			//Gets a reference to the input handler
-			consoleInput = GetStdHandle(STD_INPUT_HANDLE);
-			//Changes some of the input handler's settings (Prevents highlighting and permits reading mouse input)
-			SetConsoleMode(consoleInput, ENABLE_EXTENDED_FLAGS | ENABLE_MOUSE_INPUT);
-			//Set the window size to the smallest possible
-			sr = { 0, 0, 1, 1 };
-			SetConsoleWindowInfo(console, true, &sr);
-			//Set the buffer size to the wanted size
-			if (!SetConsoleScreenBufferSize(console, _screenSize))
+	//Work-stealing job scheduler
+	//	Every thread (the workers, plus the engine's own thread as worker 0) has its own deque of jobs: it pushes and pops its own work at the back
+	//	(Most recently split work is the hottest in the cache), and when it runs out it steals the oldest job from the front of someone else's deque
+	//	Jobs can depend on other jobs (They only get queued once all of their dependencies have finished) and can have a parent
+	//	(The parent only counts as finished once all of its children have), which is what the fork/join helpers are built from
+	//	Any thread that waits on a job keeps running other jobs in the meantime, so waiting from inside a job doesn't deadlock
+	class JOBSYSTEM
+	{
+	public:
+		struct JOB
+		{
+			std::function<void()> task;
+			//1 for the job itself + 1 for every child that hasn't finished yet
+			std::atomic<int> unfinished;
+			//1 for being scheduled + 1 for every dependency that hasn't finished yet
+			std::atomic<int> pendingDependencies;
+			std::shared_ptr<JOB> parent;
+			std::mutex dependentsLock;
+			std::vector<std::shared_ptr<JOB>> dependents;
+			bool finished;
+
+			JOB() { unfinished = 1; pendingDependencies = 1; finished = false; }
+		};
+		typedef std::shared_ptr<JOB> JOBHANDLE;
+
+		struct STATS
+		{
+			//Jobs sitting in the deques right now
+			int queueDepth;
+			//Totals since the job system was (re)configured
+			long long executed;
+			long long steals;
+			int workerCount;
+		};
+
+	private:
+		struct WORKER
+		{
+			std::mutex lock;
+			std::deque<JOBHANDLE> jobs;
+			std::thread thread;
+		};
+		//Which job system and deque the current thread belongs to
+		struct THREADSLOT
+		{
+			JOBSYSTEM* owner;
+			int index;
+		};
+
+		//Index 0 is the engine's thread, which doesn't get a std::thread
+		std::vector<std::unique_ptr<WORKER>> workers;
+		std::atomic<int> queued;
+		std::atomic<long long> executed;
+		std::atomic<long long> steals;
+		std::atomic<bool> stopping;
+		std::mutex sleepLock;
+		std::condition_variable wakeUp;
+		bool pinned;
+
+		static THREADSLOT& Slot()
+		{
+			static thread_local THREADSLOT slot = { nullptr, 0 };
+			return slot;
+		}
+
+		//Threads that don't belong to this job system (Like the input thread) queue their jobs on the engine thread's deque
+		int CurrentIndex() { return (Slot().owner == this ? Slot().index : 0); }
+
+		void Push(JOBHANDLE job)
+		{
+			WORKER& w = *workers[CurrentIndex()];
 			{
-				ThrowError(L"SetConsoleScreenBufferSize");
-				return;
+				std::lock_guard<std::mutex> guard(w.lock);
+				w.jobs.push_back(job);
 			}
-			//Assign the console object to the actual console (From now on changes to the console object will affect the actual console)
-			if (!SetConsoleActiveScreenBuffer(console))
+			queued++;
+			wakeUp.notify_one();
+		}
+
+		JOBHANDLE Pop(int index)
+		{
+			//Own deque first (LIFO)
+			WORKER& w = *workers[index];
 			{
-				ThrowError(L"SetConsoleActiveScreenBuffer");
-				return;
+				std::lock_guard<std::mutex> guard(w.lock);
+				if (!w.jobs.empty())
+				{
+					JOBHANDLE job = w.jobs.back();
+					w.jobs.pop_back();
+					queued--;
+					return job;
+				}
 			}
-
-			//Setting the cursor visibility
-			CONSOLE_CURSOR_INFO cci = CONSOLE_CURSOR_INFO();
-			cci.bVisible = false;
-			cci.dwSize = 3;
-			SetConsoleCursorInfo(console, &cci);
-
-			//Setting the character size and font
-			CONSOLE_FONT_INFOEX cfi = CONSOLE_FONT_INFOEX();
-			cfi.cbSize = sizeof(cfi);
-			cfi.dwFontSize.X = fontWidth;
-			cfi.dwFontSize.Y = fontHeight;
-			cfi.FontFamily = FF_DONTCARE;
-			cfi.FontWeight = FW_NORMAL;
-			//Don't know why, but  ' cfi.FaceName = L"Liberation Mono"; '  doesn't work, so instead 'wcscpy_s' has to be used
-			//	this copies the wide character string in the 2nd parameter into the variable in the 1st parameter
-			//wcscpy_s(cfi.FaceName, L"Liberation Mono");
-			if (!SetCurrentConsoleFontEx(console, false, &cfi))
+			//Then steal from everyone else's (FIFO), starting from the next one over so thieves spread out
+			for (size_t i = 1; i < workers.size(); i++)
 			{
-				ThrowError(L"SetConsoleActiveScreenBuffer");
-				return;
+				WORKER& victim = *workers[(index + i) % workers.size()];
+				std::lock_guard<std::mutex> guard(victim.lock);
+				if (!victim.jobs.empty())
+				{
+					JOBHANDLE job = victim.jobs.front();
+					victim.jobs.pop_front();
+					queued--;
+					steals++;
+					return job;
+				}
 			}
+			return nullptr;
+		}
 
-			//Check to see if the wanted size is too big for the screen
-			CONSOLE_SCREEN_BUFFER_INFO csbi;
-			if (!GetConsoleScreenBufferInfo(console, &csbi))
+		void Execute(const JOBHANDLE& job)
+		{
+			if (job->task)
 			{
-				ThrowError(L"GetConsoleScreenBufferInfo");
-				return;
+				job->task();
 			}
-			if (_screenSize.Y > csbi.dwMaximumWindowSize.Y)
+			executed++;
+			Finish(job);
+		}
+
+		void Finish(JOBHANDLE job)
+		{
+			while (job && --job->unfinished == 0)
 			{
-				swprintf(_msg, 128, L"Screen Height / Font Height Too Big (%d * %d)", csbi.dwMaximumWindowSize.Y, fontHeight);
-				ThrowError(_msg);
-				return;
+				std::vector<JOBHANDLE> ready;
+				{
+					std::lock_guard<std::mutex> guard(job->dependentsLock);
+					job->finished = true;
+					ready.swap(job->dependents);
+				}
+				for (JOBHANDLE& d : ready)
+				{
+					Release(d);
+				}
+				//A finished child counts down its parent
+				JOBHANDLE parent = job->parent;
+				job->parent = nullptr;
+				job = parent;
 			}
-			if (_screenSize.X > csbi.dwMaximumWindowSize.X)
+		}
+
+		void Release(const JOBHANDLE& job)
+		{
+			if (--job->pendingDependencies == 0)
 			{
-				swprintf(_msg, 128, L"Screen Width / Font Width Too Big (%d * %d)", csbi.dwMaximumWindowSize.X, fontWidth);
-				ThrowError(_msg);
-				return;
+				Push(job);
 			}
+		}
 
-			//Tries to scale the font up to make the window occupy the most screen space possible
-			if (autoUpscale)
+		void WorkerLoop(int index)
+		{
+			Slot() = { this, index };
+			while (!stopping)
 			{
-				float fontRatio = ((float)fontWidth) / ((float)fontHeight);
-				short tFW = fontWidth;
-				short tFH = fontHeight;
-				short i = 1;
-				while (true)
+				JOBHANDLE job = Pop(index);
+				if (job)
 				{
-					if ((fontRatio * i) == (trunc(fontRatio * i)))
-					{
-						cfi.dwFontSize.X = fontWidth + (short)(fontRatio * i);
-						cfi.dwFontSize.Y = fontHeight + i;
-						SetCurrentConsoleFontEx(console, false, &cfi);
-						GetConsoleScreenBufferInfo(console, &csbi);
-						if (_screenSize.X > csbi.dwMaximumWindowSize.X || _screenSize.Y > csbi.dwMaximumWindowSize.Y)
-						{
-							break;
-						}
-						tFW = fontWidth + (short)(fontRatio * i);
-						tFH = fontHeight + i;
-					}
-					i++;
+					Execute(job);
+				}
+				else
+				{
+					std::unique_lock<std::mutex> guard(sleepLock);
+					wakeUp.wait_for(guard, std::chrono::milliseconds(2), [this]() { return stopping || queued > 0; });
 				}
-				cfi.dwFontSize.X = tFW;
-				cfi.dwFontSize.Y = tFH;
-				SetCurrentConsoleFontEx(console, false, &cfi);
-				GetConsoleScreenBufferInfo(console, &csbi);
 			}
+			Slot() = { nullptr, 0 };
+		}
 
-			//Set the window size to the wanted screen size
-			sr = { 0, 0, (short)(screenWidth - 1), (short)(screenHeight - 1) };
-			if (!SetConsoleWindowInfo(console, true, &sr))
+		void Stop()
+		{
 			{
-				ThrowError(L"SetConsoleWindowInfo");
-				return;
+				std::lock_guard<std::mutex> guard(sleepLock);
+				stopping = true;
 			}
-#pragma endregion
-
-			//Gets a reference to the program window and changes some settings
-#pragma region WindowSettings
-		//Sets the title of the program to something random in order to distinguish it from the other programs on the computer
-			int temp = rand();
-			swprintf(_msg, 128, L"%d", temp);
-			SetConsoleTitle(_msg);
-			Sleep(40);
-			//Finds the window with that random name (Don't have to set it back to normal cause the 'UpdateTitle()' is run every frame anyways)
-			window = FindWindowW(NULL, _msg);
-			//Changes the window's settings (Prevents maximizing, minimizing, and resizing)
-			SetWindowLongPtrW(window, GWL_STYLE, WS_OVERLAPPEDWINDOW & ~(WS_MAXIMIZEBOX | WS_MINIMIZEBOX | WS_SIZEBOX));
-			::SetWindowPos(window, HWND_TOPMOST, 0, 0, 0, 0, SWP_SHOWWINDOW | SWP_NOSIZE | SWP_NOREPOSITION);
-#pragma endregion
+			wakeUp.notify_all();
+			for (size_t i = 1; i < workers.size(); i++)
+			{
+				workers[i]->thread.join();
+			}
+			//Anything still queued gets run here, so nothing that's being waited on gets lost
+			if (!workers.empty())
+			{
+				for (JOBHANDLE job = Pop(0); job; job = Pop(0))
+				{
+					Execute(job);
+				}
+			}
+			workers.clear();
 		}
 
+	public:
 						/// <summary>
-						/// Prints an error message to the console (Returns 0 so that you can just do 'return ThrowError(...);')
+						/// Creates the job system and starts its worker threads
 						/// </summary>
-						/// <param name="msg">The message to print to the console</param>
-		int ThrowError(const wchar_t* msg)
+						/// <param name="workerCount">The amount of threads that run jobs, counting the thread that owns the job system (0 or less uses every hardware thread)</param>
+						/// <param name="pinThreads">Whether to lock each thread to its own core (Worker i runs on core i; the owner thread on core 0)</param>
+		JOBSYSTEM(int workerCount = 0, bool pinThreads = false)
 		{
-			wchar_t _error[128];
-			FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM, NULL, GetLastError(), MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), _error, 128, NULL);
-			wprintf(L"ERROR: %s\n\t%s\n", msg, _error);
-			running = false;
-			return 0;
+			queued = 0;
+			executed = 0;
+			steals = 0;
+			stopping = false;
+			pinned = false;
+			Configure(workerCount, pinThreads);
 		}
 
-		bool OnScreen(short x, short y) { return (x >= 0 && y >= 0 && x < screenSize.X&& y < screenSize.Y); }
-		bool OnScreen(VEC2F p) { return (p.x >= 0 && p.y >= 0 && p.x < screenSize.X&& p.y < screenSize.Y); }
+		~JOBSYSTEM() { Stop(); }
 
-#pragma region DrawFunctions
-		//Simply modifies the value of the specified position in the screen array
-#pragma region Draw
-						/// <summary>
-						/// Draws to a specific point on the command prompt
-						/// </summary>
-						/// <param name="x">The x position of the point (Leftmost is 0; Rightmost is screenSize.X)</param>
-						/// <param name="y">The y position of the point (Topmost is 0; Bottommost is screenSize.Y)</param>
-						/// <param name="col">The color with which to draw to that point (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param>
-						/// <param name="cha">The character with which to draw to that point</param>
-						/// <param name="depth">How far away from the camera the pixel is (For rendering things on top of each other) (Negative values are always drawn)</param>
-		void Draw(short x, short y, short col = 0x000F, short cha = 0x2588, float depth = -1)
+						/// <summary>Restarts the job system with a different amount of threads (Must be called from the thread that owns it, while no jobs are running)</summary> /// <param name="workerCount">The amount of threads that run jobs, counting the thread that owns the job system (0 or less uses every hardware thread)</param> /// <param name="pinThreads">Whether to lock each thread to its own core (Worker i runs on core i; the owner thread on core 0)</param>
+		void Configure(int workerCount, bool pinThreads = false)
 		{
-			if (OnScreen(x, y) && depth < zBuffer[y * screenSize.X + x])
+			Stop();
+			if (workerCount <= 0)
+			{
+				workerCount = max(1, (int)std::thread::hardware_concurrency());
+			}
+			stopping = false;
+			executed = 0;
+			steals = 0;
+			pinned = pinThreads;
+			Slot() = { this, 0 };
+			for (int i = 0; i < workerCount; i++)
+			{
+				workers.push_back(std::unique_ptr<WORKER>(new WORKER()));
+			}
+			for (int i = 1; i < workerCount; i++)
+			{
+				workers[i]->thread = std::thread(&JOBSYSTEM::WorkerLoop, this, i);
+				if (pinThreads)
+				{
+					SetThreadAffinityMask(workers[i]->thread.native_handle(), (DWORD_PTR)1 << (i % (sizeof(DWORD_PTR) * 8)));
+				}
+			}
+			if (pinThreads)
 			{
-				screen[y * screenSize.X + x].Char.UnicodeChar = cha;
-				screen[y * screenSize.X + x].Attributes = col;
-				zBuffer[y * screenSize.X + x] = depth;
+				SetThreadAffinityMask(GetCurrentThread(), 1);
 			}
 		}
-						/// <summary>Draws to a specific point on the command prompt</summary> /// <param name="x">The x position of the point (Leftmost is 0; Rightmost is screenSize.X)</param> /// <param name="y">The y position of the point (Topmost is 0; Bottommost is screenSize.Y)</param> /// <param name="col">The color with which to draw to that point (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw to that point</param> /// <param name="depth">How far away from the camera the pixel is (For rendering things on top of each other) (Negative values are always drawn)</param>
-		void Draw(int x, int y, short col = 0x000F, short cha = 0x2588, float depth = -1) { Draw((short)x, (short)y, col, cha, depth); }
-		//Due to issues with numbers between 0-1 when casting, '(short)((short)(x + 2) - 2)' is needed, since numbers between 2-3 convert correctly
-						/// <summary>Draws to a specific point on the command prompt</summary> /// <param name="x">The x position of the point (Leftmost is 0; Rightmost is screenSize.X)</param> /// <param name="y">The y position of the point (Topmost is 0; Bottommost is screenSize.Y)</param> /// <param name="col">The color with which to draw to that point (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw to that point</param> /// <param name="depth">How far away from the camera the pixel is (For rendering things on top of each other) (Negative values are always drawn)</param>
-		void Draw(float x, float y, short col = 0x000F, short cha = 0x2588, float depth = -1) { Draw((short)((short)(x + 2) - 2), (short)((short)(y + 2) - 2), col, cha, depth); }
-						/// <summary>Draws to a specific point on the command prompt</summary> /// <param name="p">The position of the point (Leftmost is 0; Rightmost is screenSize.X; Topmost is 0; Bottommost is screenSize.Y)</param> /// <param name="col">The color with which to draw to that point (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw to that point</param> /// <param name="depth">How far away from the camera the pixel is (For rendering things on top of each other) (Negative values are always drawn)</param>
-		void Draw(VEC2F p, short col = 0x000F, short cha = 0x2588, float depth = -1) { Draw((short)((short)(p.x + 2) - 2), (short)((short)(p.y + 2) - 2), col, cha, depth); }
-#pragma endregion
 
-		//Gets the step size for the reaction in 1 axis when moving 1 unit in the other
-		//	by going from point 1 to point 2 like this in both axis, you can find every space through which the line crosses
-		//	but because they're floats, the points may not be exactly in a space, so for the first step you have to move less than 1 in the axis
-		//	after the first movement in each axis, the movements can be by 1 unit
-		//If the points are whole numbers, the first step can be skipped due to knowing that the points will always be exactly in a space
-		//Using relative screen space for the points is the same as normal, but with the added step of converting the coordinates first
-#pragma region DrawLine
+		int WorkerCount() { return (int)workers.size(); }
+
+		STATS GetStats() { return { queued.load(), executed.load(), steals.load(), (int)workers.size() }; }
+
 						/// <summary>
-						/// Draws a line on the command prompt from a point to another point
+						/// Queues a function to be run by any of the threads, once all of its dependencies have finished
 						/// </summary>
-						/// <param name="x1">The x position of the first point (Leftmost is 0; Rightmost is screenSize.X)</param>
-						/// <param name="y1">The y position of the first point (Topmost is 0; Bottommost is screenSize.Y)</param>
-						/// <param name="x2">The x position of the second point (Leftmost is 0; Rightmost is screenSize.X)</param>
-						/// <param name="y2">The y position of the second point (Topmost is 0; Bottommost is screenSize.Y)</param>
-						/// <param name="col">The color with which to draw the line (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param>
-						/// <param name="cha">The character with which to draw the line</param>
-						/// <param name="depth1">How far away from the camera the first point is (For rendering things on top of each other) (Negative values are always drawn)</param>
-						/// <param name="depth2">How far away from the camera the second point is (For rendering things on top of each other) (Negative values are always drawn)</param>
-		void DrawLine(float x1, float y1, float x2, float y2, short col = 0x000F, short cha = 0x2588, float depth1 = -1, float depth2 = -1)
+						/// <param name="task">The function to run</param>
+						/// <param name="dependencies">Jobs that must finish before this one can start</param>
+						/// <param name="parent">A job that won't count as finished until this one has (For fork/join)</param>
+		JOBHANDLE Schedule(std::function<void()> task, std::initializer_list<JOBHANDLE> dependencies = {}, JOBHANDLE parent = nullptr) { return Schedule(std::move(task), dependencies.begin(), dependencies.end(), parent); }
+						/// <summary>Queues a function to be run by any of the threads, once all of its dependencies have finished</summary> /// <param name="task">The function to run</param> /// <param name="dependencies">Jobs that must finish before this one can start</param> /// <param name="parent">A job that won't count as finished until this one has (For fork/join)</param>
+		JOBHANDLE Schedule(std::function<void()> task, const std::vector<JOBHANDLE>& dependencies, JOBHANDLE parent = nullptr) { return Schedule(std::move(task), dependencies.data(), dependencies.data() + dependencies.size(), parent); }
+
+						/// <summary>Queues a function to be run by any of the threads, once all of its dependencies have finished</summary> /// <param name="task">The function to run</param> /// <param name="firstDependency">Start of an array of jobs that must finish before this one can start</param> /// <param name="lastDependency">End of that array (Exclusive)</param> /// <param name="parent">A job that won't count as finished until this one has (For fork/join)</param>
+		JOBHANDLE Schedule(std::function<void()> task, const JOBHANDLE* firstDependency, const JOBHANDLE* lastDependency, JOBHANDLE parent)
 		{
-			short ux = (x1 < x2 ? 1 : -1), uy = (y1 < y2 ? 1 : -1);
-			float tx = x2 - x1, ty = y2 - y1;
-			float sx = (ty != 0 ? ux * abs(tx / ty) : 0), sy = (tx != 0 ? uy * abs(ty / tx) : 0);
-			Draw(x1, y1, col, cha, depth1);
-			Draw(x2, y2, col, cha, depth2);
-			tx = (float)fmod(ux - fmod(x1, 1.0f), 1.0f);
-			ty = (float)fmod(uy - fmod(y1, 1.0f), 1.0f);
-			LINEAR depthFunc = LinearFunction(x1, depth1, x2, depth2);
-			for (float x = x1 + tx, y = y1 + uy * abs(tx * sy); x * ux < x2 * ux; x += ux, y += sy)
+			JOBHANDLE job = std::make_shared<JOB>();
+			job->task = std::move(task);
+			job->parent = parent;
+			if (parent)
 			{
-				Draw(x, y, col, cha, depthFunc.f(x).y);
+				parent->unfinished++;
 			}
-			depthFunc = LinearFunction(y1, depth1, y2, depth2);
-			for (float y = y1 + ty, x = x1 + ux * abs(ty * sx); y * uy < y2 * uy; y += uy, x += sx)
+			for (const JOBHANDLE* d = firstDependency; d != lastDependency; d++)
 			{
-				Draw(x, y, col, cha, depthFunc.f(y).y);
+				if (!*d)
+				{
+					continue;
+				}
+				std::lock_guard<std::mutex> guard((*d)->dependentsLock);
+				if (!(*d)->finished)
+				{
+					job->pendingDependencies++;
+					(*d)->dependents.push_back(job);
+				}
 			}
+			Release(job);
+			return job;
 		}
-						/// <summary>Draws a line on the command pront from a point to another point</summary> /// <param name="p1">The position of the first point (Leftmost is 0; Rightmost is screenSize.X; Topmost is 0; Bottommost is screenSize.Y)</param> /// <param name="p2">The position of the second point (Leftmost is 0; Rightmost is screenSize.X; Topmost is 0; Bottommost is screenSize.Y)</param> /// <param name="col">The color with which to draw the line (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw the line</param> /// <param name="depth1">How far away from the camera the first point is (For rendering things on top of each other) (Negative values are always drawn)</param> /// <param name="depth2">How far away from the camera the second point is (For rendering things on top of each other) (Negative values are always drawn)</param>
-		void DrawLine(VEC2F p1, VEC2F p2, short col = 0x000F, short cha = 0x2588, float depth1 = -1, float depth2 = -1) { DrawLine(p1.x, p1.y, p2.x, p2.y, col, cha, depth1, depth2); }
-						/// <summary>Draws a line on the command pront from a point in relative screen space to another point in relative screen space</summary> /// <param name="x1">The x position of the first point in relative screen space (Leftmost is 0.0; Rightmost is 1.0)</param> /// <param name="y1">The y position of the first point in relative screen space (Topmost is 0.0; Bottommost is 1.0)</param> /// <param name="x2">The x position of the second point in relative screen space (Leftmost is 0.0; Rightmost is 1.0)</param> /// <param name="y2">The y position of the second point in relative screen space (Topmost is 0.0; Bottommost is 1.0)</param> /// <param name="col">The color with which to draw the line (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw the line</param> /// <param name="depth1">How far away from the camera the first point is (For rendering things on top of each other) (Negative values are always drawn)</param> /// <param name="depth2">How far away from the camera the second point is (For rendering things on top of each other) (Negative values are always drawn)</param>
-		void DrawLineS(float x1, float y1, float x2, float y2, short col = 0x000F, short cha = 0x2588, float depth1 = -1, float depth2 = -1) { DrawLine(ScreenPosToPoint(x1, y1), ScreenPosToPoint(x2, y2), col, cha, depth1, depth2); }
-						/// <summary>Draws a line on the command pront from a point in relative screen space to another point in relative screen space</summary> /// <param name="p1">The position of the first point in relative screen space (Leftmost is 0.0; Rightmost is 1.0; Topmost is 0.0; Bottommost is 1.0)</param> /// <param name="p2">The position of the second point in relative screen space (Leftmost is 0.0; Rightmost is 1.0; Topmost is 0.0; Bottommost is 1.0)</param> /// <param name="col">The color with which to draw the line (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw the line</param> /// <param name="depth1">How far away from the camera the first point is (For rendering things on top of each other) (Negative values are always drawn)</param> /// <param name="depth2">How far away from the camera the second point is (For rendering things on top of each other) (Negative values are always drawn)</param>
-		void DrawLineS(VEC2F p1, VEC2F p2, short col = 0x000F, short cha = 0x2588, float depth1 = -1, float depth2 = -1) { DrawLine(ScreenPosToPoint(p1), ScreenPosToPoint(p2), col, cha, depth1, depth2); }
-#pragma endregion
 
-		//Uses trigonometry to get the vertices of a regular polygon of 'edges' sides and then connects them with lines
-		//Using relative screen space for the polygon requires the conversion of the center point and the radius
-		//	but due to the radius not being a point, it must be defined relative to the width or height of the screen
-#pragma region DrawRPoly
-						/// <summary>
-						/// Draws a regular polygon to the screen
-						/// </summary>
-						/// <param name="cx">The x position of the center of the polygon</param>
-						/// <param name="cy">The y position of the center of the polygon</param>
-						/// <param name="edges">The amount of edges the polygon has</param>
-						/// <param name="rad">The distance from the center point to each of the vertices</param>
-						/// <param name="rot">The angle at which to draw the polygon in degrees</param>
-						/// <param name="col">The color with which to draw the polygon (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param>
-						/// <param name="cha">The character with which to draw the polygon</param>
-						/// <param name="depth">How far away from the camera the shape is (For rendering things on top of each other) (Negative values are always drawn)</param>
-		void DrawRPoly(float cx, float cy, short edges, float rad, float rot = 0, short col = 0x000F, short cha = 0x2588, float depth = -1)
+						/// <summary>Creates an empty job that other jobs can be parented to, and which finishes once all of them have (Call Finish() on it when done adding children)</summary>
+		JOBHANDLE Group() { return std::make_shared<JOB>(); }
+						/// <summary>Marks a Group() as not getting any more children</summary>
+		void Close(const JOBHANDLE& group) { Finish(group); }
+
+		bool IsFinished(const JOBHANDLE& job) { return !job || job->unfinished == 0; }
+
+						/// <summary>Blocks until 'job' (and all of its children) have finished, running other queued jobs in the meantime</summary>
+		void Wait(const JOBHANDLE& job)
 		{
-			float as = (360.0f / edges) * RAD;
-			float max = (360.0f + rot) * RAD;
-			for (float a = rot * RAD; a < max; a += as)
+			int index = CurrentIndex();
+			while (!IsFinished(job))
 			{
-				DrawLine((float)cos(a) * rad + cx, (float)sin(a) * rad + cy, (float)cos(a + as) * rad + cx, (float)sin(a + as) * rad + cy, col, cha, depth, depth);
+				JOBHANDLE other = Pop(index);
+				if (other)
+				{
+					Execute(other);
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
 			}
 		}
-						/// <summary>Draws a regular polygon to the screen</summary> /// <param name="p">The position of the center of the polygon</param> /// <param name="edges">The amount of edges the polygon has</param> /// <param name="rad">The distance from the center point to each of the vertices</param> /// <param name="rot">The angle at which to draw the polygon in degrees</param> /// <param name="col">The color with which to draw the polygon (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw the polygon</param> /// <param name="depth">How far away from the camera the pixel is (For rendering things on top of each other) (Negative values are always drawn)</param>
-		void DrawRPoly(VEC2F p, short edges, float rad, float rot = 0, short col = 0x000F, short cha = 0x2588, float depth = -1) { DrawRPoly(p.x, p.y, edges, rad, rot, col, cha, depth); }
-						/// <summary>Draws a regular polygon to the screen using relative screen space</summary> /// <param name="cx">The x position of the center of the polygon in relative screen space</param> /// <param name="cy">The y position of the center of the polygon in relative screen space</param> /// <param name="edges">The amount of edges the polygon has</param> /// <param name="rad">The distance from the center point to each of the vertices in relative screen space</param> /// <param name="useY">Whether the radius' size is defined by the screen's height or width ('true' means height is used; 'false' for width)</param> /// <param name="rot">The angle at which to draw the polygon in degrees</param> /// <param name="col">The color with which to draw the polygon (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw the polygon</param> /// <param name="depth">How far away from the camera the pixel is (For rendering things on top of each other) (Negative values are always drawn)</param>
-		void DrawRPolyS(float cx, float cy, short edges, float rad, bool useY, float rot = 0, short col = 0x000F, short cha = 0x2588, float depth = -1) { DrawRPoly(ScreenPosToPoint(cx, cy), edges, (useY ? ScreenPosToPoint(0, rad).y : ScreenPosToPoint(rad, 0).x), rot, col, cha, depth); }
-						/// <summary>Draws a regular polygon to the screen using relative screen space</summary> /// <param name="p">The position of the center of the polygon in relative screen space</param> /// <param name="edges">The amount of edges the polygon has</param> /// <param name="rad">The distance from the center point to each of the vertices in relative screen space</param> /// <param name="useY">Whether the radius' size is defined by the screen's height or width ('true' means height is used; 'false' for width)</param> /// <param name="rot">The angle at which to draw the polygon in degrees</param> /// <param name="col">The color with which to draw the polygon (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw the polygon</param> /// <param name="depth">How far away from the camera the pixel is (For rendering things on top of each other) (Negative values are always drawn)</param>
-		void DrawRPolyS(VEC2F p, short edges, float rad, bool useY, float rot = 0, short col = 0x000F, short cha = 0x2588, float depth = -1) { DrawRPolyS(p.x, p.y, edges, rad, useY, rot, col, cha, depth); }
-#pragma endregion
 
 						/// <summary>
-						/// Writes a line of text starting from a point on the command prompt
+						/// Splits the range [begin; end) into chunks of 'grain' and runs 'body(chunkBegin, chunkEnd)' on all of them in parallel, returning once they're all done
 						/// </summary>
-						/// <param name="x">The x position of the leftmost character</param>
-						/// <param name="y">The y position on which to write the line</param>
-						/// <param name="text">The text to write</param>
-						/// <param name="length">The amount of characters in the text</param>
-						/// <param name="col">The color with which to draw to that point (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param>
-						/// <param name="depth">How far away from the camera the text is (For rendering things on top of each other) (Negative values are always drawn)</param>
-		void WriteText(short x, short y, wchar_t* text, short length, short col = 0x000F, float depth = -1)
+						/// <param name="grain">The size of each chunk (0 or less picks one that gives each thread ~4 chunks)</param>
+		void ParallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body)
 		{
-			for (short i = 0; i < length; i++)
+			if (end <= begin)
 			{
-				Draw((short)(i + x), y, col, text[i], depth);
+				return;
 			}
-		}
-
-						/// <summary>
-						/// Draws a filled in triangle to the command prompt from 3 vertices
-						/// </summary>
-						/// <param name="v1">The first vertice of the triangle</param>
-						/// <param name="v2">The second vertice of the triangle</param>
-						/// <param name="v3">The third vertice of the triangle</param>
-						/// <param name="col">The color with which to draw to that point (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param>
-						/// <param name="cha">The character with which to draw to that point</param>
-						/// <param name="depth1">How far away from the camera the first vertice is (For rendering things on top of each other) (Negative values are always drawn)</param>
-						/// <param name="depth2">How far away from the camera the second vertice is (For rendering things on top of each other) (Negative values are always drawn)</param>
-						/// <param name="depth3">How far away from the camera the third vertice is (For rendering things on top of each other) (Negative values are always drawn)</param>
-		void DrawTriangle(VEC2F v1, VEC2F v2, VEC2F v3, short col = 0x000F, short cha = 0x2588, float depth1 = -1, float depth2 = -1, float depth3 = -1)
+			if (grain <= 0)
+			{
+				grain = max(1, (end - begin) / (WorkerCount() * 4));
+			}
+			if (end - begin <= grain || WorkerCount() <= 1)
+			{
+				body(begin, end);
+				return;
+			}
+			JOBHANDLE group = Group();
+			for (int i = begin + grain; i < end; i += grain)
+			{
+				int chunkEnd = min(i + grain, end);
+				Schedule([&body, i, chunkEnd]() { body(i, chunkEnd); }, {}, group);
+			}
+			//The first chunk runs on this thread instead of sitting idle
+			body(begin, begin + grain);
+			Close(group);
+			Wait(group);
+		}
+
+						/// <summary>Fork/join: runs 'a' on this thread and 'b' on any thread, returning once both are done</summary>
+		void Invoke(const std::function<void()>& a, const std::function<void()>& b)
 		{
-			VEC3F list[3] = { VEC3F(v1.x, v1.y, depth1), VEC3F(v2.x, v2.y, depth2), VEC3F(v3.x, v3.y, depth3) };
-			for (short i = 0; i < 2; i++)
+			JOBHANDLE job = Schedule([&b]() { b(); });
+			a();
+			Wait(job);
+		}
+	};
+
+	//The hand-off point between the update and render stages when frames are pipelined
+	//	The update stage fills Back() while the render stage reads Front(), and Swap() (Only called while no render is running) publishes the new frame
+	template <class T>
+	struct PACKETBUFFER
+	{
+		T packets[2];
+		int front;
+
+		PACKETBUFFER() { front = 0; }
+
+						/// <summary>The packet being built by the update stage</summary>
+		T& Back() { return packets[1 - front]; }
+						/// <summary>The packet being drawn by the render stage (Only the render stage should touch it)</summary>
+		T& Front() { return packets[front]; }
+		void Swap() { front = 1 - front; }
+	};
+
+	//Linear allocator for data that only has to last for the frame it was made in (See CMDEngine::FrameArena())
+	//	Allocating just moves an offset forwards, which several threads can do at once, and nothing is freed until Reset() drops everything together
+	//	Whatever doesn't fit gets its own heap block until the next Reset(), which then grows the arena so that the same frame would fit
+	//	Nothing in it gets destructed, so it's only for types that don't need to be
+	class FRAMEARENA
+	{
+		static const size_t ALIGNMENT = 64;
+
+		char* buffer;
+		size_t capacity;
+		std::atomic<size_t> used;
+		std::mutex overflowLock;
+		std::vector<void*> overflow;
+		size_t overflowBytes;
+		//The most that was still allocated when Reset() was called
+		size_t peak;
+
+		void* AllocateOverflow(size_t bytes)
+		{
+			void* block = ::operator new(bytes, std::align_val_t(ALIGNMENT));
+			std::lock_guard<std::mutex> lock(overflowLock);
+			overflow.push_back(block);
+			overflowBytes += bytes;
+			return block;
+		}
+
+	public:
+		FRAMEARENA(size_t capacity = 256 * 1024)
+		{
+			this->capacity = capacity;
+			buffer = (char*)::operator new(capacity, std::align_val_t(ALIGNMENT));
+			used = 0;
+			overflowBytes = 0;
+			peak = 0;
+		}
+
+		FRAMEARENA(const FRAMEARENA&) = delete;
+		FRAMEARENA& operator=(const FRAMEARENA&) = delete;
+
+		~FRAMEARENA()
+		{
+			Reset();
+			::operator delete(buffer, std::align_val_t(ALIGNMENT));
+		}
+
+						/// <summary>Gets 'bytes' of memory that stay valid until the next Reset() ('alignment' must be a power of 2, up to 64)</summary>
+		void* Allocate(size_t bytes, size_t alignment = 16)
+		{
+			size_t offset = used.load(std::memory_order_relaxed);
+			size_t start;
+			do
 			{
-				if (list[i].y < list[0].y)
-				{
-					std::swap(list[i], list[0]);
-				}
-				if (list[i].y > list[2].y)
+				start = (offset + alignment - 1) & ~(alignment - 1);
+				if (start + bytes > capacity)
 				{
-					std::swap(list[i], list[2]);
+					return AllocateOverflow(bytes);
 				}
+			} while (!used.compare_exchange_weak(offset, start + bytes, std::memory_order_relaxed));
+			return buffer + start;
+		}
+
+						/// <summary>Gives back 'bytes' at 'memory' if nothing has been allocated after it yet (Otherwise it stays used until Reset(), which is always safe)</summary>
+		void Free(void* memory, size_t bytes)
+		{
+			char* start = (char*)memory;
+			if (start < buffer || start >= buffer + capacity)
+				return;
+			size_t end = (start - buffer) + bytes;
+			used.compare_exchange_strong(end, start - buffer, std::memory_order_relaxed);
+		}
+
+						/// <summary>Copies 'count' items into the arena</summary>
+		template <class T>
+		T* Copy(const T* source, size_t count)
+		{
+			T* output = (T*)Allocate(sizeof(T) * count, alignof(T));
+			std::uninitialized_copy(source, source + count, output);
+			return output;
+		}
+
+						/// <summary>Drops everything that was allocated, growing the arena first if it overflowed (Nothing may be using the arena while this runs)</summary>
+		void Reset()
+		{
+			size_t needed = used.load(std::memory_order_relaxed) + overflowBytes;
+			peak = max(peak, needed);
+			for (void* block : overflow)
+			{
+				::operator delete(block, std::align_val_t(ALIGNMENT));
 			}
-			VEC3F b1, b2, t1;
-			if ((short)list[0].y == (short)list[2].y)
+			overflow.clear();
+			if (overflowBytes > 0)
 			{
-				//Line
-				DrawLine(list[0], list[1], col, cha, list[0].z, list[1].z);
-				DrawLine(list[1], list[2], col, cha, list[1].z, list[2].z);
-				DrawLine(list[2], list[0], col, cha, list[2].z, list[0].z);
+				::operator delete(buffer, std::align_val_t(ALIGNMENT));
+				//Some room to spare so that a frame that's slightly bigger doesn't overflow again
+				capacity = needed + needed / 2;
+				buffer = (char*)::operator new(capacity, std::align_val_t(ALIGNMENT));
+				overflowBytes = 0;
 			}
-			else
+			used.store(0, std::memory_order_relaxed);
+		}
+
+						/// <summary>How many bytes are allocated right now (Not counting overflow)</summary>
+		size_t Used() const { return used.load(std::memory_order_relaxed); }
+		size_t Capacity() const { return capacity; }
+						/// <summary>The most that was still allocated when a frame ended, as of the last Reset()</summary>
+		size_t Peak() const { return peak; }
+	};
+
+	//Lets STL containers take their memory from a FRAMEARENA (The container has to be gone by the arena's next Reset())
+	template <class T>
+	struct ARENAALLOCATOR
+	{
+		typedef T value_type;
+		FRAMEARENA* arena;
+
+		ARENAALLOCATOR(FRAMEARENA& arena) { this->arena = &arena; }
+		template <class U>
+		ARENAALLOCATOR(const ARENAALLOCATOR<U>& other) { arena = other.arena; }
+
+		T* allocate(size_t count) { return (T*)arena->Allocate(count * sizeof(T), alignof(T)); }
+		void deallocate(T* memory, size_t count) { arena->Free(memory, count * sizeof(T)); }
+
+		template <class U>
+		bool operator==(const ARENAALLOCATOR<U>& other) const { return arena == other.arena; }
+	};
+
+	template <class T>
+	using ARENAVECTOR = std::vector<T, ARENAALLOCATOR<T>>;
+
+	//Low resolution copy of a depth buffer for occlusion culling, where each tile keeps the furthest depth of the cells under it
+	//	Something whose nearest point is further away than every tile it covers is hidden behind whatever was drawn
+	//	(Cells that weren't drawn to are still at the far plane, so a tile with any gap in it never hides anything)
+	class OCCLUSIONBUFFER
+	{
+		std::vector<float> tiles;
+		short tilesX;
+		short tilesY;
+		//The cells the tiles were built from, edges included (Everything outside counts as hidden)
+		SMALL_RECT area;
+
+	public:
+		//How many cells wide and tall each tile is
+		static const short TILE_SIZE = 4;
+
+		OCCLUSIONBUFFER() { tilesX = tilesY = 0; area = SMALL_RECT(); }
+
+						/// <summary>Rebuilds the tiles from the cells in 'cellArea' (Edges included) of a 'width' by 'height' depth buffer (Only those cells get read, so other parts of the buffer can be drawn to at the same time)</summary>
+		void Build(const float* depths, short width, short height, SMALL_RECT cellArea)
+		{
+			area = { max(cellArea.Left, (short)0), max(cellArea.Top, (short)0), min(cellArea.Right, (short)(width - 1)), min(cellArea.Bottom, (short)(height - 1)) };
+			tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+			tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+			tiles.assign((size_t)tilesX * tilesY, 0.0f);
+			for (short y = area.Top; y <= area.Bottom; y++)
 			{
-				if ((short)list[0].y == (short)list[1].y)
-				{
-					b1 = list[0];
-					b2 = list[1];
-					t1 = list[2];
-				}
-				else
+				float* row = &tiles[(size_t)(y / TILE_SIZE) * tilesX];
+				const float* cells = depths + (size_t)y * width;
+				for (short x = area.Left; x <= area.Right; x++)
 				{
-					if ((short)list[1].y == (short)list[2].y)
-					{
-						b1 = list[1];
-						b2 = list[2];
-						t1 = list[0];
-					}
-					else
-					{
-						//Turn into 2 triangles with a flat side and then pass them both through this function
-						b1 = list[1];
-						b2 = VEC3F(LinearFunction(list[0].y, list[0].x, list[2].y, list[2].x, b1.y), b1.y, LinearFunction(list[0].y, list[0].z, list[2].y, list[2].z, b1.y));
-						DrawTriangle(list[0], b1, b2, col, cha, list[0].z, b1.z, b2.z);
-						DrawTriangle(b1, b2, list[2], col, cha, b1.z, b2.z, list[2].z);
-						return;
-					}
+					row[x / TILE_SIZE] = max(row[x / TILE_SIZE], cells[x]);
 				}
 			}
-			//The 'DrawLine()' code but slightly modified so that 2 lines can be done at once
-			//If you draw 2 lines to the same point, both starting at the same Y level and filling in the space between them every time the Y level changes
-			//then you've drawn a triangle
-			short ux1 = (b1.x < t1.x ? 1 : -1), ux2 = (b2.x < t1.x ? 1 : -1), uy = (b1.y < t1.y ? 1 : -1);
-			float tx1 = t1.x - b1.x, tx2 = t1.x - b2.x, ty = t1.y - b1.y;
-			float sx1 = (ty != 0 ? ux1 * abs(tx1 / ty) : 0), sy1 = (tx1 != 0 ? uy * abs(ty / tx1) : 0), sx2 = (ty != 0 ? ux2 * abs(tx2 / ty) : 0), sy2 = (tx2 != 0 ? uy * abs(ty / tx2) : 0);
-			DrawLine(b1.x, b1.y, b2.x, b2.y, col, cha, b1.z, b2.z);
-			Draw(t1.x, t1.y, col, cha, t1.z);
-			tx1 = (float)fmod(ux1 - fmod(b1.x, 1.0f), 1.0f);
-			tx2 = (float)fmod(ux2 - fmod(b2.x, 1.0f), 1.0f);
-			ty = (float)fmod(uy - fmod(b1.y, 1.0f), 1.0f);
+		}
 
-			LINEAR b1Depth = LinearFunction(b1.y, b1.z, t1.y, t1.z);
-			//+1 on x for line 1 & +? on y for line 1
-			for (float x = b1.x + tx1, y = b1.y + uy * abs(tx1 * sy1); x * ux1 < t1.x * ux1; x += ux1, y += sy1)
-			{
-				Draw(x, y, col, cha, b1Depth.f(y).y);
-			}
-			LINEAR b2Depth = LinearFunction(b2.y, b2.z, t1.y, t1.z);
-			//+1 on x for line 2 & +? on y for line 2
-			for (float x = b2.x + tx2, y = b2.y + uy * abs(tx2 * sy2); x * ux2 < t1.x * ux2; x += ux2, y += sy2)
+						/// <summary>Whether something covering the cells from ('left', 'top') to ('right', 'bottom'), with nothing closer than 'depth', is entirely hidden (Parts outside the area it was built from count as hidden, since they aren't drawn there anyways)</summary>
+		bool Occluded(float left, float top, float right, float bottom, float depth) const
+		{
+			if (tiles.empty())
+				return false;
+			//1 cell of slack on every side, for however the rasterizer rounds the edges
+			int x1 = max((int)floorf(left) - 1, (int)area.Left) / TILE_SIZE;
+			int y1 = max((int)floorf(top) - 1, (int)area.Top) / TILE_SIZE;
+			int x2 = min((int)floorf(right) + 1, (int)area.Right) / TILE_SIZE;
+			int y2 = min((int)floorf(bottom) + 1, (int)area.Bottom) / TILE_SIZE;
+			for (int y = y1; y <= y2; y++)
 			{
-				Draw(x, y, col, cha, b2Depth.f(y).y);
+				for (int x = x1; x <= x2; x++)
+				{
+					if (depth <= tiles[(size_t)y * tilesX + x])
+						return false;
+				}
 			}
-			//+1 on y for line 1 & 2, & +? on x for line 1 & 2
-			//DEBUG
-			for (float y = b1.y + ty, x1 = b1.x + ux1 * abs(ty * sx1), x2 = b2.x + ux2 * abs(ty * sx2); y * uy < t1.y * uy; y += uy, x1 += sx1, x2 += sx2)
+			return true;
+		}
+	};
+
+	//Runs a frame's render passes in an order worked out from what each one reads and writes, instead of a hard-coded one
+	//	Passes are added in the order they'd run in serially; a pass only waits for earlier ones it has a hazard with (Read after write, write after read or write after write)
+	//	so passes that touch different resources run in parallel on the job system
+	//	Persistent resources (The ones with a clear function) keep their contents between frames, so passes that only write to them can be skipped while their cache key stays the same
+	class RENDERGRAPH
+	{
+	public:
+		typedef unsigned int RESOURCES;
+
+		struct PASS
+		{
+			const wchar_t* name;
+			RESOURCES reads;
+			RESOURCES writes;
+			std::function<void()> execute;
+			//Returns something that changes whenever the pass would draw something different (No function means it always runs)
+			std::function<size_t()> cacheKey;
+			size_t lastKey;
+			bool hasRun;
+			//Whether the pass was skipped in the last Execute()
+			bool skipped;
+			//How long the pass took in the last Execute() that ran it, in seconds
+			float time;
+		};
+
+	private:
+		std::vector<PASS> passes;
+		std::vector<std::function<void()>> clears;
+		RESOURCES persistent;
+		std::vector<JOBSYSTEM::JOBHANDLE> handles;
+		std::vector<bool> runs;
+
+		static bool Hazard(const PASS& first, const PASS& second)
+		{
+			return (first.writes & (second.reads | second.writes)) || (first.reads & second.writes);
+		}
+
+	public:
+		RENDERGRAPH() { persistent = 0; }
+
+						/// <summary>
+						/// Registers a resource and returns its bit (Combine bits with '|' when declaring a pass's reads and writes)
+						/// </summary>
+						/// <param name="clear">For persistent resources, clears it before the passes that write to it get rerun (Leave empty for resources that are remade every frame)</param>
+		RESOURCES AddResource(std::function<void()> clear = nullptr)
+		{
+			RESOURCES bit = (RESOURCES)1 << clears.size();
+			if (clear)
 			{
-				DrawLine(x1, y, x2, y, col, cha, b1Depth.f(y).y, b2Depth.f(y).y);
+				persistent |= bit;
 			}
+			clears.push_back(std::move(clear));
+			return bit;
 		}
-#pragma endregion
 
 						/// <summary>
-						/// Converts a relative screen space position ('0.0 - 1.0' is 'Left - Right' or 'Top - Bottom') to a point in the pixel grid ('0.0 - screenSize.X' is 'Left - Right' and '0.0 - screenSize.Y' is 'Top - Bottom')
+						/// Adds a pass after the ones already added, returning its index
 						/// </summary>
-						/// <param name="x">The x value (If outside of range [0.0; 1.0] the resulting pixel will be out of the screen)</param>
-						/// <param name="y">The y value (If outside of range [0.0; 1.0] the resulting pixel will be out of the screen)</param>
-		VEC2F ScreenPosToPoint(float x, float y)
+						/// <param name="name">Used for profiling output</param>
+						/// <param name="reads">The resources the pass reads from</param>
+						/// <param name="writes">The resources the pass writes to</param>
+						/// <param name="execute">Does the pass's work (Can run on any thread)</param>
+						/// <param name="cacheKey">Only for passes that just write to persistent resources: the pass gets skipped while this returns the same value and nothing it reads has changed</param>
+		int AddPass(const wchar_t* name, RESOURCES reads, RESOURCES writes, std::function<void()> execute, std::function<size_t()> cacheKey = nullptr)
 		{
-			return { x * screenSize.X, y * screenSize.Y };
+			PASS pass;
+			pass.name = name;
+			pass.reads = reads;
+			pass.writes = writes;
+			pass.execute = std::move(execute);
+			pass.cacheKey = std::move(cacheKey);
+			pass.lastKey = 0;
+			pass.hasRun = false;
+			pass.skipped = false;
+			pass.time = 0;
+			passes.push_back(std::move(pass));
+			return (int)passes.size() - 1;
 		}
-						///<summary>Converts a relative screen space position ('0.0 - 1.0' is 'Left - Right' or 'Top - Bottom') to a point in the pixel grid ('0.0 - screenSize.X' is 'Left - Right' and '0.0 - screenSize.Y' is 'Top - Bottom')</summary> /// <param name="p">The value (If x or y is outside of range [0.0; 1.0] the resulting pixel will be out of the screen)</param>
-		VEC2F ScreenPosToPoint(VEC2F p) { return { p.x * screenSize.X, p.y * screenSize.Y }; }
 
-						/// <summary>Fills the entire console with the character and color in the 'empty' variable</summary>
-		void ClearFrame()
+		void Clear() { passes.clear(); }
+						/// <summary>Makes every pass run on the next Execute() (Ex. after the screen gets resized)</summary>
+		void Invalidate() { for (PASS& p : passes) { p.hasRun = false; } }
+		const std::vector<PASS>& Passes() const { return passes; }
+
+						/// <summary>Runs every pass that isn't skipped, returning once they've all finished</summary>
+		void Execute(JOBSYSTEM& jobs)
 		{
-			for (int i = 0; i < pixelCount; i++)
+			size_t count = passes.size();
+			runs.assign(count, false);
+			RESOURCES dirty = 0;
+			for (size_t i = 0; i < count; i++)
+			{
+				PASS& p = passes[i];
+				size_t key = (p.cacheKey ? p.cacheKey() : 0);
+				runs[i] = !p.cacheKey || !p.hasRun || key != p.lastKey || (p.writes & ~persistent) || (p.reads & dirty);
+				p.lastKey = key;
+				if (runs[i])
+				{
+					dirty |= p.writes;
+				}
+			}
+			//A persistent resource gets cleared before it's redrawn, so everything that draws to it has to run again (Which can dirty more resources)
+			bool changed = true;
+			while (changed)
+			{
+				changed = false;
+				for (size_t i = 0; i < count; i++)
+				{
+					if (!runs[i] && ((passes[i].writes & persistent & dirty) || (passes[i].reads & dirty)))
+					{
+						runs[i] = true;
+						dirty |= passes[i].writes;
+						changed = true;
+					}
+				}
+			}
+			for (size_t r = 0; r < clears.size(); r++)
+			{
+				if ((persistent & dirty) & ((RESOURCES)1 << r))
+				{
+					clears[r]();
+				}
+			}
+
+			handles.assign(count, nullptr);
+			std::vector<JOBSYSTEM::JOBHANDLE> dependencies;
+			for (size_t i = 0; i < count; i++)
+			{
+				PASS& p = passes[i];
+				p.skipped = !runs[i];
+				if (p.skipped)
+				{
+					continue;
+				}
+				p.hasRun = true;
+				dependencies.clear();
+				for (size_t j = 0; j < i; j++)
+				{
+					if (handles[j] && Hazard(passes[j], p))
+					{
+						dependencies.push_back(handles[j]);
+					}
+				}
+				handles[i] = jobs.Schedule([&p]()
+				{
+					std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+					p.execute();
+					p.time = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+				}, dependencies);
+			}
+			for (JOBSYSTEM::JOBHANDLE& h : handles)
 			{
-				screen[i] = emptyChar;
-				zBuffer[i] = 1;
+				jobs.Wait(h);
 			}
 		}
+	};
 
-		void DrawFrame()
+	//Keyboard and mouse state, laid out flat so that looking a key up is indexing instead of a tree search
+	//	Characters get 1 bit each (Every UTF-16 code unit) for this frame's and last frame's state, so their 0/1/2/3 value comes from 2 bit tests
+	//	and aging them only touches the words that changed last frame; the engine's own codes (0xF000 - 0xF05F) are kept as plain values
+	class INPUTTABLE
+	{
+	public:
+		static const int SPECIAL_BASE = 0xF000;
+		static const int SPECIAL_COUNT = 0x60;
+
+	private:
+		static const int WORDS = 0x10000 / 64;
+		unsigned long long down[WORDS];
+		unsigned long long wasDown[WORDS];
+		//Keys that were pressed and released within the same frame, which read as pressed for that frame and as released the next, so quick taps at low frame rates aren't lost
+		unsigned long long tapped[WORDS];
+		unsigned long long tapReleased[WORDS];
+		//The words changed by this frame's events (The only ones where 'wasDown' can differ from 'down' next frame)
+		std::vector<int> touched;
+		std::vector<int> touchedNext;
+		short special[SPECIAL_COUNT];
+
+		static bool IsSpecial(wchar_t key) { return key >= SPECIAL_BASE && key < SPECIAL_BASE + SPECIAL_COUNT; }
+
+	public:
+		INPUTTABLE()
 		{
-			WriteConsoleOutput(console, screen, { screenSize.X, screenSize.Y }, { 0, 0 }, &sr);
+			memset(down, 0, sizeof(down));
+			memset(wasDown, 0, sizeof(wasDown));
+			memset(tapped, 0, sizeof(tapped));
+			memset(tapReleased, 0, sizeof(tapReleased));
+			memset(special, 0, sizeof(special));
 		}
 
-		void ResizeWindow(short screenWidth, short screenHeight, short fontWidth = 1, short fontHeight = 1)
+						/// <summary>0 -> nothing ; 1 -> released ; 2 -> pressed ; 3 -> held ; MOUSE_X and MOUSE_Y -> point on the command prompt</summary>
+		short operator[] (wchar_t key) const
 		{
-			if (fontWidth > 30 || fontHeight > 30)
-			{
-				ThrowError(L"FontTooBig (30)");
-				return;
-			}
-			if (screenWidth < 15 || screenHeight < 2 || fontWidth < 1 || fontHeight < 1)
+			if (IsSpecial(key))
 			{
-				ThrowError(L"SmallerThanMin (15, 2, 1, 1)");
-				return;
+				return special[key - SPECIAL_BASE];
 			}
-			_screenSize = { (short)screenWidth, (short)screenHeight };
-			_pixelCount = screenWidth * screenHeight;
-			screen = new CHAR_INFO[pixelCount];
-			//Setting up the console window (Not entirely sure about what everything here does, had to copy most of it due to the complexity)
-#pragma region ConsoleWindowSetup
-		//Creates an object that then basically functions as the console
-			console = CreateConsoleScreenBuffer(GENERIC_READ | GENERIC_WRITE, 0, NULL, CONSOLE_TEXTMODE_BUFFER, NULL);
-			//Set the window size to the smallest possible
-			sr = { 0, 0, 1, 1 };
-			SetConsoleWindowInfo(console, true, &sr);
-			//Set the buffer size to the wanted size
-			if (!SetConsoleScreenBufferSize(console, _screenSize))
+			int word = key >> 6;
+			unsigned long long bit = 1ull << (key & 63);
+			if (down[word] & bit)
 			{
-				ThrowError(L"SetConsoleScreenBufferSize");
-				return;
+				return ((wasDown[word] & bit) ? 3 : 2);
 			}
-			//Assign the console object to the actual console (From now on changes to the console object will affect the actual console)
-			if (!SetConsoleActiveScreenBuffer(console))
+			if (tapped[word] & bit)
 			{
-				ThrowError(L"SetConsoleActiveScreenBuffer");
-				return;
+				return 2;
 			}
+			return (((wasDown[word] | tapReleased[word]) & bit) ? 1 : 0);
+		}
 
-			//Setting the cursor visibility
-			CONSOLE_CURSOR_INFO cci = CONSOLE_CURSOR_INFO();
-			cci.bVisible = false;
-			cci.dwSize = 3;
-			SetConsoleCursorInfo(console, &cci);
+						/// <summary>The value of one of the engine's own codes (RALT, MOUSE_X, MOUSE_BTN + i, etc.), for the engine to write to</summary>
+		short& Special(wchar_t key) { return special[key - SPECIAL_BASE]; }
 
-			//Setting the character size and font
-			CONSOLE_FONT_INFOEX cfi = CONSOLE_FONT_INFOEX();
-			cfi.cbSize = sizeof(cfi);
-			cfi.dwFontSize.X = fontWidth;
-			cfi.dwFontSize.Y = fontHeight;
-			cfi.FontFamily = FF_DONTCARE;
-			cfi.FontWeight = FW_NORMAL;
-			//Don't know why, but  ' cfi.FaceName = L"Liberation Mono"; '  doesn't work, so instead 'wcscpy_s' has to be used
-			//	this copies the wide character string in the 2nd parameter into the variable in the 1st parameter
-			//wcscpy_s(cfi.FaceName, L"Liberation Mono");
-			if (!SetCurrentConsoleFontEx(console, false, &cfi))
+						/// <summary>Moves every key on by 1 frame (Pressed -> held ; released -> nothing), before the frame's events are read</summary>
+		void Age()
+		{
+			//Taps move on to being released, which has to be undone on the frame after, so those words stay touched for 1 more frame
+			touchedNext.clear();
+			for (int word : touched)
 			{
-				ThrowError(L"SetConsoleActiveScreenBuffer");
-				return;
+				tapReleased[word] = 0;
+			}
+			for (int word : touched)
+			{
+				wasDown[word] = down[word];
+				if (tapped[word])
+				{
+					tapReleased[word] = tapped[word];
+					tapped[word] = 0;
+					touchedNext.push_back(word);
+				}
+			}
+			touched.swap(touchedNext);
+			for (int i = 0; i < SPECIAL_COUNT; i++)
+			{
+				if (i == MOUSE_X - SPECIAL_BASE || i == MOUSE_Y - SPECIAL_BASE)
+				{
+					//Positions, not states
+					continue;
+				}
+				switch (special[i])
+				{
+				case 2:
+					special[i] = 3;
+					break;
+				case 1:
+					special[i] = 0;
+					break;
+				case -1:
+					special[i] = 0;
+					break;
+				}
 			}
+		}
 
-			//Check to see if the wanted size is too big for the screen
-			CONSOLE_SCREEN_BUFFER_INFO csbi;
-			if (!GetConsoleScreenBufferInfo(console, &csbi))
+						/// <summary>Records a character key going down or up</summary>
+		void KeyEvent(wchar_t key, bool isDown)
+		{
+			if (IsSpecial(key))
 			{
-				ThrowError(L"GetConsoleScreenBufferInfo");
 				return;
 			}
-			if (_screenSize.Y > csbi.dwMaximumWindowSize.Y)
+			int word = key >> 6;
+			unsigned long long bit = 1ull << (key & 63);
+			if (isDown)
 			{
-				wchar_t msg[128];
-				swprintf(msg, 128, L"Screen Height / Font Height Too Big (%d * %d)", csbi.dwMaximumWindowSize.Y, fontHeight);
-				ThrowError(msg);
-				return;
+				down[word] |= bit;
 			}
-			if (_screenSize.X > csbi.dwMaximumWindowSize.X)
+			else
 			{
-				wchar_t msg[128];
-				swprintf(msg, 128, L"Screen Width / Font Width Too Big (%d * %d)", csbi.dwMaximumWindowSize.X, fontWidth);
-				ThrowError(msg);
-				return;
+				if (down[word] & ~wasDown[word] & bit)
+				{
+					tapped[word] |= bit;
+				}
+				down[word] &= ~bit;
+			}
+			touched.push_back(word);
+		}
+	};
+
+	//Lock-free queue between exactly 1 producer thread and 1 consumer thread
+	//	Each index is only ever written by 1 side (The producer moves 'head', the consumer moves 'tail'), and they're kept on separate cache lines so the 2 threads don't fight over them
+	//	When it's full, new items are dropped (And counted) instead of blocking the producer
+	template <class T, unsigned int CAPACITY>
+	class SPSCRING
+	{
+		static_assert((CAPACITY & (CAPACITY - 1)) == 0, "SPSCRING's capacity has to be a power of 2");
+
+		T items[CAPACITY];
+		alignas(64) std::atomic<unsigned int> head;
+		alignas(64) std::atomic<unsigned int> tail;
+		std::atomic<unsigned int> dropped;
+
+	public:
+		SPSCRING()
+		{
+			head = 0;
+			tail = 0;
+			dropped = 0;
+		}
+
+						/// <summary>Adds an item to the back (Producer thread only). Returns false if the ring was full</summary>
+		bool Push(const T& item)
+		{
+			unsigned int h = head.load(std::memory_order_relaxed);
+			if (h - tail.load(std::memory_order_acquire) == CAPACITY)
+			{
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			items[h & (CAPACITY - 1)] = item;
+			head.store(h + 1, std::memory_order_release);
+			return true;
+		}
+
+						/// <summary>Takes the item at the front (Consumer thread only). Returns false if the ring was empty</summary>
+		bool Pop(T& item)
+		{
+			unsigned int t = tail.load(std::memory_order_relaxed);
+			if (t == head.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+			item = items[t & (CAPACITY - 1)];
+			tail.store(t + 1, std::memory_order_release);
+			return true;
+		}
+
+						/// <summary>How many items have been dropped because the ring was full</summary>
+		unsigned int Dropped() const { return dropped.load(std::memory_order_relaxed); }
+	};
+
+	//A raw console event, with the time it was read at
+	struct INPUTEVENT
+	{
+		std::chrono::steady_clock::time_point time;
+		INPUT_RECORD record;
+	};
+
+	//Where CMDEngine gets its input events from (The console by default; swap it for a SCRIPTEDINPUT to play back input without a console)
+	class INPUTSOURCE
+	{
+	public:
+		virtual ~INPUTSOURCE() {}
+						/// <summary>Blocks until there are events to read or 'milliseconds' pass, returning whether there are any</summary>
+		virtual bool Wait(DWORD milliseconds) = 0;
+						/// <summary>Reads up to 'maxCount' of the waiting events into 'records' without blocking, putting how many were read in 'readCount' (Returns false if reading failed, with the reason in GetLastError())</summary>
+		virtual bool Read(INPUT_RECORD* records, DWORD maxCount, DWORD* readCount) = 0;
+	};
+
+	//Reads events from a console input handle
+	class CONSOLEINPUT : public INPUTSOURCE
+	{
+		HANDLE handle;
+
+	public:
+		CONSOLEINPUT(HANDLE consoleInput = NULL) { handle = consoleInput; }
+
+		bool Wait(DWORD milliseconds)
+		{
+			//The handle is signaled while there are unread events
+			return WaitForSingleObject(handle, milliseconds) == WAIT_OBJECT_0;
+		}
+
+		bool Read(INPUT_RECORD* records, DWORD maxCount, DWORD* readCount)
+		{
+			DWORD count = 0;
+			*readCount = 0;
+			if (!GetNumberOfConsoleInputEvents(handle, &count) || count == 0)
+			{
+				return true;
+			}
+			return ReadConsoleInputW(handle, records, min(count, maxCount), readCount);
+		}
+	};
+
+	//Plays back a list of events at set times after it's started, for running without a console (Tests, benchmarks, replays)
+	class SCRIPTEDINPUT : public INPUTSOURCE
+	{
+		typedef std::chrono::steady_clock Clock;
+
+		struct SCRIPTEDEVENT
+		{
+			float time;
+			INPUT_RECORD record;
+		};
+		std::vector<SCRIPTEDEVENT> events;
+		std::atomic<size_t> next;
+		Clock::time_point start;
+		bool started;
+
+		Clock::time_point TimeOf(size_t i) { return start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(events[i].time)); }
+		//The script's clock starts the first time it's waited on or read from
+		void Begin()
+		{
+			if (!started)
+			{
+				start = Clock::now();
+				started = true;
+			}
+		}
+
+	public:
+		SCRIPTEDINPUT()
+		{
+			next = 0;
+			started = false;
+		}
+
+						/// <summary>Adds an event to play 'time' seconds after the first Wait() (Events have to be added in order, before the engine starts)</summary>
+		void Add(float time, const INPUT_RECORD& record) { events.push_back({ time, record }); }
+						/// <summary>Adds a key going down or up 'time' seconds in</summary>
+		void Key(float time, wchar_t key, bool down)
+		{
+			INPUT_RECORD record = INPUT_RECORD();
+			record.EventType = KEY_EVENT;
+			record.Event.KeyEvent.bKeyDown = down;
+			record.Event.KeyEvent.wRepeatCount = 1;
+			record.Event.KeyEvent.uChar.UnicodeChar = key;
+			Add(time, record);
+		}
+						/// <summary>Adds the mouse moving to (x, y) on the console 'time' seconds in</summary>
+		void MouseMove(float time, short x, short y)
+		{
+			INPUT_RECORD record = INPUT_RECORD();
+			record.EventType = MOUSE_EVENT;
+			record.Event.MouseEvent.dwEventFlags = MOUSE_MOVED;
+			record.Event.MouseEvent.dwMousePosition = { x, y };
+			Add(time, record);
+		}
+						/// <summary>Whether every event has been played</summary>
+		bool Finished() { return next >= events.size(); }
+
+		bool Wait(DWORD milliseconds)
+		{
+			Begin();
+			Clock::time_point timeout = Clock::now() + std::chrono::milliseconds(milliseconds);
+			if (next < events.size() && TimeOf(next) < timeout)
+			{
+				std::this_thread::sleep_until(TimeOf(next));
+				return true;
+			}
+			std::this_thread::sleep_until(timeout);
+			return false;
+		}
+
+		bool Read(INPUT_RECORD* records, DWORD maxCount, DWORD* readCount)
+		{
+			Begin();
+			DWORD count = 0;
+			Clock::time_point now = Clock::now();
+			while (count < maxCount && next < events.size() && TimeOf(next) <= now)
+			{
+				records[count] = events[next].record;
+				count++;
+				next++;
+			}
+			*readCount = count;
+			return true;
+		}
+	};
+
+	//The full-screen clear kernels CMDEngine can pick between
+	enum CLEARKERNEL { CLEAR_SCALAR, CLEAR_SSE2, CLEAR_KERNEL_COUNT };
+	//How CMDEngine gets finished frames to the console
+	//	ASYNC copies the frame and writes it on a job so drawing can carry on; SYNC writes it straight away and saves the copy
+	enum PRESENTMODE { PRESENT_ASYNC, PRESENT_SYNC, PRESENT_MODE_COUNT };
+	//Which of CMDEngine's buffers a draw call writes to (The HUD layer gets copied on top of the screen by CompositeHUD())
+	enum LAYER { LAYER_SCREEN, LAYER_HUD };
+
+	//Engine settings whose best values depend on the machine and the screen size (Picked by CMDEngine::AutoTune())
+	//	Any value below 0 means 'not set'
+	struct TUNING
+	{
+		//Threads running jobs, counting the main thread
+		int threads;
+		//Pixels handed to each job by the full-screen kernels (0 lets the job system pick)
+		int pixelGrain;
+		int clearKernel;
+		int presentMode;
+
+		TUNING() { threads = pixelGrain = clearKernel = presentMode = -1; }
+	};
+
+	//The AutoTune() cache, holding 1 line per machine and screen size
+	//	'MACHINE CORES WIDTH HEIGHT | THREADS GRAIN CLEARKERNEL PRESENTMODE'
+	struct TUNINGFILE : public PROCESSEDFILE
+	{
+		static const bool utf16 = false;
+		struct ENTRY
+		{
+			wchar_t machine[64];
+			int cores;
+			short width;
+			short height;
+			TUNING tuning;
+		};
+		std::vector<ENTRY> entries;
+
+		TUNINGFILE()
+		{
+			entries = std::vector<ENTRY>();
+		}
+
+		void ProcessLine(wchar_t* line, unsigned long length)
+		{
+			ENTRY entry = ENTRY();
+			wchar_t* ptr = &line[0];
+			int i = 0;
+			while (ptr < &line[length] && *ptr != L' ' && i < 63)
+			{
+				entry.machine[i] = *ptr;
+				ptr++;
+				i++;
+			}
+			entry.machine[i] = L'\0';
+			entry.cores = (int)std::wcstol(ptr, &ptr, 10);
+			entry.width = (short)std::wcstol(ptr, &ptr, 10);
+			entry.height = (short)std::wcstol(ptr, &ptr, 10);
+			while (ptr < &line[length] && *ptr != L'|')
+			{
+				ptr++;
+			}
+			if (ptr >= &line[length] || i == 0)
+			{
+				//Not a valid entry
+				return;
+			}
+			ptr++; //'|'
+			entry.tuning.threads = (int)std::wcstol(ptr, &ptr, 10);
+			entry.tuning.pixelGrain = (int)std::wcstol(ptr, &ptr, 10);
+			entry.tuning.clearKernel = (int)std::wcstol(ptr, &ptr, 10);
+			entry.tuning.presentMode = (int)std::wcstol(ptr, &ptr, 10);
+			entries.push_back(entry);
+		}
+
+		ENTRY* Find(const wchar_t* machine, int cores, short width, short height)
+		{
+			for (ENTRY& e : entries)
+			{
+				if (wcscmp(e.machine, machine) == 0 && e.cores == cores && e.width == width && e.height == height)
+				{
+					return &e;
+				}
+			}
+			return nullptr;
+		}
+
+		static bool Export(FILE& exportFile, TUNINGFILE& data)
+		{
+			wchar_t lineBuffer[FILE::CHUNK_SIZE] = { 0 };
+			for (ENTRY& e : data.entries)
+			{
+				//UTF-8 Version
+				DWORD writeCount = swprintf(lineBuffer, FILE::CHUNK_SIZE, L"%ls %d %hd %hd | %d %d %d %d\n",
+					e.machine, e.cores, e.width, e.height, e.tuning.threads, e.tuning.pixelGrain, e.tuning.clearKernel, e.tuning.presentMode);
+				char byteBuffer[FILE::CHUNK_SIZE] = { 0 };
+				writeCount = WideCharToMultiByte(CP_UTF8, 0, lineBuffer, -1, byteBuffer, FILE::CHUNK_SIZE, NULL, NULL);
+				if (!WriteFile(exportFile.fileHandle, &byteBuffer, writeCount - 1, &writeCount, NULL))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+	};
+
+	class CMDEngine
+	{
+	private:
+		HANDLE console;
+		HANDLE consoleInput;
+		HWND window;
+		SMALL_RECT sr;
+		bool upscale;
+		wchar_t _msg[128];
+		COORD _screenSize;
+		int _pixelCount;
+		float _deltaTime;
+		float _interpolationAlpha;
+		float fixedAccumulator;
+		FRAMEPACER pacer;
+		CHAR_INFO* screen;
+		//Copy of the last finished frame, which gets written to the console in the background while the next one is drawn
+		CHAR_INFO* presentBuffer;
+		//Layer drawn on top of the screen by CompositeHUD(), which keeps its contents between frames
+		CHAR_INFO* hudLayer;
+		float* hudDepth;
+		//The clip rect for drawing that isn't limited to part of the screen (See DrawTo())
+		static constexpr SMALL_RECT WHOLE_SCREEN = { 0, 0, SHRT_MAX, SHRT_MAX };
+		JOBSYSTEM::JOBHANDLE presentJob;
+		JOBSYSTEM::JOBHANDLE renderJob;
+		//2 of them for the same reason there are 2 render packets: with 'pipelineFrames' on, the last frame is still being drawn while the next one is updated
+		FRAMEARENA frameArenas[2];
+		std::atomic<int> frameArena;
+		TUNING _tuning;
+		CONSOLEINPUT consoleSource;
+		INPUTSOURCE* inputSource;
+		//Filled by the input thread, drained by ReadInputs()
+		SPSCRING<INPUTEVENT, 1024> inputRing;
+		std::thread inputThread;
+		std::atomic<bool> inputStopping;
+		//Set by the input thread when a read fails (The GetLastError() code), so ReadInputs() can report it on the main thread
+		std::atomic<DWORD> inputError;
+		std::vector<INPUTEVENT> _inputEvents;
+		std::chrono::steady_clock::time_point _inputFrameStart;
+		std::chrono::steady_clock::time_point _inputFrameEnd;
+	public:
+		const COORD& screenSize = _screenSize;
+		const int& pixelCount = _pixelCount;
+		const float& deltaTime = _deltaTime;
+						/// <summary>How far the current frame is between the last 2 'FixedUpdate()' steps (0.0 - 1.0), for interpolating what gets drawn</summary>
+		const float& interpolationAlpha = _interpolationAlpha;
+		bool running;
+		CHAR_INFO emptyChar;
+		bool autoClearScreen;
+		wchar_t title[256];
+		float fpsLimit;
+						/// <summary>The time between 'FixedUpdate()' calls in seconds (0 or less disables them)</summary>
+		float fixedTimeStep;
+						/// <summary>The most 'FixedUpdate()' calls a single frame can make to catch up (Stops slow frames from snowballing into slower ones)</summary>
+		int maxFixedSteps;
+						/// <summary>
+						/// Runs Render() for a frame on another thread while Update() already works on the next one, so a frame takes as long as the slower of the 2 instead of both added together
+						/// The tradeoff is 1 frame of extra latency: what's on screen is always what the previous Update() produced
+						/// While this is on, Update() must not draw or change anything Render() reads; it should hand everything over in SyncFrame() instead
+						/// </summary>
+		bool pipelineFrames;
+		float* zBuffer;
+						/// <summary>The engine's job system, for splitting work across threads (Reconfigure with 'jobs.Configure()')</summary>
+		JOBSYSTEM jobs;
+						/// <summary>Long-running coroutines, resumed on the main thread after every Update() (Start them with 'tasks.Start()'; their completion callbacks run right before SyncFrame())</summary>
+		TASKSCHEDULER tasks;
+						/// <summary>The passes drawn by the default Render() (Add passes in Setup(), declaring which of the resources below they read and write)</summary>
+		RENDERGRAPH renderGraph;
+						/// <summary>Render graph resource for 'zBuffer'</summary>
+		const RENDERGRAPH::RESOURCES RES_DEPTH = renderGraph.AddResource();
+						/// <summary>Render graph resource for the screen's characters and colors</summary>
+		const RENDERGRAPH::RESOURCES RES_COLOR = renderGraph.AddResource();
+						/// <summary>Render graph resource for the HUD layer (Persistent; cleared only when something drawing to it has to redraw)</summary>
+		const RENDERGRAPH::RESOURCES RES_HUD = renderGraph.AddResource([this]() { ClearHUD(); });
+						/// <summary>The machine-dependent settings in use (Change them with ApplyTuning() or AutoTune())</summary>
+		const TUNING& tuning = _tuning;
+						/// <summary>Settings to use as-is instead of benchmarking them or reading them from the cache (Only the ones that are 0 or above)</summary>
+		TUNING tuningOverride;
+						/// <summary>Whether Start() runs AutoTune() before Setup() (Otherwise it only applies 'tuningOverride')</summary>
+		bool autoTune;
+						/// <summary>The file AutoTune() caches its results in</summary>
+		const wchar_t* tuningFile;
+						/// <summary>How many seconds 'tasks' gets to run for each frame</summary>
+		float taskBudget;
+
+		//More data: float quickest = 100; float sum = 0; float frameAmount = 0;
+
+						/// <summary>0 -> nothing ; 1 -> released ; 2 -> pressed ; 3 -> held ; MOUSE_X and MOUSE_Y -> point on the command prompt</summary>
+		INPUTTABLE inputs;
+						/// <summary>Every raw event that arrived between 'inputFrameStart' and 'inputFrameEnd', in order and with the time it was read at (Already applied to 'inputs')</summary>
+		const std::vector<INPUTEVENT>& inputEvents = _inputEvents;
+						/// <summary>When the last frame's inputs were read (The start of the span 'inputEvents' covers)</summary>
+		const std::chrono::steady_clock::time_point& inputFrameStart = _inputFrameStart;
+						/// <summary>When this frame's inputs were read</summary>
+		const std::chrono::steady_clock::time_point& inputFrameEnd = _inputFrameEnd;
+						/// <summary>How many events the input thread has had to drop because ReadInputs() didn't drain them in time</summary>
+		unsigned int DroppedInputs() const { return inputRing.Dropped(); }
+						/// <summary>Whether input gets read on its own thread while Start() runs, so events are timestamped when they happen instead of once per frame (Set before Start())</summary>
+		bool threadedInput;
+
+						/// <summary>
+						/// Constructor for the command prompt engine
+						/// </summary>
+						/// <param name="screenWidth">The width of the command prompt in characters</param>
+						/// <param name="screenHeight">The height of the command prompt in characters</param>
+						/// <param name="fontWidth">The width of the characters in pixels</param>
+						/// <param name="fontHeight">The height of the characters in pixels (Less than 3 may cause lines between pixels; 1 may cause distortions for some resolutions)</param>
+						/// <param name="autoUpscale">Whether to automatically scale the font up so that it occupies the most amount of screen space</param>
+						/// <param name="clearScreen">Whether to automatically clear the screen at the beginning of 'Update()' (You can do so manually with the 'ClearFrame()' function)</param>
+						/// <param name="maxFPS">The minimum amount of time before the next frame is drawn (1/fps). Setting this to 0 or less will allow for infinte framerate</param>
+		CMDEngine(short screenWidth, short screenHeight, short fontWidth = 1, short fontHeight = 1, bool autoUpscale = true, bool clearScreen = true, float maxFPS = FPS60)
+		{
+			upscale = autoUpscale;
+			_screenSize = { (short)screenWidth, (short)screenHeight };
+			_pixelCount = screenWidth * screenHeight;
+			autoClearScreen = clearScreen;
+			running = true;
+			if (fontWidth > 30 || fontHeight > 30)
+			{
+				ThrowError(L"FontTooBig (30)");
+				return;
+			}
+			if (screenWidth < 15 || screenHeight < 2 || fontWidth < 1 || fontHeight < 1)
+			{
+				ThrowError(L"SmallerThanMin (15, 2, 1, 1)");
+				return;
+			}
+			screen = new CHAR_INFO[_pixelCount];
+			presentBuffer = new CHAR_INFO[_pixelCount];
+			zBuffer = new float[pixelCount];
+			hudLayer = new CHAR_INFO[_pixelCount];
+			hudDepth = new float[_pixelCount];
+			_deltaTime = 0;
+			_interpolationAlpha = 0;
+			fixedAccumulator = 0;
+			fixedTimeStep = 0;
+			maxFixedSteps = 5;
+			pipelineFrames = false;
+			taskBudget = 0.002f;
+			_tuning.threads = jobs.WorkerCount();
+			_tuning.pixelGrain = 0;
+			_tuning.clearKernel = CLEAR_SCALAR;
+			_tuning.presentMode = PRESENT_ASYNC;
+			autoTune = false;
+			tuningFile = L"CMDEngine.tune";
+			inputSource = &consoleSource;
+			inputStopping = false;
+			inputError = 0;
+			frameArena = 0;
+			threadedInput = true;
+			emptyChar.Char.UnicodeChar = 0x2588;
+			emptyChar.Attributes = 0x0000;
+			SetTitle(L"CMDEngine Program");
+			fpsLimit = (maxFPS > 0 ? maxFPS : 0);
+
+			//Setting up the console window (Not entirely sure about what everything here does, had to copy most of it due to the complexity)
+#pragma region ConsoleWindowSetup
+		//Creates an object that then basically functions as the console
+			console = CreateConsoleScreenBuffer(GENERIC_READ | GENERIC_WRITE, 0, NULL, CONSOLE_TEXTMODE_BUFFER, NULL);
+			//Gets a reference to the input handler
+			consoleInput = GetStdHandle(STD_INPUT_HANDLE);
+			consoleSource = CONSOLEINPUT(consoleInput);
+			//Changes some of the input handler's settings (Prevents highlighting and permits reading mouse input)
+			SetConsoleMode(consoleInput, ENABLE_EXTENDED_FLAGS | ENABLE_MOUSE_INPUT);
+			//Set the window size to the smallest possible
+			sr = { 0, 0, 1, 1 };
+			SetConsoleWindowInfo(console, true, &sr);
+			//Set the buffer size to the wanted size
+			if (!SetConsoleScreenBufferSize(console, _screenSize))
+			{
+				ThrowError(L"SetConsoleScreenBufferSize");
+				return;
+			}
+			//Assign the console object to the actual console (From now on changes to the console object will affect the actual console)
+			if (!SetConsoleActiveScreenBuffer(console))
+			{
+				ThrowError(L"SetConsoleActiveScreenBuffer");
+				return;
+			}
+
+			//Setting the cursor visibility
+			CONSOLE_CURSOR_INFO cci = CONSOLE_CURSOR_INFO();
+			cci.bVisible = false;
+			cci.dwSize = 3;
+			SetConsoleCursorInfo(console, &cci);
+
+			//Setting the character size and font
+			CONSOLE_FONT_INFOEX cfi = CONSOLE_FONT_INFOEX();
+			cfi.cbSize = sizeof(cfi);
+			cfi.dwFontSize.X = fontWidth;
+			cfi.dwFontSize.Y = fontHeight;
+			cfi.FontFamily = FF_DONTCARE;
+			cfi.FontWeight = FW_NORMAL;
+			//Don't know why, but  ' cfi.FaceName = L"Liberation Mono"; '  doesn't work, so instead 'wcscpy_s' has to be used
+			//	this copies the wide character string in the 2nd parameter into the variable in the 1st parameter
+			//wcscpy_s(cfi.FaceName, L"Liberation Mono");
+			if (!SetCurrentConsoleFontEx(console, false, &cfi))
+			{
+				ThrowError(L"SetConsoleActiveScreenBuffer");
+				return;
+			}
+
+			//Check to see if the wanted size is too big for the screen
+			CONSOLE_SCREEN_BUFFER_INFO csbi;
+			if (!GetConsoleScreenBufferInfo(console, &csbi))
+			{
+				ThrowError(L"GetConsoleScreenBufferInfo");
+				return;
+			}
+			if (_screenSize.Y > csbi.dwMaximumWindowSize.Y)
+			{
+				swprintf(_msg, 128, L"Screen Height / Font Height Too Big (%d * %d)", csbi.dwMaximumWindowSize.Y, fontHeight);
+				ThrowError(_msg);
+				return;
+			}
+			if (_screenSize.X > csbi.dwMaximumWindowSize.X)
+			{
+				swprintf(_msg, 128, L"Screen Width / Font Width Too Big (%d * %d)", csbi.dwMaximumWindowSize.X, fontWidth);
+				ThrowError(_msg);
+				return;
+			}
+
+			//Tries to scale the font up to make the window occupy the most screen space possible
+			if (autoUpscale)
+			{
+				float fontRatio = ((float)fontWidth) / ((float)fontHeight);
+				short tFW = fontWidth;
+				short tFH = fontHeight;
+				short i = 1;
+				while (true)
+				{
+					if ((fontRatio * i) == (trunc(fontRatio * i)))
+					{
+						cfi.dwFontSize.X = fontWidth + (short)(fontRatio * i);
+						cfi.dwFontSize.Y = fontHeight + i;
+						SetCurrentConsoleFontEx(console, false, &cfi);
+						GetConsoleScreenBufferInfo(console, &csbi);
+						if (_screenSize.X > csbi.dwMaximumWindowSize.X || _screenSize.Y > csbi.dwMaximumWindowSize.Y)
+						{
+							break;
+						}
+						tFW = fontWidth + (short)(fontRatio * i);
+						tFH = fontHeight + i;
+					}
+					i++;
+				}
+				cfi.dwFontSize.X = tFW;
+				cfi.dwFontSize.Y = tFH;
+				SetCurrentConsoleFontEx(console, false, &cfi);
+				GetConsoleScreenBufferInfo(console, &csbi);
+			}
+
+			//Set the window size to the wanted screen size
+			sr = { 0, 0, (short)(screenWidth - 1), (short)(screenHeight - 1) };
+			if (!SetConsoleWindowInfo(console, true, &sr))
+			{
+				ThrowError(L"SetConsoleWindowInfo");
+				return;
+			}
+#pragma endregion
+
+			//Gets a reference to the program window and changes some settings
+#pragma region WindowSettings
+		//Sets the title of the program to something random in order to distinguish it from the other programs on the computer
+			int temp = rand();
+			swprintf(_msg, 128, L"%d", temp);
+			SetConsoleTitle(_msg);
+			Sleep(40);
+			//Finds the window with that random name (Don't have to set it back to normal cause the 'UpdateTitle()' is run every frame anyways)
+			window = FindWindowW(NULL, _msg);
+			//Changes the window's settings (Prevents maximizing, minimizing, and resizing)
+			SetWindowLongPtrW(window, GWL_STYLE, WS_OVERLAPPEDWINDOW & ~(WS_MAXIMIZEBOX | WS_MINIMIZEBOX | WS_SIZEBOX));
+			::SetWindowPos(window, HWND_TOPMOST, 0, 0, 0, 0, SWP_SHOWWINDOW | SWP_NOSIZE | SWP_NOREPOSITION);
+#pragma endregion
+		}
+
+						/// <summary>
+						/// Prints an error message to the console (Returns 0 so that you can just do 'return ThrowError(...);')
+						/// </summary>
+						/// <param name="msg">The message to print to the console</param>
+		int ThrowError(const wchar_t* msg)
+		{
+			wchar_t _error[128];
+			FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM, NULL, GetLastError(), MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), _error, 128, NULL);
+			wprintf(L"ERROR: %s\n\t%s\n", msg, _error);
+			running = false;
+			return 0;
+		}
+
+		bool OnScreen(short x, short y) { return (x >= 0 && y >= 0 && x < screenSize.X&& y < screenSize.Y); }
+		bool OnScreen(VEC2F p) { return (p.x >= 0 && p.y >= 0 && p.x < screenSize.X&& p.y < screenSize.Y); }
+						/// <summary>How many whole steps in 'direction' (1 or -1) 'value' has to take to get into [low; high) (0 if it's already in it, or is moving away from it)</summary>
+		static int StepsOntoScreen(float value, short direction, int low, int high)
+		{
+			if (direction > 0 && value < low)
+				return (int)ceilf(low - value);
+			if (direction < 0 && value >= high)
+				return (int)floorf(value - high) + 1;
+			return 0;
+		}
+						/// <summary>Where a loop stepping in 'direction' (1 or -1) towards 'end' can stop, since everything after that is outside [low; high)</summary>
+		static float ScreenLoopEnd(float end, short direction, int low, int high) { return (direction > 0 ? min(end, (float)high) : max(end, (float)(low - 1))); }
+						/// <summary>The columns ('rows' = false) or rows that drawing limited to 'clip' can reach, as [low; high) (The screen narrowed down by the clip rect)</summary>
+		void DrawRange(bool rows, SMALL_RECT clip, int* low, int* high) const
+		{
+			*low = max((int)(rows ? clip.Top : clip.Left), 0);
+			*high = min((int)(rows ? clip.Bottom : clip.Right) + 1, (int)(rows ? screenSize.Y : screenSize.X));
+		}
+
+#pragma region DrawFunctions
+		//Simply modifies the value of the specified position in the screen array
+#pragma region Draw
+						/// <summary>
+						/// Draws to a specific point on the command prompt
+						/// </summary>
+						/// <param name="x">The x position of the point (Leftmost is 0; Rightmost is screenSize.X)</param>
+						/// <param name="y">The y position of the point (Topmost is 0; Bottommost is screenSize.Y)</param>
+						/// <param name="col">The color with which to draw to that point (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param>
+						/// <param name="cha">The character with which to draw to that point</param>
+						/// <param name="depth">How far away from the camera the pixel is (For rendering things on top of each other) (Negative values are always drawn)</param>
+		void Draw(short x, short y, short col = 0x000F, short cha = 0x2588, float depth = -1) { DrawTo(LAYER_SCREEN, x, y, col, cha, depth); }
+						/// <summary>Draws to a specific point of 'layer' (The layer is passed along instead of being a setting, so that a pass drawing to the HUD can't leak into work other threads pick up from it, or the other way around)</summary> /// <param name="layer">The buffer to draw to</param> /// <param name="x">The x position of the point (Leftmost is 0; Rightmost is screenSize.X)</param> /// <param name="y">The y position of the point (Topmost is 0; Bottommost is screenSize.Y)</param> /// <param name="col">The color with which to draw to that point (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw to that point</param> /// <param name="depth">How far away from the camera the pixel is (For rendering things on top of each other) (Negative values are always drawn)</param>
+		void DrawTo(LAYER layer, short x, short y, short col = 0x000F, short cha = 0x2588, float depth = -1) { DrawTo(layer, WHOLE_SCREEN, x, y, col, cha, depth); }
+						/// <summary>Draws to a specific point of 'layer', if it's inside 'clip' (The clip rect is passed along for the same reason as the layer, so that threads drawing into different parts of the screen can't spill into each other's)</summary> /// <param name="layer">The buffer to draw to</param> /// <param name="clip">The cells that can be drawn to, edges included</param> /// <param name="x">The x position of the point (Leftmost is 0; Rightmost is screenSize.X)</param> /// <param name="y">The y position of the point (Topmost is 0; Bottommost is screenSize.Y)</param> /// <param name="col">The color with which to draw to that point (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw to that point</param> /// <param name="depth">How far away from the camera the pixel is (For rendering things on top of each other) (Negative values are always drawn)</param>
+		void DrawTo(LAYER layer, SMALL_RECT clip, short x, short y, short col = 0x000F, short cha = 0x2588, float depth = -1)
+		{
+			CHAR_INFO* target = (layer == LAYER_HUD ? hudLayer : screen);
+			float* targetDepth = (layer == LAYER_HUD ? hudDepth : zBuffer);
+			if (OnScreen(x, y) && x >= clip.Left && y >= clip.Top && x <= clip.Right && y <= clip.Bottom && depth < targetDepth[y * screenSize.X + x])
+			{
+				target[y * screenSize.X + x].Char.UnicodeChar = cha;
+				target[y * screenSize.X + x].Attributes = col;
+				targetDepth[y * screenSize.X + x] = depth;
+			}
+		}
+						/// <summary>Draws to a specific point on the command prompt</summary> /// <param name="x">The x position of the point (Leftmost is 0; Rightmost is screenSize.X)</param> /// <param name="y">The y position of the point (Topmost is 0; Bottommost is screenSize.Y)</param> /// <param name="col">The color with which to draw to that point (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw to that point</param> /// <param name="depth">How far away from the camera the pixel is (For rendering things on top of each other) (Negative values are always drawn)</param>
+		void Draw(int x, int y, short col = 0x000F, short cha = 0x2588, float depth = -1) { Draw((short)x, (short)y, col, cha, depth); }
+		//Due to issues with numbers between 0-1 when casting, '(short)((short)(x + 2) - 2)' is needed, since numbers between 2-3 convert correctly
+						/// <summary>Draws to a specific point on the command prompt</summary> /// <param name="x">The x position of the point (Leftmost is 0; Rightmost is screenSize.X)</param> /// <param name="y">The y position of the point (Topmost is 0; Bottommost is screenSize.Y)</param> /// <param name="col">The color with which to draw to that point (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw to that point</param> /// <param name="depth">How far away from the camera the pixel is (For rendering things on top of each other) (Negative values are always drawn)</param>
+		void Draw(float x, float y, short col = 0x000F, short cha = 0x2588, float depth = -1) { Draw((short)((short)(x + 2) - 2), (short)((short)(y + 2) - 2), col, cha, depth); }
+						/// <summary>Draws to a specific point on the command prompt</summary> /// <param name="p">The position of the point (Leftmost is 0; Rightmost is screenSize.X; Topmost is 0; Bottommost is screenSize.Y)</param> /// <param name="col">The color with which to draw to that point (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw to that point</param> /// <param name="depth">How far away from the camera the pixel is (For rendering things on top of each other) (Negative values are always drawn)</param>
+		void Draw(VEC2F p, short col = 0x000F, short cha = 0x2588, float depth = -1) { Draw((short)((short)(p.x + 2) - 2), (short)((short)(p.y + 2) - 2), col, cha, depth); }
+						/// <summary>Same as Draw(float, float), but on 'layer' and inside 'clip' (See DrawTo())</summary>
+		void PlotTo(LAYER layer, SMALL_RECT clip, float x, float y, short col, short cha, float depth) { DrawTo(layer, clip, (short)((short)(x + 2) - 2), (short)((short)(y + 2) - 2), col, cha, depth); }
+#pragma endregion
+
+		//Gets the step size for the reaction in 1 axis when moving 1 unit in the other
+		//	by going from point 1 to point 2 like this in both axis, you can find every space through which the line crosses
+		//	but because they're floats, the points may not be exactly in a space, so for the first step you have to move less than 1 in the axis
+		//	after the first movement in each axis, the movements can be by 1 unit
+		//If the points are whole numbers, the first step can be skipped due to knowing that the points will always be exactly in a space
+		//Using relative screen space for the points is the same as normal, but with the added step of converting the coordinates first
+#pragma region DrawLine
+						/// <summary>
+						/// Draws a line on the command prompt from a point to another point
+						/// </summary>
+						/// <param name="x1">The x position of the first point (Leftmost is 0; Rightmost is screenSize.X)</param>
+						/// <param name="y1">The y position of the first point (Topmost is 0; Bottommost is screenSize.Y)</param>
+						/// <param name="x2">The x position of the second point (Leftmost is 0; Rightmost is screenSize.X)</param>
+						/// <param name="y2">The y position of the second point (Topmost is 0; Bottommost is screenSize.Y)</param>
+						/// <param name="col">The color with which to draw the line (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param>
+						/// <param name="cha">The character with which to draw the line</param>
+						/// <param name="depth1">How far away from the camera the first point is (For rendering things on top of each other) (Negative values are always drawn)</param>
+						/// <param name="depth2">How far away from the camera the second point is (For rendering things on top of each other) (Negative values are always drawn)</param>
+		void DrawLine(float x1, float y1, float x2, float y2, short col = 0x000F, short cha = 0x2588, float depth1 = -1, float depth2 = -1) { DrawLineTo(LAYER_SCREEN, x1, y1, x2, y2, col, cha, depth1, depth2); }
+						/// <summary>Draws a line on 'layer' from a point to another point (See DrawTo())</summary> /// <param name="layer">The buffer to draw to</param> /// <param name="x1">The x position of the first point (Leftmost is 0; Rightmost is screenSize.X)</param> /// <param name="y1">The y position of the first point (Topmost is 0; Bottommost is screenSize.Y)</param> /// <param name="x2">The x position of the second point (Leftmost is 0; Rightmost is screenSize.X)</param> /// <param name="y2">The y position of the second point (Topmost is 0; Bottommost is screenSize.Y)</param> /// <param name="col">The color with which to draw the line (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw the line</param> /// <param name="depth1">How far away from the camera the first point is (For rendering things on top of each other) (Negative values are always drawn)</param> /// <param name="depth2">How far away from the camera the second point is (For rendering things on top of each other) (Negative values are always drawn)</param>
+		void DrawLineTo(LAYER layer, float x1, float y1, float x2, float y2, short col = 0x000F, short cha = 0x2588, float depth1 = -1, float depth2 = -1) { DrawLineTo(layer, WHOLE_SCREEN, x1, y1, x2, y2, col, cha, depth1, depth2); }
+						/// <summary>Draws a line on 'layer' from a point to another point, only inside 'clip' (See DrawTo())</summary>
+		void DrawLineTo(LAYER layer, SMALL_RECT clip, float x1, float y1, float x2, float y2, short col = 0x000F, short cha = 0x2588, float depth1 = -1, float depth2 = -1)
+		{
+			auto plot = [this, layer, clip, col, cha](float x, float y, float depth) { PlotTo(layer, clip, x, y, col, cha, depth); };
+			short ux = (x1 < x2 ? 1 : -1), uy = (y1 < y2 ? 1 : -1);
+			float tx = x2 - x1, ty = y2 - y1;
+			float sx = (ty != 0 ? ux * abs(tx / ty) : 0), sy = (tx != 0 ? uy * abs(ty / tx) : 0);
+			plot(x1, y1, depth1);
+			plot(x2, y2, depth2);
+			tx = (float)fmod(ux - fmod(x1, 1.0f), 1.0f);
+			ty = (float)fmod(uy - fmod(y1, 1.0f), 1.0f);
+			//How much the depth changes per unit along each axis, so that every step only adds it on
+			float dx = (x1 != x2 ? (depth2 - depth1) / (x2 - x1) : 0), dy = (y1 != y2 ? (depth2 - depth1) / (y2 - y1) : 0);
+			float depth = depth1 + tx * dx;
+			for (float x = x1 + tx, y = y1 + uy * abs(tx * sy); x * ux < x2 * ux; x += ux, y += sy, depth += ux * dx)
+			{
+				plot(x, y, depth);
+			}
+			depth = depth1 + ty * dy;
+			for (float y = y1 + ty, x = x1 + ux * abs(ty * sx); y * uy < y2 * uy; y += uy, x += sx, depth += uy * dy)
+			{
+				plot(x, y, depth);
+			}
+		}
+						/// <summary>Draws a line on the command pront from a point to another point</summary> /// <param name="p1">The position of the first point (Leftmost is 0; Rightmost is screenSize.X; Topmost is 0; Bottommost is screenSize.Y)</param> /// <param name="p2">The position of the second point (Leftmost is 0; Rightmost is screenSize.X; Topmost is 0; Bottommost is screenSize.Y)</param> /// <param name="col">The color with which to draw the line (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw the line</param> /// <param name="depth1">How far away from the camera the first point is (For rendering things on top of each other) (Negative values are always drawn)</param> /// <param name="depth2">How far away from the camera the second point is (For rendering things on top of each other) (Negative values are always drawn)</param>
+		void DrawLine(VEC2F p1, VEC2F p2, short col = 0x000F, short cha = 0x2588, float depth1 = -1, float depth2 = -1) { DrawLine(p1.x, p1.y, p2.x, p2.y, col, cha, depth1, depth2); }
+						/// <summary>Draws a line on the command pront from a point in relative screen space to another point in relative screen space</summary> /// <param name="x1">The x position of the first point in relative screen space (Leftmost is 0.0; Rightmost is 1.0)</param> /// <param name="y1">The y position of the first point in relative screen space (Topmost is 0.0; Bottommost is 1.0)</param> /// <param name="x2">The x position of the second point in relative screen space (Leftmost is 0.0; Rightmost is 1.0)</param> /// <param name="y2">The y position of the second point in relative screen space (Topmost is 0.0; Bottommost is 1.0)</param> /// <param name="col">The color with which to draw the line (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw the line</param> /// <param name="depth1">How far away from the camera the first point is (For rendering things on top of each other) (Negative values are always drawn)</param> /// <param name="depth2">How far away from the camera the second point is (For rendering things on top of each other) (Negative values are always drawn)</param>
+		void DrawLineS(float x1, float y1, float x2, float y2, short col = 0x000F, short cha = 0x2588, float depth1 = -1, float depth2 = -1) { DrawLine(ScreenPosToPoint(x1, y1), ScreenPosToPoint(x2, y2), col, cha, depth1, depth2); }
+						/// <summary>Draws a line on the command pront from a point in relative screen space to another point in relative screen space</summary> /// <param name="p1">The position of the first point in relative screen space (Leftmost is 0.0; Rightmost is 1.0; Topmost is 0.0; Bottommost is 1.0)</param> /// <param name="p2">The position of the second point in relative screen space (Leftmost is 0.0; Rightmost is 1.0; Topmost is 0.0; Bottommost is 1.0)</param> /// <param name="col">The color with which to draw the line (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw the line</param> /// <param name="depth1">How far away from the camera the first point is (For rendering things on top of each other) (Negative values are always drawn)</param> /// <param name="depth2">How far away from the camera the second point is (For rendering things on top of each other) (Negative values are always drawn)</param>
+		void DrawLineS(VEC2F p1, VEC2F p2, short col = 0x000F, short cha = 0x2588, float depth1 = -1, float depth2 = -1) { DrawLine(ScreenPosToPoint(p1), ScreenPosToPoint(p2), col, cha, depth1, depth2); }
+#pragma endregion
+
+		//Uses trigonometry to get the vertices of a regular polygon of 'edges' sides and then connects them with lines
+		//Using relative screen space for the polygon requires the conversion of the center point and the radius
+		//	but due to the radius not being a point, it must be defined relative to the width or height of the screen
+#pragma region DrawRPoly
+						/// <summary>
+						/// Draws a regular polygon to the screen
+						/// </summary>
+						/// <param name="cx">The x position of the center of the polygon</param>
+						/// <param name="cy">The y position of the center of the polygon</param>
+						/// <param name="edges">The amount of edges the polygon has</param>
+						/// <param name="rad">The distance from the center point to each of the vertices</param>
+						/// <param name="rot">The angle at which to draw the polygon in degrees</param>
+						/// <param name="col">The color with which to draw the polygon (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param>
+						/// <param name="cha">The character with which to draw the polygon</param>
+						/// <param name="depth">How far away from the camera the shape is (For rendering things on top of each other) (Negative values are always drawn)</param>
+		void DrawRPoly(float cx, float cy, short edges, float rad, float rot = 0, short col = 0x000F, short cha = 0x2588, float depth = -1)
+		{
+			float as = (360.0f / edges) * RAD;
+			float max = (360.0f + rot) * RAD;
+			for (float a = rot * RAD; a < max; a += as)
+			{
+				DrawLine((float)cos(a) * rad + cx, (float)sin(a) * rad + cy, (float)cos(a + as) * rad + cx, (float)sin(a + as) * rad + cy, col, cha, depth, depth);
+			}
+		}
+						/// <summary>Draws a regular polygon to the screen</summary> /// <param name="p">The position of the center of the polygon</param> /// <param name="edges">The amount of edges the polygon has</param> /// <param name="rad">The distance from the center point to each of the vertices</param> /// <param name="rot">The angle at which to draw the polygon in degrees</param> /// <param name="col">The color with which to draw the polygon (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw the polygon</param> /// <param name="depth">How far away from the camera the pixel is (For rendering things on top of each other) (Negative values are always drawn)</param>
+		void DrawRPoly(VEC2F p, short edges, float rad, float rot = 0, short col = 0x000F, short cha = 0x2588, float depth = -1) { DrawRPoly(p.x, p.y, edges, rad, rot, col, cha, depth); }
+						/// <summary>Draws a regular polygon to the screen using relative screen space</summary> /// <param name="cx">The x position of the center of the polygon in relative screen space</param> /// <param name="cy">The y position of the center of the polygon in relative screen space</param> /// <param name="edges">The amount of edges the polygon has</param> /// <param name="rad">The distance from the center point to each of the vertices in relative screen space</param> /// <param name="useY">Whether the radius' size is defined by the screen's height or width ('true' means height is used; 'false' for width)</param> /// <param name="rot">The angle at which to draw the polygon in degrees</param> /// <param name="col">The color with which to draw the polygon (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw the polygon</param> /// <param name="depth">How far away from the camera the pixel is (For rendering things on top of each other) (Negative values are always drawn)</param>
+		void DrawRPolyS(float cx, float cy, short edges, float rad, bool useY, float rot = 0, short col = 0x000F, short cha = 0x2588, float depth = -1) { DrawRPoly(ScreenPosToPoint(cx, cy), edges, (useY ? ScreenPosToPoint(0, rad).y : ScreenPosToPoint(rad, 0).x), rot, col, cha, depth); }
+						/// <summary>Draws a regular polygon to the screen using relative screen space</summary> /// <param name="p">The position of the center of the polygon in relative screen space</param> /// <param name="edges">The amount of edges the polygon has</param> /// <param name="rad">The distance from the center point to each of the vertices in relative screen space</param> /// <param name="useY">Whether the radius' size is defined by the screen's height or width ('true' means height is used; 'false' for width)</param> /// <param name="rot">The angle at which to draw the polygon in degrees</param> /// <param name="col">The color with which to draw the polygon (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="cha">The character with which to draw the polygon</param> /// <param name="depth">How far away from the camera the pixel is (For rendering things on top of each other) (Negative values are always drawn)</param>
+		void DrawRPolyS(VEC2F p, short edges, float rad, bool useY, float rot = 0, short col = 0x000F, short cha = 0x2588, float depth = -1) { DrawRPolyS(p.x, p.y, edges, rad, useY, rot, col, cha, depth); }
+#pragma endregion
+
+						/// <summary>
+						/// Writes a line of text starting from a point on the command prompt
+						/// </summary>
+						/// <param name="x">The x position of the leftmost character</param>
+						/// <param name="y">The y position on which to write the line</param>
+						/// <param name="text">The text to write</param>
+						/// <param name="length">The amount of characters in the text</param>
+						/// <param name="col">The color with which to draw to that point (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param>
+						/// <param name="depth">How far away from the camera the text is (For rendering things on top of each other) (Negative values are always drawn)</param>
+		void WriteText(short x, short y, wchar_t* text, short length, short col = 0x000F, float depth = -1) { WriteTextTo(LAYER_SCREEN, x, y, text, length, col, depth); }
+						/// <summary>Writes a line of text on 'layer' (See DrawTo())</summary> /// <param name="layer">The buffer to draw to</param> /// <param name="x">The x position at which to start writing the line</param> /// <param name="y">The y position on which to write the line</param> /// <param name="text">The text to write</param> /// <param name="length">The amount of characters in the text</param> /// <param name="col">The color with which to draw to that point (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param> /// <param name="depth">How far away from the camera the text is (For rendering things on top of each other) (Negative values are always drawn)</param>
+		void WriteTextTo(LAYER layer, short x, short y, wchar_t* text, short length, short col = 0x000F, float depth = -1)
+		{
+			for (short i = 0; i < length; i++)
+			{
+				DrawTo(layer, (short)(i + x), y, col, text[i], depth);
+			}
+		}
+
+						/// <summary>
+						/// Draws a filled in triangle to the command prompt from 3 vertices
+						/// </summary>
+						/// <param name="v1">The first vertice of the triangle</param>
+						/// <param name="v2">The second vertice of the triangle</param>
+						/// <param name="v3">The third vertice of the triangle</param>
+						/// <param name="col">The color with which to draw to that point (16 available colors (0-F); Must be inputted as Hex 0x0000; The last 2 zeros determine the background and foreground colors respectively (0x00BF))</param>
+						/// <param name="cha">The character with which to draw to that point</param>
+						/// <param name="depth1">How far away from the camera the first vertice is (For rendering things on top of each other) (Negative values are always drawn)</param>
+						/// <param name="depth2">How far away from the camera the second vertice is (For rendering things on top of each other) (Negative values are always drawn)</param>
+						/// <param name="depth3">How far away from the camera the third vertice is (For rendering things on top of each other) (Negative values are always drawn)</param>
+		void DrawTriangle(VEC2F v1, VEC2F v2, VEC2F v3, short col = 0x000F, short cha = 0x2588, float depth1 = -1, float depth2 = -1, float depth3 = -1) { DrawTriangleTo(LAYER_SCREEN, WHOLE_SCREEN, v1, v2, v3, col, cha, depth1, depth2, depth3); }
+						/// <summary>Draws a filled triangle on 'layer', only inside 'clip' (See DrawTo())</summary>
+		void DrawTriangleTo(LAYER layer, SMALL_RECT clip, VEC2F v1, VEC2F v2, VEC2F v3, short col = 0x000F, short cha = 0x2588, float depth1 = -1, float depth2 = -1, float depth3 = -1)
+		{
+			VEC3F list[3] = { VEC3F(v1.x, v1.y, depth1), VEC3F(v2.x, v2.y, depth2), VEC3F(v3.x, v3.y, depth3) };
+			for (short i = 0; i < 2; i++)
+			{
+				if (list[i].y < list[0].y)
+				{
+					std::swap(list[i], list[0]);
+				}
+				if (list[i].y > list[2].y)
+				{
+					std::swap(list[i], list[2]);
+				}
+			}
+			if ((short)list[0].y == (short)list[2].y)
+			{
+				//Line
+				DrawLineTo(layer, clip, list[0].x, list[0].y, list[1].x, list[1].y, col, cha, list[0].z, list[1].z);
+				DrawLineTo(layer, clip, list[1].x, list[1].y, list[2].x, list[2].y, col, cha, list[1].z, list[2].z);
+				DrawLineTo(layer, clip, list[2].x, list[2].y, list[0].x, list[0].y, col, cha, list[2].z, list[0].z);
+				return;
+			}
+			//The whole triangle is 1 plane, so the depth's gradient only gets worked out here (Even if it gets split in 2)
+			RasterTriangle(layer, clip, list, col, cha, GRADIENT(list[0], list[1], list[2]));
+		}
+
+						/// <summary>Fills in a triangle that's sorted from top to bottom and is taller than 1 row, taking the depth of every cell from 'depth'</summary>
+		void RasterTriangle(LAYER layer, SMALL_RECT clip, VEC3F list[3], short col, short cha, const GRADIENT& depth)
+		{
+			VEC3F b1, b2, t1;
+			if ((short)list[0].y == (short)list[1].y)
+			{
+				b1 = list[0];
+				b2 = list[1];
+				t1 = list[2];
+			}
+			else
+			{
+				if ((short)list[1].y == (short)list[2].y)
+				{
+					b1 = list[1];
+					b2 = list[2];
+					t1 = list[0];
+				}
+				else
+				{
+					//Turn into 2 triangles with a flat side and then pass them both through this function
+					b1 = list[1];
+					b2 = VEC3F(LinearFunction(list[0].y, list[0].x, list[2].y, list[2].x, b1.y), b1.y, 0);
+					b2.z = depth.At(b2.x, b2.y);
+					VEC3F top[3] = { list[0], b1, b2 };
+					VEC3F bottom[3] = { b1, b2, list[2] };
+					RasterTriangle(layer, clip, top, col, cha, depth);
+					RasterTriangle(layer, clip, bottom, col, cha, depth);
+					return;
+				}
+			}
+			//The 'DrawLine()' code but slightly modified so that 2 lines can be done at once
+			//If you draw 2 lines to the same point, both starting at the same Y level and filling in the space between them every time the Y level changes
+			//then you've drawn a triangle
+			short ux1 = (b1.x < t1.x ? 1 : -1), ux2 = (b2.x < t1.x ? 1 : -1), uy = (b1.y < t1.y ? 1 : -1);
+			float tx1 = t1.x - b1.x, tx2 = t1.x - b2.x, ty = t1.y - b1.y;
+			float sx1 = (ty != 0 ? ux1 * abs(tx1 / ty) : 0), sy1 = (tx1 != 0 ? uy * abs(ty / tx1) : 0), sx2 = (ty != 0 ? ux2 * abs(tx2 / ty) : 0), sy2 = (tx2 != 0 ? uy * abs(ty / tx2) : 0);
+			DrawLineTo(layer, clip, b1.x, b1.y, b2.x, b2.y, col, cha, b1.z, b2.z);
+			PlotTo(layer, clip, t1.x, t1.y, col, cha, t1.z);
+			tx1 = (float)fmod(ux1 - fmod(b1.x, 1.0f), 1.0f);
+			tx2 = (float)fmod(ux2 - fmod(b2.x, 1.0f), 1.0f);
+			ty = (float)fmod(uy - fmod(b1.y, 1.0f), 1.0f);
+
+			//Every loop gets its starting depth from the gradient, and then each step adds on however far it moved in x and y
+			//Triangles can reach past the screen (Up to the guard band when clipping), so every loop skips straight to where it comes onto the screen (Or into the clip rect) and stops where it leaves it
+			int lowX, highX, lowY, highY;
+			DrawRange(false, clip, &lowX, &highX);
+			DrawRange(true, clip, &lowY, &highY);
+			//+1 on x for line 1 & +? on y for line 1
+			float x = b1.x + tx1, y = b1.y + uy * abs(tx1 * sy1);
+			int skip = StepsOntoScreen(x, ux1, lowX, highX);
+			x += ux1 * skip;
+			y += sy1 * skip;
+			for (float d = depth.At(x, y), step = ux1 * depth.dx + sy1 * depth.dy, end = ScreenLoopEnd(t1.x, ux1, lowX, highX); x * ux1 < end * ux1; x += ux1, y += sy1, d += step)
+			{
+				PlotTo(layer, clip, x, y, col, cha, d);
+			}
+			//+1 on x for line 2 & +? on y for line 2
+			x = b2.x + tx2;
+			y = b2.y + uy * abs(tx2 * sy2);
+			skip = StepsOntoScreen(x, ux2, lowX, highX);
+			x += ux2 * skip;
+			y += sy2 * skip;
+			for (float d = depth.At(x, y), step = ux2 * depth.dx + sy2 * depth.dy, end = ScreenLoopEnd(t1.x, ux2, lowX, highX); x * ux2 < end * ux2; x += ux2, y += sy2, d += step)
+			{
+				PlotTo(layer, clip, x, y, col, cha, d);
+			}
+			//+1 on y for line 1 & 2, & +? on x for line 1 & 2
+			y = b1.y + ty;
+			skip = StepsOntoScreen(y, uy, lowY, highY);
+			y += uy * skip;
+			float x1 = b1.x + ux1 * abs(ty * sx1) + sx1 * skip, x2 = b2.x + ux2 * abs(ty * sx2) + sx2 * skip;
+			float d1 = depth.At(x1, y), d2 = depth.At(x2, y), step1 = uy * depth.dy + sx1 * depth.dx, step2 = uy * depth.dy + sx2 * depth.dx;
+			for (float end = ScreenLoopEnd(t1.y, uy, lowY, highY); y * uy < end * uy; y += uy, x1 += sx1, x2 += sx2, d1 += step1, d2 += step2)
+			{
+				DrawSpan(layer, clip, x1, x2, y, col, cha, d1, depth.dx);
+			}
+		}
+
+						/// <summary>Draws the same cells as a horizontal 'DrawLine()', but steps the depth along by 'depthStep' per cell instead of setting up an interpolation</summary>
+		void DrawSpan(LAYER layer, SMALL_RECT clip, float x1, float x2, float y, short col, short cha, float depth1, float depthStep)
+		{
+			short ux = (x1 < x2 ? 1 : -1);
+			PlotTo(layer, clip, x1, y, col, cha, depth1);
+			PlotTo(layer, clip, x2, y, col, cha, depth1 + (x2 - x1) * depthStep);
+			float tx = (float)fmod(ux - fmod(x1, 1.0f), 1.0f);
+			//Only the part that's on the screen (And inside the clip rect) gets walked
+			int low, high;
+			DrawRange(false, clip, &low, &high);
+			tx += ux * StepsOntoScreen(x1 + tx, ux, low, high);
+			float d = depth1 + tx * depthStep;
+			for (float x = x1 + tx, end = ScreenLoopEnd(x2, ux, low, high); x * ux < end * ux; x += ux, d += ux * depthStep)
+			{
+				PlotTo(layer, clip, x, y, col, cha, d);
+			}
+		}
+#pragma endregion
+
+						/// <summary>
+						/// Converts a relative screen space position ('0.0 - 1.0' is 'Left - Right' or 'Top - Bottom') to a point in the pixel grid ('0.0 - screenSize.X' is 'Left - Right' and '0.0 - screenSize.Y' is 'Top - Bottom')
+						/// </summary>
+						/// <param name="x">The x value (If outside of range [0.0; 1.0] the resulting pixel will be out of the screen)</param>
+						/// <param name="y">The y value (If outside of range [0.0; 1.0] the resulting pixel will be out of the screen)</param>
+		VEC2F ScreenPosToPoint(float x, float y)
+		{
+			return { x * screenSize.X, y * screenSize.Y };
+		}
+						///<summary>Converts a relative screen space position ('0.0 - 1.0' is 'Left - Right' or 'Top - Bottom') to a point in the pixel grid ('0.0 - screenSize.X' is 'Left - Right' and '0.0 - screenSize.Y' is 'Top - Bottom')</summary> /// <param name="p">The value (If x or y is outside of range [0.0; 1.0] the resulting pixel will be out of the screen)</param>
+		VEC2F ScreenPosToPoint(VEC2F p) { return { p.x * screenSize.X, p.y * screenSize.Y }; }
+
+						/// <summary>Fills the entire console with the character and color in the 'empty' variable</summary>
+		void ClearFrame()
+		{
+			jobs.ParallelFor(0, pixelCount, _tuning.pixelGrain, [this](int begin, int end) { ClearRange(screen, zBuffer, begin, end); });
+		}
+
+						/// <summary>Empties the HUD layer</summary>
+		void ClearHUD()
+		{
+			jobs.ParallelFor(0, pixelCount, _tuning.pixelGrain, [this](int begin, int end) { ClearRange(hudLayer, hudDepth, begin, end); });
+		}
+
+						/// <summary>Sets the range [begin; end) of a layer to 'emptyChar' with a depth of 1, using the clear kernel picked by the tuning</summary>
+		void ClearRange(CHAR_INFO* chars, float* depths, int begin, int end)
+		{
+			if (_tuning.clearKernel == CLEAR_SSE2)
+			{
+				//A CHAR_INFO is 4 bytes, so each store writes 4 characters (And 4 depths)
+				static_assert(sizeof(CHAR_INFO) == sizeof(int), "CHAR_INFO has to be 4 bytes for the SSE2 clear");
+				int packed;
+				memcpy(&packed, &emptyChar, sizeof(int));
+				__m128i charValue = _mm_set1_epi32(packed);
+				__m128 depthValue = _mm_set1_ps(1.0f);
+				for (; begin + 4 <= end; begin += 4)
+				{
+					_mm_storeu_si128((__m128i*)(chars + begin), charValue);
+					_mm_storeu_ps(depths + begin, depthValue);
+				}
+			}
+			for (int i = begin; i < end; i++)
+			{
+				chars[i] = emptyChar;
+				depths[i] = 1;
+			}
+		}
+
+						/// <summary>Copies everything drawn to the HUD layer on top of the screen</summary>
+		void CompositeHUD()
+		{
+			jobs.ParallelFor(0, pixelCount, _tuning.pixelGrain, [this](int begin, int end)
+			{
+				for (int i = begin; i < end; i++)
+				{
+					if (hudDepth[i] != 1)
+					{
+						screen[i] = hudLayer[i];
+						zBuffer[i] = hudDepth[i];
+					}
+				}
+			});
+		}
+
+						/// <summary>Writes the current frame to the console right away</summary>
+		void DrawFrame()
+		{
+			jobs.Wait(presentJob);
+			WriteConsoleOutput(console, screen, { screenSize.X, screenSize.Y }, { 0, 0 }, &sr);
+		}
+
+						/// <summary>Queues the current frame to be written to the console in the background (The frame gets copied, so drawing can continue straight away) (Writes it right away instead when the tuning's present mode is PRESENT_SYNC)</summary>
+		void Present()
+		{
+			//The previous frame has to be fully written before its buffer can be reused
+			jobs.Wait(presentJob);
+			if (_tuning.presentMode == PRESENT_SYNC)
+			{
+				WriteConsoleOutput(console, screen, { screenSize.X, screenSize.Y }, { 0, 0 }, &sr);
+				return;
+			}
+			memcpy(presentBuffer, screen, sizeof(CHAR_INFO) * pixelCount);
+			presentJob = jobs.Schedule([this]() { WriteConsoleOutput(console, presentBuffer, { screenSize.X, screenSize.Y }, { 0, 0 }, &sr); });
+		}
+
+						/// <summary>Switches to the given settings, leaving the ones below 0 as they are (Call it between frames, from the thread that called Start())</summary>
+		void ApplyTuning(TUNING settings)
+		{
+			if (settings.threads >= 0)
+			{
+				int threads = (settings.threads > 0 ? settings.threads : max(1, (int)std::thread::hardware_concurrency()));
+				if (threads != jobs.WorkerCount())
+				{
+					jobs.Wait(renderJob);
+					jobs.Wait(presentJob);
+					jobs.Configure(threads);
+				}
+			}
+			_tuning.threads = jobs.WorkerCount();
+			if (settings.pixelGrain >= 0)
+			{
+				_tuning.pixelGrain = settings.pixelGrain;
+			}
+			if (settings.clearKernel >= 0 && settings.clearKernel < CLEAR_KERNEL_COUNT)
+			{
+				_tuning.clearKernel = settings.clearKernel;
+			}
+			if (settings.presentMode >= 0 && settings.presentMode < PRESENT_MODE_COUNT)
+			{
+				_tuning.presentMode = settings.presentMode;
+			}
+		}
+
+						/// <summary>
+						/// Applies the best settings for this machine and screen size, reading them from 'tuningFile' or benchmarking them (And saving them there) if they aren't in it yet. Returns whether it benchmarked
+						/// Anything set in 'tuningOverride' is used instead, and isn't saved
+						/// </summary>
+						/// <param name="rebenchmark">Whether to benchmark even if there are saved settings (Ex. after a hardware change)</param>
+		bool AutoTune(bool rebenchmark = false)
+		{
+			wchar_t machine[64] = { 0 };
+			DWORD machineLength = 64;
+			if (!GetComputerNameW(machine, &machineLength))
+			{
+				swprintf(machine, 64, L"Unknown");
+			}
+			int cores = (int)std::thread::hardware_concurrency();
+
+			TUNINGFILE cache = TUNINGFILE();
+			FILE file;
+			file.fileHandle = CreateFileW(tuningFile, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (file.fileHandle != INVALID_HANDLE_VALUE)
+			{
+				file.ProcessFile<TUNINGFILE>(&cache);
+			}
+			TUNINGFILE::ENTRY* entry = cache.Find(machine, cores, screenSize.X, screenSize.Y);
+			if (entry && !rebenchmark)
+			{
+				ApplyTuning(entry->tuning);
+				ApplyTuning(tuningOverride);
+				return false;
+			}
+
+			TUNING measured = BenchmarkTuning();
+			if (!entry)
+			{
+				cache.entries.push_back(TUNINGFILE::ENTRY());
+				entry = &cache.entries.back();
+				swprintf(entry->machine, 64, L"%ls", machine);
+				entry->cores = cores;
+				entry->width = screenSize.X;
+				entry->height = screenSize.Y;
+			}
+			entry->tuning = measured;
+			file.fileHandle = CreateFileW(tuningFile, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (file.fileHandle != INVALID_HANDLE_VALUE)
+			{
+				TUNINGFILE::Export(file, cache);
+				CloseHandle(file.fileHandle);
+			}
+			return true;
+		}
+
+						/// <summary>Times every candidate setting on the actual screen size and applies the fastest, 1 setting at a time (Threads; grain; clear kernel; present mode). Returns what it picked, with the overridden settings left at -1</summary>
+		TUNING BenchmarkTuning()
+		{
+			//The full-screen kernels that the thread count, grain and clear kernel affect
+			std::function<void()> kernels = [this]()
+			{
+				ClearFrame();
+				ClearHUD();
+				CompositeHUD();
+			};
+			//Triangles filling the screen a few times over, drawn in bands on separate jobs the way viewports are (Each band clipped to its own rows)
+			//	The thread count applies to every job, so it's also timed on this compute-bound drawing and not only on the memory-bound kernels
+			std::function<void()> drawing = [this]()
+			{
+				const int bands = 16;
+				jobs.ParallelFor(0, bands, 1, [this, bands](int begin, int end)
+				{
+					for (int b = begin; b < end; b++)
+					{
+						SMALL_RECT band = { 0, (short)(screenSize.Y * b / bands), (short)(screenSize.X - 1), (short)(screenSize.Y * (b + 1) / bands - 1) };
+						for (int t = 0; t < 8; t++)
+						{
+							float depth = 1.0f - (t + 1) / 9.0f;
+							DrawTriangleTo(LAYER_SCREEN, band, VEC2F(0, 0), VEC2F(screenSize.X - 1.0f, screenSize.Y * t / 8.0f), VEC2F(screenSize.X * t / 8.0f, screenSize.Y - 1.0f), (short)(t + 1), 0x2588, depth, depth, depth);
+						}
+					}
+				});
+			};
+			//A few whole frames, so an asynchronous present gets to overlap with the next frame's work like it normally would
+			std::function<void()> frames = [this]()
+			{
+				for (int i = 0; i < 4; i++)
+				{
+					ClearFrame();
+					CompositeHUD();
+					Present();
+				}
+				jobs.Wait(presentJob);
+			};
+
+			TUNING measured = TUNING();
+			int hardwareThreads = max(1, (int)std::thread::hardware_concurrency());
+			std::vector<int> candidates;
+			for (int threads = 1; threads < hardwareThreads; threads *= 2)
+			{
+				candidates.push_back(threads);
+			}
+			candidates.push_back(hardwareThreads);
+			measured.threads = BenchmarkSetting(&TUNING::threads, candidates, [&kernels, &drawing]() { kernels(); drawing(); }, 20);
+
+			candidates = { 0 };
+			for (int grain = 256; grain < pixelCount; grain *= 4)
+			{
+				candidates.push_back(grain);
+			}
+			measured.pixelGrain = BenchmarkSetting(&TUNING::pixelGrain, candidates, kernels, 20);
+
+			candidates.clear();
+			for (int kernel = 0; kernel < CLEAR_KERNEL_COUNT; kernel++)
+			{
+				candidates.push_back(kernel);
+			}
+			measured.clearKernel = BenchmarkSetting(&TUNING::clearKernel, candidates, kernels, 20);
+
+			candidates.clear();
+			for (int mode = 0; mode < PRESENT_MODE_COUNT; mode++)
+			{
+				candidates.push_back(mode);
+			}
+			measured.presentMode = BenchmarkSetting(&TUNING::presentMode, candidates, frames, 3);
+			return measured;
+		}
+
+						/// <summary>
+						/// Applies each candidate value for 1 setting and times 'body' with it, leaving the fastest one applied and returning it (Returns -1 without benchmarking if 'tuningOverride' sets it)
+						/// </summary>
+						/// <param name="setting">The TUNING member to benchmark (Ex. '&TUNING::threads')</param>
+						/// <param name="candidates">The values to try</param>
+						/// <param name="body">The work to time</param>
+						/// <param name="runs">How many times to time it per candidate (The fastest run is the one that counts, since slower ones were only slowed down by something else)</param>
+		int BenchmarkSetting(int TUNING::* setting, const std::vector<int>& candidates, const std::function<void()>& body, int runs)
+		{
+			TUNING settings = TUNING();
+			if (tuningOverride.*setting >= 0)
+			{
+				settings.*setting = tuningOverride.*setting;
+				ApplyTuning(settings);
+				return -1;
+			}
+			int best = candidates.at(0);
+			float bestTime = FLT_MAX;
+			for (int candidate : candidates)
+			{
+				settings.*setting = candidate;
+				ApplyTuning(settings);
+				//Warm-up run (Wakes the threads and pulls the buffers into the cache)
+				body();
+				float fastest = FLT_MAX;
+				for (int i = 0; i < runs; i++)
+				{
+					std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+					body();
+					fastest = min(fastest, std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count());
+				}
+				if (fastest < bestTime)
+				{
+					bestTime = fastest;
+					best = candidate;
+				}
+			}
+			settings.*setting = best;
+			ApplyTuning(settings);
+			return best;
+		}
+
+		void ResizeWindow(short screenWidth, short screenHeight, short fontWidth = 1, short fontHeight = 1)
+		{
+			if (fontWidth > 30 || fontHeight > 30)
+			{
+				ThrowError(L"FontTooBig (30)");
+				return;
+			}
+			if (screenWidth < 15 || screenHeight < 2 || fontWidth < 1 || fontHeight < 1)
+			{
+				ThrowError(L"SmallerThanMin (15, 2, 1, 1)");
+				return;
+			}
+			jobs.Wait(presentJob);
+			_screenSize = { (short)screenWidth, (short)screenHeight };
+			_pixelCount = screenWidth * screenHeight;
+			screen = new CHAR_INFO[pixelCount];
+			presentBuffer = new CHAR_INFO[pixelCount];
+			hudLayer = new CHAR_INFO[pixelCount];
+			hudDepth = new float[pixelCount];
+			ClearHUD();
+			renderGraph.Invalidate();
+			//Setting up the console window (Not entirely sure about what everything here does, had to copy most of it due to the complexity)
+#pragma region ConsoleWindowSetup
+		//Creates an object that then basically functions as the console
+			console = CreateConsoleScreenBuffer(GENERIC_READ | GENERIC_WRITE, 0, NULL, CONSOLE_TEXTMODE_BUFFER, NULL);
+			//Set the window size to the smallest possible
+			sr = { 0, 0, 1, 1 };
+			SetConsoleWindowInfo(console, true, &sr);
+			//Set the buffer size to the wanted size
+			if (!SetConsoleScreenBufferSize(console, _screenSize))
+			{
+				ThrowError(L"SetConsoleScreenBufferSize");
+				return;
+			}
+			//Assign the console object to the actual console (From now on changes to the console object will affect the actual console)
+			if (!SetConsoleActiveScreenBuffer(console))
+			{
+				ThrowError(L"SetConsoleActiveScreenBuffer");
+				return;
+			}
+
+			//Setting the cursor visibility
+			CONSOLE_CURSOR_INFO cci = CONSOLE_CURSOR_INFO();
+			cci.bVisible = false;
+			cci.dwSize = 3;
+			SetConsoleCursorInfo(console, &cci);
+
+			//Setting the character size and font
+			CONSOLE_FONT_INFOEX cfi = CONSOLE_FONT_INFOEX();
+			cfi.cbSize = sizeof(cfi);
+			cfi.dwFontSize.X = fontWidth;
+			cfi.dwFontSize.Y = fontHeight;
+			cfi.FontFamily = FF_DONTCARE;
+			cfi.FontWeight = FW_NORMAL;
+			//Don't know why, but  ' cfi.FaceName = L"Liberation Mono"; '  doesn't work, so instead 'wcscpy_s' has to be used
+			//	this copies the wide character string in the 2nd parameter into the variable in the 1st parameter
+			//wcscpy_s(cfi.FaceName, L"Liberation Mono");
+			if (!SetCurrentConsoleFontEx(console, false, &cfi))
+			{
+				ThrowError(L"SetConsoleActiveScreenBuffer");
+				return;
+			}
+
+			//Check to see if the wanted size is too big for the screen
+			CONSOLE_SCREEN_BUFFER_INFO csbi;
+			if (!GetConsoleScreenBufferInfo(console, &csbi))
+			{
+				ThrowError(L"GetConsoleScreenBufferInfo");
+				return;
+			}
+			if (_screenSize.Y > csbi.dwMaximumWindowSize.Y)
+			{
+				wchar_t msg[128];
+				swprintf(msg, 128, L"Screen Height / Font Height Too Big (%d * %d)", csbi.dwMaximumWindowSize.Y, fontHeight);
+				ThrowError(msg);
+				return;
+			}
+			if (_screenSize.X > csbi.dwMaximumWindowSize.X)
+			{
+				wchar_t msg[128];
+				swprintf(msg, 128, L"Screen Width / Font Width Too Big (%d * %d)", csbi.dwMaximumWindowSize.X, fontWidth);
+				ThrowError(msg);
+				return;
+			}
+
+			//Tries to scale the font up to make the window occupy the most screen space possible
+			if (upscale)
+			{
+				float fontRatio = ((float)fontWidth) / ((float)fontHeight);
+				short tFW = fontWidth;
+				short tFH = fontHeight;
+				short i = 1;
+				while (true)
+				{
+					if ((fontRatio * i) == (trunc(fontRatio * i)))
+					{
+						cfi.dwFontSize.X = fontWidth + (short)(fontRatio * i);
+						cfi.dwFontSize.Y = fontHeight + i;
+						SetCurrentConsoleFontEx(console, false, &cfi);
+						GetConsoleScreenBufferInfo(console, &csbi);
+						if (_screenSize.X > csbi.dwMaximumWindowSize.X || _screenSize.Y > csbi.dwMaximumWindowSize.Y)
+						{
+							break;
+						}
+						tFW = fontWidth + (short)(fontRatio * i);
+						tFH = fontHeight + i;
+					}
+					i++;
+				}
+				cfi.dwFontSize.X = tFW;
+				cfi.dwFontSize.Y = tFH;
+				SetCurrentConsoleFontEx(console, false, &cfi);
+				GetConsoleScreenBufferInfo(console, &csbi);
+			}
+
+			//Set the window size to the wanted screen size
+			sr = { 0, 0, (short)(screenWidth - 1), (short)(screenHeight - 1) };
+			if (!SetConsoleWindowInfo(console, true, &sr))
+			{
+				ThrowError(L"SetConsoleWindowInfo");
+				return;
+			}
+#pragma endregion
+		}
+
+		//Used the same name as a function in 'Windows.h', this is horrible practice
+						/// <summary>
+						/// Moves the command prompt window to a specific point on the screen (This function has the same name as one in 'Windows.h', if by any chance you meant to use that one, use '::SetWindowPos')
+						/// </summary>
+						/// <param name="x">Moves the window so that there are this many pixels between the edge of the screen and the left side of the window (0 pixels seems to actually be -7)</param>
+						/// <param name="y">Moves the window so that there are this many pixels between the edge of the screen and the top side of the window (In order to hide the Windows top bar use -29)</param>
+		void SetWindowPos(short x, short y)
+		{
+			::SetWindowPos(window, NULL, x, y, NULL, NULL, SWP_NOSIZE);
+		}
+						/// <summary>Moves the command prompt window to a specific point on the screen (This function has the same name as one in 'Windows.h', if by any chance you meant to use that one, use '::SetWindowPos')</summary> /// <param name="x">Moves the window so that there are this many pixels between the edge of the screen and the left side of the window (0 pixels seems to actually be -7)</param> /// <param name="y">Moves the window so that there are this many pixels between the edge of the screen and the top side of the window (In order to hide the Windows top bar use -29)</param>
+		void SetWindowPos(VEC2F v) { ::SetWindowPos(window, NULL, (int)v.x, (int)v.y, NULL, NULL, SWP_NOSIZE); }
+
+		//Used the same name as a function in 'Windows.h', this is horrible practice
+						/// <summary>
+						/// Moves the command prompt window by a number of pixels on the screen (This function has the same name as one in 'Windows.h', if by any chance you meant to use that one, use '::MoveWindow')
+						/// </summary>
+						/// <param name="x">Moves the window this many pixels to the right (Negative numbers go to the left)</param>
+						/// <param name="y">Moves the window this many pixels down (Negative numbers go up)</param>
+		void MoveWindow(short x, short y)
+		{
+			WINDOWINFO winInfo = WINDOWINFO();
+			GetWindowInfo(window, &winInfo);
+			::SetWindowPos(window, NULL, winInfo.rcWindow.left + x, winInfo.rcWindow.top + y, NULL, NULL, SWP_NOSIZE);
+		}
+						/// <summary>Moves the command prompt window by a number of pixels on the screen (This function has the same name as one in 'Windows.h', if by any chance you meant to use that one, use '::MoveWindow')</summary> /// <param name="x">Moves the window this many pixels to the right (Negative numbers go to the left)</param> /// <param name="y">Moves the window this many pixels down (Negative numbers go up)</param>
+		void MoveWindow(VEC2F v) { MoveWindow((short)v.x, (short)v.y); }
+
+		void SetTitle(const wchar_t* msg)
+		{
+			swprintf(title, 256, msg);
+		}
+
+		void UpdateTitle()
+		{
+			wchar_t tmp[256];
+			swprintf(tmp, 256, L"%s  |  FPS:%f", title, 1.0f / deltaTime);
+			//More data: swprintf(tmp, 256, L"%s  |  FPS:%f | Max: %f | Avg: %f", title, 1.0f / deltaTime, 1.0f / quickest, 1.0f / (sum / frameAmount));
+			SetConsoleTitle(tmp);
+		}
+
+						/// <summary>0 -> nothing ; 1 -> released ; 2 -> pressed ; 3 -> held ; MOUSE_X and MOUSE_Y -> point on the command prompt</summary>
+		void ReadInputs()
+		{
+			inputs.Age();
+			_inputEvents.clear();
+			if (threadedInput)
+			{
+				DWORD error = inputError.exchange(0);
+				if (error != 0)
+				{
+					SetLastError(error);
+					ThrowError(L"FailedToReadInput");
+					return;
+				}
+				INPUTEVENT e;
+				while (inputRing.Pop(e))
+				{
+					_inputEvents.push_back(e);
+				}
+			}
+			else
+			{
+				//Read in batches instead of 1 call per event
+				INPUT_RECORD records[128];
+				DWORD readCount = 0;
+				std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+				do
+				{
+					if (!inputSource->Read(records, 128, &readCount))
+					{
+						ThrowError(L"FailedToReadInput");
+						return;
+					}
+					for (DWORD c = 0; c < readCount; c++)
+					{
+						_inputEvents.push_back({ now, records[c] });
+					}
+				} while (readCount > 0);
+			}
+			//Taken after draining, so every event this frame is from before it
+			_inputFrameStart = _inputFrameEnd;
+			_inputFrameEnd = std::chrono::steady_clock::now();
+			for (INPUTEVENT& e : _inputEvents)
+			{
+				ApplyInputEvent(e.record);
+			}
+		}
+
+						/// <summary>Sets where input events come from (Ex. a SCRIPTEDINPUT for running without a console; nullptr goes back to the console) (Set before Start(); it has to outlive the engine's use of it)</summary>
+		void SetInputSource(INPUTSOURCE* source) { inputSource = (source ? source : &consoleSource); }
+
+						/// <summary>Updates 'inputs' with a single raw event</summary>
+		void ApplyInputEvent(const INPUT_RECORD& buf)
+		{
+			if (buf.EventType == KEY_EVENT)
+			{
+				inputs.KeyEvent(buf.Event.KeyEvent.uChar.UnicodeChar, buf.Event.KeyEvent.bKeyDown);
+
+				if (buf.Event.KeyEvent.dwControlKeyState > 0)
+				{
+					inputs.Special(LALT) = (inputs[LALT] == 0 && (buf.Event.KeyEvent.dwControlKeyState & LEFT_ALT_PRESSED) == 0 ? 0 : 1);
+					inputs.Special(RALT) = (inputs[RALT] == 0 && (buf.Event.KeyEvent.dwControlKeyState & RIGHT_ALT_PRESSED) == 0 ? 0 : 1);
+					inputs.Special(LCTRL) = (inputs[LCTRL] == 0 && (buf.Event.KeyEvent.dwControlKeyState & LEFT_CTRL_PRESSED) == 0 ? 0 : 1);
+					inputs.Special(RCTRL) = (inputs[RCTRL] == 0 && (buf.Event.KeyEvent.dwControlKeyState & RIGHT_CTRL_PRESSED) == 0 ? 0 : 1);
+					inputs.Special(SHIFT) = (inputs[SHIFT] == 0 && (buf.Event.KeyEvent.dwControlKeyState & SHIFT_PRESSED) == 0 ? 0 : 1);
+				}
+			}
+			else
+			{
+				if (buf.EventType == MOUSE_EVENT)
+				{
+					switch (buf.Event.MouseEvent.dwEventFlags)
+					{
+					case MOUSE_MOVED:
+						inputs.Special(MOUSE_X) = buf.Event.MouseEvent.dwMousePosition.X;
+						inputs.Special(MOUSE_Y) = buf.Event.MouseEvent.dwMousePosition.Y;
+						break;
+					case DOUBLE_CLICK:
+						inputs.Special(MOUSE_DCLICK) = 1;
+						break;
+					case MOUSE_WHEELED:
+						inputs.Special(MOUSE_SCROLL) = (buf.Event.MouseEvent.dwButtonState >> 31 == 0 ? 1 : -1); inputs.Special(MOUSE_SCROLL) = -1;
+						break;
+					case 0: //Means a button was clicked
+						for (int i = 0; i < 8; i++)
+						{
+							inputs.Special(MOUSE_BTN + i) += ((buf.Event.MouseEvent.dwButtonState & (1 << i)) > 0 ? 1 : 1 - inputs[MOUSE_BTN + i]);
+						}
+						break;
+					}
+				}
+			}
+		}
+
+		//Runs on 'inputThread', timestamping events as soon as they come in
+		void InputLoop()
+		{
+			INPUT_RECORD records[128];
+			while (!inputStopping)
+			{
+				//Wakes up at least every few milliseconds to check whether it should stop
+				if (!inputSource->Wait(5))
+				{
+					continue;
+				}
+				DWORD readCount = 0;
+				if (!inputSource->Read(records, 128, &readCount))
+				{
+					//Stops reading; The main thread shuts the engine down when it sees the error
+					inputError = max(GetLastError(), (DWORD)1);
+					return;
+				}
+				std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+				for (DWORD c = 0; c < readCount; c++)
+				{
+					inputRing.Push({ now, records[c] });
+				}
+			}
+		}
+
+						/// <summary>Starts the game loop (Runs AutoTune() if 'autoTune' is on; Clears the frame; Runs Setup(); Runs FixedUpdate() every 'fixedTimeStep' and Update(), 'tasks', SyncFrame() and Render() once per frame while 'running' is true)</summary>
+		void Start()
+		{
+			if (autoTune)
+			{
+				AutoTune();
+			}
+			else
+			{
+				ApplyTuning(tuningOverride);
+			}
+			ClearFrame();
+			ClearHUD();
+			Setup();
+			WriteConsoleOutput(console, screen, { screenSize.X, screenSize.Y }, { 0, 0 }, &sr);
+			//Makes Sleep() precise to ~1ms instead of the default ~15.6ms scheduler tick, so the pacer can sleep through most of the frame
+			timeBeginPeriod(1);
+			_inputFrameEnd = std::chrono::steady_clock::now();
+			if (threadedInput)
+			{
+				inputStopping = false;
+			inputError = 0;
+				inputThread = std::thread(&CMDEngine::InputLoop, this);
+			}
+			pacer.Reset();
+			fixedAccumulator = 0;
+			while (running)
+			{
+				//The arena that gets reused was last used 2 frames ago, and that frame's render was waited on during the last one, so nothing can still be using it
+				int nextArena = 1 - frameArena.load(std::memory_order_relaxed);
+				frameArenas[nextArena].Reset();
+				frameArena.store(nextArena, std::memory_order_release);
+				_deltaTime = pacer.WaitForNextFrame(fpsLimit);
+				//More data: sum += _deltaTime; frameAmount++; quickest = min(quickest, _deltaTime);
+				UpdateTitle();
+				if (autoClearScreen && !pipelineFrames)
+				{
+					ClearFrame();
+				}
+				ReadInputs();
+				if (fixedTimeStep > 0)
+				{
+					//Fixed timestep simulation (The simulation always advances in steps of 'fixedTimeStep', no matter how fast frames are being drawn)
+					fixedAccumulator += deltaTime;
+					int steps = 0;
+					while (fixedAccumulator >= fixedTimeStep && steps < maxFixedSteps)
+					{
+						FixedUpdate();
+						fixedAccumulator -= fixedTimeStep;
+						steps++;
+					}
+					if (fixedAccumulator >= fixedTimeStep)
+					{
+						//Hit the step limit, so the leftover time is dropped instead of carried over into the next frame
+						fixedAccumulator = fmod(fixedAccumulator, fixedTimeStep);
+					}
+					_interpolationAlpha = fixedAccumulator / fixedTimeStep;
+				}
+				Update();
+				//Background work gets its slice of the frame (With 'pipelineFrames' on, this overlaps the previous frame's render)
+				tasks.Run(taskBudget);
+				if (pipelineFrames)
+				{
+					//The previous frame's render has to be done before the next one's data can be handed over to it
+					jobs.Wait(renderJob);
+					tasks.FlushCompleted();
+					SyncFrame();
+					renderJob = jobs.Schedule([this]()
+					{
+						if (autoClearScreen)
+						{
+							ClearFrame();
+						}
+						Render();
+						Present();
+					});
+				}
+				else
+				{
+					tasks.FlushCompleted();
+					SyncFrame();
+					Render();
+					//Draw Frame
+					Present();
+				}
+			}
+			jobs.Wait(renderJob);
+			jobs.Wait(presentJob);
+			if (inputThread.joinable())
+			{
+				inputStopping = true;
+				inputThread.join();
+			}
+			timeEndPeriod(1);
+			CloseHandle(window);
+			CloseHandle(console);
+			CloseHandle(consoleInput);
+		}
+
+		virtual void Setup() = 0;
+
+		virtual void Update() = 0;
+
+						/// <summary>Runs every 'fixedTimeStep' seconds of game time, before Update() (Does nothing unless overridden and 'fixedTimeStep' is above 0)</summary>
+		virtual void FixedUpdate() {}
+
+						/// <summary>Runs after Update() once the previous frame's Render() has finished, so it's safe to hand Update()'s results over to the render stage here</summary>
+		virtual void SyncFrame() {}
+
+						/// <summary>Draws the frame that SyncFrame() handed over, by running 'renderGraph' unless overridden (Runs on another thread alongside the next Update() when 'pipelineFrames' is on; right after Update() otherwise)</summary>
+		virtual void Render() { renderGraph.Execute(jobs); }
+
+						/// <summary>
+						/// Memory for data that's thrown away after the frame, like temporary lists (Use ARENAALLOCATOR for STL containers)
+						/// Everything in it stays valid until the end of the next frame, so Update() can hand it to the render stage, and the render stage can still read the frame before's
+						/// </summary>
+		FRAMEARENA& FrameArena() { return frameArenas[frameArena.load(std::memory_order_acquire)]; }
+
+						/// <summary>
+						/// Opens a Windows Explorer window, allowing the user to choose a file of the designated file type to open. Will return true if a file is chosen.
+						/// </summary>
+						/// <param name="openFile">The variable to which this function will write the output file to if the user picks a file</param>
+						/// <param name="fileType">The file type the user will be asked for</param>
+						/// <param name="fileExtensions">The internal file type info. Must be formatted correctly: L"*.txt;*.jpg;*.png"</param>
+		bool PromptFileSearch(FILE* openFile, const wchar_t* fileType, const wchar_t* fileExtensions)
+		{
+			openFile->fileName.lStructSize = sizeof(OPENFILENAMEW);
+			openFile->fileName.hwndOwner = window;
+			wchar_t temp[128] = { 0 };
+			swprintf(temp, 128, L"%ls (%ls)%c%ls%c%c", fileType, fileExtensions, '\0', fileExtensions, '\0', '\0');
+			openFile->fileName.lpstrFilter = temp;
+			wchar_t flnm[MAX_PATH] = { 0 };
+			flnm[0] = L'\0';
+			openFile->fileName.lpstrFile = flnm;
+			openFile->fileName.nMaxFile = MAX_PATH;
+			openFile->fileName.Flags = OFN_FILEMUSTEXIST;
+			wchar_t temp2[128];
+			swprintf(temp2, 128, L"Open %ls file to import...", fileType);
+			openFile->fileName.lpstrTitle = temp2;
+			if (GetOpenFileNameW(&(openFile->fileName)))
+			{
+				HANDLE fileHandle = CreateFileW(
+					openFile->fileName.lpstrFile,	// Filename
+					GENERIC_READ,					// Desired access
+					0,								// Share mode
+					NULL,							// Security attributes
+					OPEN_EXISTING,					// Opens a file only if it already exist
+					FILE_ATTRIBUTE_NORMAL,			// Flags and attributes
+					NULL);							// Template file handle
+				if (fileHandle != INVALID_HANDLE_VALUE)
+				{
+					openFile->fileHandle = fileHandle;
+
+					wchar_t fullDirectory[MAX_PATH] = { 0 };
+					int length1 = swprintf(fullDirectory, MAX_PATH, L"%ls", openFile->fileName.lpstrFile);
+					int lastSlash = 0;
+					for (int i = 0; i < length1; i++)
+					{
+						if (fullDirectory[i] == L'\\')
+						{
+							lastSlash = i;
+						}
+					}
+					bool extension = false;
+					int index = 0;
+					for (int i = lastSlash + 1; i < length1; i++)
+					{
+						if (!extension)
+						{
+							if (fullDirectory[i] == L'.')
+							{
+								extension = true;
+								index = -1;
+							}
+							else
+							{
+								openFile->name[index] = fullDirectory[i];
+							}
+						}
+						else
+						{
+							openFile->extension[index] = fullDirectory[i];
+						}
+						index++;
+					}
+					return true;
+				}
+			}
+			return false;
+		}
+
+						/// <summary>
+						/// Opens a Windows Explorer window, allowing the user to choose the name and location of the file to save to, with the designated file type. Will return true if a file is chosen.
+						/// </summary>
+						/// <param name="saveFile">The variable to which this function will write the output file to if the user picks a file</param>
+						/// <param name="fileType">The file type the user will be asked for</param>
+						/// <param name="fileExtensions">The internal file type info. Must be formatted correctly: L"*.txt;*.jpg;*.png"</param>
+		bool PromptFileSave(FILE* saveFile, const wchar_t* fileType, const wchar_t* fileExtensions)
+		{
+			saveFile->fileName.lStructSize = sizeof(OPENFILENAMEW);
+			saveFile->fileName.hwndOwner = window;
+			wchar_t temp[128] = { 0 };
+			swprintf(temp, 128, L"%ls (%ls)%c%ls%c%c", fileType, fileExtensions, '\0', fileExtensions, '\0', '\0');
+			saveFile->fileName.lpstrFilter = temp;
+			wchar_t flnm[MAX_PATH] = { 0 };
+			flnm[0] = L'\0';
+			saveFile->fileName.lpstrFile = flnm;
+			saveFile->fileName.nMaxFile = MAX_PATH;
+			saveFile->fileName.lpstrTitle = L"Save as";
+			wchar_t temp2[128] = { 0 };
+			int extensionsLength = swprintf(temp2, 128, L"%ls", fileExtensions);
+			for (int i = 0; i < extensionsLength; i++)
+			{
+				if (fileExtensions[i] == L'.')
+				{
+					i++;
+					for (int  j = 0; j + i < extensionsLength; j++)
+					{
+						if (fileExtensions[j + i] == L';')
+						{
+							temp2[j] = L'\0';
+							break;
+						}
+						temp2[j] = fileExtensions[j + i];
+					}
+					break;
+				}
+			}
+			saveFile->fileName.lpstrDefExt = temp2;
+			if (GetSaveFileNameW(&(saveFile->fileName)))
+			{
+				HANDLE fileHandle = CreateFileW(
+					saveFile->fileName.lpstrFile,	// Filename
+					GENERIC_WRITE,					// Desired access
+					0,								// Share mode
+					NULL,							// Security attributes
+					CREATE_NEW,						// Creates a new file, only if it doesn't already exist
+					FILE_ATTRIBUTE_NORMAL,			// Flags and attributes
+					NULL);							// Template file handle
+				if (fileHandle != INVALID_HANDLE_VALUE)
+				{
+					saveFile->fileHandle = fileHandle;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		bool ScreenPosDrawnTo(short x, short y)
+		{
+			return OnScreen(x, y) && zBuffer[y * screenSize.X + x] != 1;
+		}
+
+		short ScreenPosColor(short x, short y)
+		{
+			if (ScreenPosDrawnTo(x, y))
+			{
+				return screen[y * screenSize.X + x].Attributes;
+			}
+			return 0xFFFF;
+		}
+
+		//General useful functions
+#pragma region MiscFunctions
+						/// <summary>Elevates a number to the power of 2</summary>
+		static double Pow2(double value) { return value * value; }
+						/// <summary>Calculates the dot product of 2 vectors</summary>
+		static float DotProduct(VEC4F v1, VEC4F v2)
+		{
+#ifdef CMDE_SIMD_MATH
+			//Adds the products pairwise within the register instead of pulling each one out
+			__m128 p = _mm_mul_ps(v1.m, v2.m);
+			p = _mm_add_ps(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_cvtss_f32(_mm_add_ss(p, _mm_movehl_ps(p, p)));
+#else
+			return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z + v1.w * v2.w;
+#endif
+		}
+						/// <summary>Calculates 3 dot products at once, of a1 and b1, a2 and b2, and a3 and b3 (Returned in x, y and z)</summary>
+		static VEC4F DotProducts(VEC4F a1, VEC4F b1, VEC4F a2, VEC4F b2, VEC4F a3, VEC4F b3)
+		{
+#ifdef CMDE_SIMD_MATH
+			//Turning the products' rows into columns lets all 3 sums be done together, instead of adding across each register
+			__m128 p1 = _mm_mul_ps(a1.m, b1.m);
+			__m128 p2 = _mm_mul_ps(a2.m, b2.m);
+			__m128 p3 = _mm_mul_ps(a3.m, b3.m);
+			__m128 p4 = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(p1, p2, p3, p4);
+			return VEC4F(_mm_add_ps(_mm_add_ps(p1, p2), _mm_add_ps(p3, p4)));
+#else
+			return { DotProduct(a1, b1), DotProduct(a2, b2), DotProduct(a3, b3), 0 };
+#endif
+		}
+						/// <summary>Calculates the orthagonal vector of a plane defined by 2 vectors (Index = v1; Middle = v2; Thumb = result)</summary>
+		static VEC3F CrossProduct(VEC3F v1, VEC3F v2)
+		{
+#ifdef CMDE_SIMD_MATH
+			//(v1 * v2.yzx - v1.yzx * v2) comes out as (z, x, y), so 1 more shuffle puts it in order
+			__m128 a = _mm_shuffle_ps(v1.m, v1.m, _MM_SHUFFLE(3, 0, 2, 1));
+			__m128 b = _mm_shuffle_ps(v2.m, v2.m, _MM_SHUFFLE(3, 0, 2, 1));
+			__m128 c = _mm_sub_ps(_mm_mul_ps(v1.m, b), _mm_mul_ps(a, v2.m));
+			return VEC3F(_mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1)));
+#else
+			return { v1.y * v2.z - v1.z * v2.y, v1.z * v2.x - v1.x * v2.z, v1.x * v2.y - v1.y * v2.x };
+#endif
+		}
+						/// <summary>Calculates the length of a vector</summary>
+		static float Magnitude(VEC4F v)
+		{
+#ifdef CMDE_SIMD_MATH
+			return _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(DotProduct(v, v))));
+#else
+			return (float)sqrt((DotProduct(v, v)));
+#endif
+		}
+						/// <summary>Limits 'value' to the range between 'low' and 'high'</summary>
+		static float Clamp(float value, float low, float high) { return (value < low ? low : (high < value ? high : value)); }
+						/// <summary>Gives the sign of a value (Positive = 1; Negative = -1; Other = itself)</summary>
+		static int Sign(int value) { return (value > 0 ? 1 : (value < 0 ? -1 : value)); }
+						/// <summary>Gives the sign of a value (Positive = 1; Negative = -1; Other = itself)</summary>
+		static double Sign(double value) { return (value > 0.0 ? 1.0 : (value < 0.0 ? -1.0 : value)); }
+						/// <summary>Calculates the angle between 2 vectors in degrees</summary>
+		static float Angle(VEC4F v1, VEC4F v2) { return (float)acos(Clamp(DotProduct(v1, v2) / (Magnitude(v2) * Magnitude(v1)), -1.0f, 1.0f)) * DEG; }
+						/// <summary>Gives a vector of length 1 in the same direction</summary>
+		static VEC4F Normalize(VEC4F v) { return v / Magnitude(v); }
+						/// <summary>Approximates 1 / sqrt(value) (Relative error under 0.0005%; Faster than dividing by sqrt())</summary>
+		static float RsqrtFast(float value)
+		{
+#ifdef CMDE_SIMD_MATH
+			//rsqrtss is only good to 12 bits, 1 Newton-Raphson step brings it close to full float precision
+			__m128 v = _mm_set_ss(value);
+			__m128 r = _mm_rsqrt_ss(v);
+			r = _mm_mul_ss(r, _mm_sub_ss(_mm_set_ss(1.5f), _mm_mul_ss(_mm_mul_ss(_mm_set_ss(0.5f), v), _mm_mul_ss(r, r))));
+			return _mm_cvtss_f32(r);
+#else
+			return 1.0f / sqrtf(value);
+#endif
+		}
+						/// <summary>Gives a vector of length 1 in the same direction, using RsqrtFast() (For when tiny errors in the length don't matter)</summary>
+		static VEC4F NormalizeFast(VEC4F v) { return v * RsqrtFast(DotProduct(v, v)); }
+						/// <summary>Calculates the square root of every component</summary>
+		static VEC4F SquareRoots(VEC4F v)
+		{
+#ifdef CMDE_SIMD_MATH
+			return VEC4F(_mm_sqrt_ps(v.m));
+#else
+			return { sqrtf(v.x), sqrtf(v.y), sqrtf(v.z), sqrtf(v.w) };
+#endif
+		}
+						/// <summary>Calculates 1 / x for every component (Components that are 0 give infinity)</summary>
+		static VEC4F Reciprocal(VEC4F v)
+		{
+#ifdef CMDE_SIMD_MATH
+			return VEC4F(_mm_div_ps(_mm_set1_ps(1.0f), v.m));
+#else
+			return { 1.0f / v.x, 1.0f / v.y, 1.0f / v.z, 1.0f / v.w };
+#endif
+		}
+						/// <summary>Approximates 1 / x for every component (Relative error under 0.0005%; Components that are 0 give NaN, so use Reciprocal() for those)</summary>
+		static VEC4F ReciprocalFast(VEC4F v)
+		{
+#ifdef CMDE_SIMD_MATH
+			//rcpps is only good to 12 bits, 1 Newton-Raphson step brings it close to full float precision
+			__m128 r = _mm_rcp_ps(v.m);
+			r = _mm_sub_ps(_mm_add_ps(r, r), _mm_mul_ps(v.m, _mm_mul_ps(r, r)));
+			return VEC4F(r);
+#else
+			return Reciprocal(v);
+#endif
+		}
+						/// <summary>Approximates atan2(y, x) in radians for every component (Error under 0.00001 radians; atan2(0, 0) gives 0)</summary>
+		static VEC4F Atan2Fast(VEC4F y, VEC4F x)
+		{
+			//atan() of the smaller side over the bigger one is always in [0; 1], where an odd polynomial is close enough, and then the octant gets put back
+			const float C1 = 0.99997726f, C3 = -0.33262347f, C5 = 0.19354346f, C7 = -0.11643287f, C9 = 0.05265332f, C11 = -0.01172120f;
+#ifdef CMDE_SIMD_MATH
+			__m128 signBit = _mm_set1_ps(-0.0f);
+			__m128 ax = _mm_andnot_ps(signBit, x.m);
+			__m128 ay = _mm_andnot_ps(signBit, y.m);
+			__m128 steep = _mm_cmpgt_ps(ay, ax);
+			__m128 big = _mm_max_ps(ax, ay);
+			//Masked so that 0 / 0 comes out as 0 instead of NaN
+			__m128 a = _mm_and_ps(_mm_div_ps(_mm_min_ps(ax, ay), big), _mm_cmpgt_ps(big, _mm_setzero_ps()));
+			__m128 s = _mm_mul_ps(a, a);
+			__m128 r = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(C11), s), _mm_set1_ps(C9));
+			r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(C7));
+			r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(C5));
+			r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(C3));
+			r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(C1));
+			r = _mm_mul_ps(r, a);
+			__m128 flipped = _mm_sub_ps(_mm_set1_ps((float)(PI * 0.5)), r);
+			r = _mm_or_ps(_mm_and_ps(steep, flipped), _mm_andnot_ps(steep, r));
+			__m128 behind = _mm_cmplt_ps(x.m, _mm_setzero_ps());
+			flipped = _mm_sub_ps(_mm_set1_ps((float)PI), r);
+			r = _mm_or_ps(_mm_and_ps(behind, flipped), _mm_andnot_ps(behind, r));
+			return VEC4F(_mm_xor_ps(r, _mm_and_ps(signBit, y.m)));
+#else
+			float in[2][4] = { { y.x, y.y, y.z, y.w }, { x.x, x.y, x.z, x.w } };
+			float out[4];
+			for (int i = 0; i < 4; i++)
+			{
+				float ax = fabsf(in[1][i]);
+				float ay = fabsf(in[0][i]);
+				float big = max(ax, ay);
+				float a = (big > 0 ? min(ax, ay) / big : 0);
+				float s = a * a;
+				float r = (((((C11 * s + C9) * s + C7) * s + C5) * s + C3) * s + C1) * a;
+				r = (ay > ax ? (float)(PI * 0.5) - r : r);
+				r = (in[1][i] < 0 ? (float)PI - r : r);
+				//Takes the sign bit, so -0 gives -r like the SIMD version
+				out[i] = copysignf(r, in[0][i]);
+			}
+			return { out[0], out[1], out[2], out[3] };
+#endif
+		}
+						/// <summary>Sorts 'items' (Indices into 'keys') from the smallest key to the biggest, keeping items with the same key in the order they were in ('scratch' must have room for 'count' items)</summary>
+		static void RadixSort(unsigned int* items, size_t count, const unsigned short* keys, unsigned int* scratch)
+		{
+			//1 pass per byte, lowest first, and each pass is stable, so the 2nd one keeps the 1st one's order between keys with the same high byte
+			unsigned int* from = items;
+			unsigned int* to = scratch;
+			for (int shift = 0; shift < 16; shift += 8)
+			{
+				size_t offsets[256] = {};
+				for (size_t i = 0; i < count; i++)
+				{
+					offsets[(keys[from[i]] >> shift) & 0xFF]++;
+				}
+				size_t total = 0;
+				for (size_t& offset : offsets)
+				{
+					size_t bucket = offset;
+					offset = total;
+					total += bucket;
+				}
+				for (size_t i = 0; i < count; i++)
+				{
+					to[offsets[(keys[from[i]] >> shift) & 0xFF]++] = from[i];
+				}
+				std::swap(from, to);
+			}
+		}
+
+#pragma region LinearFunction
+						/// <summary>Calculates the y value of point x on the line defined by the 2 points provided (Returns y1 if x1 == x2)</summary>
+		static float LinearFunction(float x1, float y1, float x2, float y2, float x)
+		{
+			if (y1 == y2 || x1 == x2)
+				return y1;
+			return y1 + ((y2 - y1) / (x2 - x1) * (x - x1));
+		}
+						/// <summary>Calculates the point at 'x' on the line defined by the 2 points provided (Returns p1 if p1.x == p2.x)</summary>
+		static VEC4F LinearFunction(VEC4F p1, VEC4F p2, float x)
+		{
+			if (p1.x == p2.x)
+				return p1;
+			return { x, LinearFunction(p1.x, p1.y, p2.x, p2.y, x), LinearFunction(p1.x, p1.z, p2.x, p2.z, x), LinearFunction(p1.x, p1.w, p2.x, p2.w, x) };
+		}
+		//Warn if both points have the same X and thus can't be made into a linear function
+						/// <summary>Calculates the y value of point x on the line defined by the 2 points provided and inserts it into 'output' (Returns false if x1 == x2)</summary>
+		static bool LinearFunction(float x1, float y1, float x2, float y2, float x, float* output) { if (x1 == x2) { return false; } *output = LinearFunction(x1, y1, x2, y2, x); return true; }
+						/// <summary>Calculates the point at 'x' on the line defined by the 2 points provided and inserts it into 'output' (Returns false if p1.x == p2.x)</summary>
+		static bool LinearFunction(VEC4F p1, VEC4F p2, float x, VEC4F* output) { if (p1.x == p2.x) { return false; } *output = LinearFunction(p1, p2, x); return true; }
+						/// <summary>Generates the linear function based on 'x' defined by the 2 points provided (Returns y=0 if x1 == x2)</summary>
+		static LINEAR LinearFunction(float x1, float y1, float x2, float y2)
+		{
+			if (x1 == x2)
+				return LINEAR();
+			return { VEC4F(0, (y2 - y1) / (x2 - x1), 0, 0), VEC4F(0, -(y2 - y1) / (x2 - x1) * x1 + y1, 0, 0) };
+		}
+						/// <summary>Generates the linear function based on 'x' defined by the 2 points provided (Returns y=z=w=0 if p1.x == p2.x)</summary>
+		static LINEAR LinearFunction(VEC4F p1, VEC4F p2)
+		{
+			if (p1.x == p2.x)
+				return LINEAR();
+			float t = 1.0f / (p2.x - p1.x);
+			return { VEC4F(1, (p2.y - p1.y) * t, (p2.z - p1.z) * t, (p2.w - p1.w) * t), VEC4F(0, -(p2.y - p1.y) * t * p1.x + p1.y, -(p2.z - p1.z) * t * p1.x + p1.z, -(p2.w - p1.w) * t * p1.x + p1.w) };
+		}
+		//Warn if both points have the same X and thus can't be made into a linear function
+						/// <summary>Generates the linear function based on 'x' defined by the 2 points provided and inserts it into 'output' (Returns false if x1 == x2)</summary>
+		static bool LinearFunction(float x1, float y1, float x2, float y2, LINEAR* output) { if (x1 == x2) { return false; } *output = LinearFunction(x1, y1, x2, y2); return true; }
+						/// <summary>Generates the linear function based on 'x' defined by the 2 points provided and inserts it into 'output' (Returns false if p1.x == p2.x)</summary>
+		static bool LinearFunction(VEC4F p1, VEC4F p2, LINEAR* output) { if (p1.x == p2.x) { return false; } *output = LinearFunction(p1, p2); return true; }
+#pragma endregion
+
+						/// <summary>Calculates the point at 'x' on the line defined by the 3 points provided and inserts it into 'output' (Returns false if there is any repeat value in p1.x, p2.x, and p3.x)</summary>
+		static bool QuadraticFunction(VEC2F p1, VEC2F p2, VEC2F p3, float x, VEC2F* output)
+		{
+			if (p1.x == p2.x || p1.x == p3.x || p2.x == p3.x)
+			{
+				return false;
+			}
+			float d = (p1.x * (p3.x * p3.x - p2.x * p2.x) + (p3.x * p2.x + p1.x * p1.x) * (p2.x - p3.x));
+			if (d == 0)
+			{
+				return false;
+			}
+			float a = (-p1.y * (p3.x - p2.x) - p2.y * (p1.x - p3.x) + p3.y * (p1.x + p2.x)) / d;
+			float b = (p2.y - p3.y + a * p3.x * p3.x - a * p2.x * p2.x) / (p2.x - p3.x);
+			float c = p3.y - b * p3.x - a * p3.x * p3.x;
+			*output = { x, a * x * x + b * x + c };
+			return true;
+		}
+						/// <summary>Generates the quadratic function based on 'x' defined by the 3 points provided and inserts it into 'output' (Returns false if there is any repeat value in p1.x, p2.x, and p3.x)</summary>
+		static bool QuadraticFunction(VEC4F p1, VEC4F p2, VEC4F p3, QUADRATIC* output)
+		{
+			if (p1.x == p2.x || p1.x == p3.x || p2.x == p3.x)
+			{
+				return false;
+			}
+			float d = (p1.x * (p3.x * p3.x - p2.x * p2.x) + (p3.x * p2.x + p1.x * p1.x) * (p2.x - p3.x));
+			if (d == 0)
+			{
+				return false;
+			}
+			VEC4F a = { 0, (-p1.y * (p3.x - p2.x) - p2.y * (p1.x - p3.x) + p3.y * (p1.x + p2.x)) / d, (-p1.z * (p3.x - p2.x) - p2.z * (p1.x - p3.x) + p3.z * (p1.x + p2.x)) / d, (-p1.w * (p3.x - p2.x) - p2.w * (p1.x - p3.x) + p3.w * (p1.x + p2.x)) / d };
+			VEC4F b = { 1, (p2.y - p3.y + a.y * p3.x * p3.x - a.y * p2.x * p2.x) / (p2.x - p3.x), (p2.z - p3.z + a.z * p3.x * p3.x - a.z * p2.x * p2.x) / (p2.x - p3.x), (p2.w - p3.w + a.w * p3.x * p3.x - a.w * p2.x * p2.x) / (p2.x - p3.x) };
+			VEC4F c = { 0, p3.y - b.y * p3.x - a.y * p3.x * p3.x, p3.z - b.z * p3.x - a.z * p3.x * p3.x, p3.w - b.w * p3.x - a.w * p3.x * p3.x };
+			*output = { a, b, c };
+			return true;
+		}
+
+						/// <summary>Assumes the XYZ axis are set up correctly (X+ is left when Z+ is forwards and Y+ is up)</summary>
+		static VEC3F VectorFromAngles(float h, float v)
+		{
+			return { (float)(sin(h * RAD) * cos(v * RAD)), (float)sin(v * RAD), (float)(cos(h * RAD) * cos(v * RAD)) };
+		}
+#pragma endregion
+	};
+}
+
+class RotateShape : public cmde::CMDEngine
+{
+public:
+	int angle;
+	int edges;
+	float radius;
+	cmde::VEC2F c;
+	float r;
+	wchar_t msg[128];
+	float t;
+
+	RotateShape(short screenWidth, short screenHeight, short fontWidth, short fontHeight) : cmde::CMDEngine(screenWidth, screenHeight, fontWidth, fontHeight, false, true, FPS60)
+	{
+		swprintf(msg, 128, L"");
+		radius = 38;
+		angle = 360;
+		edges = 3;
+		c = { 0.5f, 0.5f };
+		r = 0.49f;
+		t = 0;
+	}
+
+	void Setup()
+	{
+		SetTitle(L"Sketchy Program");
+		c = ScreenPosToPoint(c.x, c.y);
+		r = ScreenPosToPoint(0, r).y;
+		SetWindowPos(600, 40);
+	}
+
+	void Update()
+	{
+		DrawRPoly(c, edges, r, (float)angle);
+		angle++;
+
+		if (angle % 60 == 0)
+		{
+			edges++;
+		}
+
+		MoveWindow((short)cos(angle * 9 * RAD) * 18, (short)sin(angle * 0.8f * RAD) * 10);
+	}
+};
+
+#include <vector>
+#include <thread>
+#include <unordered_map>
+#include <queue>
+#include <algorithm>
+#include <cstring>
+
+class Test3D : public cmde::CMDEngine
+{
+	struct PLANE
+	{
+		cmde::VEC3F point;
+		cmde::VEC3F normal;
+
+		PLANE() { point = normal = cmde::VEC3F(); }
+		PLANE(cmde::VEC3F p, cmde::VEC3F n) { point = p; normal = Normalize(n); }
+	};
+
+	struct Triangle
+	{
+		cmde::VEC3F vertices[3];
+		cmde::VEC3F normal;
+		short color;
+		//Used for wireframe rendering, so that only the actual triangles' lines get drawn and not the clipped triangles' lines
+		bool visibleSides[3];
+
+		Triangle(cmde::VEC3F p1, cmde::VEC3F p2, cmde::VEC3F p3, short col = 0x00FF)
+		{
+			vertices[0] = p1;
+			vertices[1] = p2;
+			vertices[2] = p3;
+			visibleSides[0] = true;
+			visibleSides[1] = true;
+			visibleSides[2] = true;
+			color = col;
+			//normal = Normalize(CrossProduct(vertices[0] - vertices[1], vertices[2] - vertices[1]));
+			normal = NormalizeFast(CrossProduct(vertices[1] - vertices[0], vertices[2] - vertices[0]));
+		}
+
+		Triangle(cmde::VEC3F p1, cmde::VEC3F p2, cmde::VEC3F p3, short col, bool s1, bool s2, bool s3)
+		{
+			vertices[0] = p1;
+			vertices[1] = p2;
+			vertices[2] = p3;
+			visibleSides[0] = s1;
+			visibleSides[1] = s2;
+			visibleSides[2] = s3;
+			color = col;
+			//normal = Normalize(CrossProduct(vertices[0] - vertices[1], vertices[2] - vertices[1]));
+			normal = NormalizeFast(CrossProduct(vertices[1] - vertices[0], vertices[2] - vertices[0]));
+		}
+
+		//For when the normal is already known (Like from a mesh, or when cutting up a triangle that's staying in the same plane)
+		Triangle(cmde::VEC3F p1, cmde::VEC3F p2, cmde::VEC3F p3, cmde::VEC3F n, short col, bool s1, bool s2, bool s3)
+		{
+			vertices[0] = p1;
+			vertices[1] = p2;
+			vertices[2] = p3;
+			visibleSides[0] = s1;
+			visibleSides[1] = s2;
+			visibleSides[2] = s3;
+			color = col;
+			normal = n;
+		}
+
+		Triangle GetWithOffset(cmde::VEC3F offset)
+		{
+			return Triangle(vertices[0] + offset, vertices[1] + offset, vertices[2] + offset, normal, color, visibleSides[0], visibleSides[1], visibleSides[2]);
+		}
+	};
+
+	//How many triangles the async mesh functions get through between checks of the task budget
+	static const size_t ASYNC_STRIDE = 1024;
+	//Mesh::GenerateLodsAsync() halves the face count per level, until there's 'LOD_MAX_LEVELS' levels or the next one would have less than 'LOD_MIN_FACES'
+	static const size_t LOD_MAX_LEVELS = 6;
+	static const size_t LOD_MIN_FACES = 64;
+	//How many faces an object should have per screen cell it covers (About half of them face away from the camera)
+	static constexpr float LOD_FACES_PER_CELL = 2.0f;
+	//How far past a level's range the wanted face count has to go before an object changes level (So that objects sitting right at a threshold don't flicker between 2 levels)
+	static constexpr float LOD_HYSTERESIS = 1.25f;
+
+	//Meshlets get up to 'MESHLET_SIZE' faces, and stop growing early once the next face would be more than 60 degrees off of the ones already in it
+	static const size_t MESHLET_SIZE = 64;
+	static constexpr float MESHLET_MIN_ALIGNMENT = 0.5f;
+
+	struct MeshSimplifier;
+
+	//A patch of neighbouring faces that point roughly the same way, so that the clipper can skip whole patches that are off-screen or facing away
+	struct Meshlet
+	{
+		//The range of Mesh::meshletFaces holding its faces
+		unsigned int first;
+		unsigned int count;
+		//Bounding sphere, in the mesh's space
+		cmde::VEC3F center;
+		float radius;
+		//Every face's normal is within the cone around 'axis' whose half-angle has a sine of 'coneSine' (Above 1 if the faces point too many ways for the cone to rule anything out)
+		cmde::VEC3F axis;
+		float coneSine;
+	};
+
+	//Where an object ends up in the world, worked out from its own position, rotation and scale and those of its parents (See Build())
+	//	The scale is the same along every axis, so spheres stay spheres, angles stay the same and normals only need turning
+	struct WorldTransform
+	{
+		//Takes the mesh's space to the world, and back
+		cmde::MAT4 matrix;
+		cmde::MAT4 inverse;
+		float scale = 1;
+		//Whether the matrix only moves things (No rotation and a scale of 1), so that the mesh's positions can just be offset, and objects drawing the same mesh can share its projection
+		bool translationOnly = true;
+		//The mesh's bounding sphere (Around Position()) and a box around its bounding box, in the world
+		float radius = 0;
+		cmde::VEC3F aabb[2];
+
+		cmde::VEC3F Position() const { return matrix.columns[3]; }
+		cmde::VEC3F ToWorld(cmde::VEC3F point) const { return matrix * point + matrix.columns[3]; }
+		cmde::VEC3F ToLocal(cmde::VEC3F point) const { return inverse * point + inverse.columns[3]; }
+		//A VEC3F's w is 0, so directions skip the move
+		cmde::VEC3F DirectionToLocal(cmde::VEC3F direction) const { return inverse * direction; }
+		cmde::VEC3F NormalToWorld(cmde::VEC3F normal) const { return matrix * normal * (1 / scale); }
+
+		//Builds the transform for something at 'position', turned by 'rotation' (Degrees around x, y and z, turned around z first and y last) and scaled by 'scale', relative to 'parent' (Null for the world)
+		//	'box' and 'radius' are the bounds of the mesh it places, in the mesh's own space
+		static WorldTransform Build(cmde::VEC3F position, cmde::VEC3F rotation, float scale, const WorldTransform* parent, const cmde::VEC3F box[2], float radius)
+		{
+			WorldTransform world;
+			//Rotation matrix for z, then x, then y, with the scale folded into its columns
+			float sx = sinf(rotation.x * RAD), cx = cosf(rotation.x * RAD);
+			float sy = sinf(rotation.y * RAD), cy = cosf(rotation.y * RAD);
+			float sz = sinf(rotation.z * RAD), cz = cosf(rotation.z * RAD);
+			cmde::VEC3F axes[3] = {
+				{ cy * cz + sy * sx * sz, cx * sz, -sy * cz + cy * sx * sz },
+				{ -cy * sz + sy * sx * cz, cx * cz, sy * sz + cy * sx * cz },
+				{ sy * cx, -sx, cy * cx }
+			};
+			cmde::MAT4 local(axes[0] * scale, axes[1] * scale, axes[2] * scale, position + cmde::VEC4F(0, 0, 0, 1));
+			//The rotation's inverse is its transpose, so the inverse's rows are the axes, divided by the scale
+			float divideScale = 1 / scale;
+			cmde::MAT4 localInverse = cmde::MAT4::FromRows(
+				cmde::VEC3F(axes[0] * divideScale) + cmde::VEC4F(0, 0, 0, -DotProduct(axes[0], position) * divideScale),
+				cmde::VEC3F(axes[1] * divideScale) + cmde::VEC4F(0, 0, 0, -DotProduct(axes[1], position) * divideScale),
+				cmde::VEC3F(axes[2] * divideScale) + cmde::VEC4F(0, 0, 0, -DotProduct(axes[2], position) * divideScale),
+				{ 0, 0, 0, 1 });
+			bool still = rotation.x == 0 && rotation.y == 0 && rotation.z == 0 && scale == 1;
+			if (parent)
+			{
+				world.matrix = parent->matrix * local;
+				world.inverse = localInverse * parent->inverse;
+				world.scale = parent->scale * scale;
+				world.translationOnly = parent->translationOnly && still;
+			}
+			else
+			{
+				world.matrix = local;
+				world.inverse = localInverse;
+				world.scale = scale;
+				world.translationOnly = still;
+			}
+			if (world.translationOnly)
+			{
+				//Kept exact, so that objects that only move cull and clip the same as they always have
+				world.matrix = cmde::MAT4();
+				world.matrix.columns[3] = (parent ? parent->Position() + position : position) + cmde::VEC4F(0, 0, 0, 1);
+				world.inverse = cmde::MAT4();
+				world.inverse.columns[3] = world.Position() * -1 + cmde::VEC4F(0, 0, 0, 1);
+			}
+			world.radius = radius * world.scale;
+			cmde::VEC3F center = world.ToWorld((box[0] + box[1]) * 0.5f);
+			cmde::VEC3F half = (box[1] - box[0]) * 0.5f;
+			//How far the turned box reaches along each world axis is the sum of its sides' reaches
+			cmde::VEC3F reach;
+			for (int c = 0; c < 3; c++)
+			{
+				const cmde::VEC4F& column = world.matrix.columns[c];
+				float side = (c == 0 ? half.x : (c == 1 ? half.y : half.z));
+				reach = reach + cmde::VEC3F(fabsf(column.x), fabsf(column.y), fabsf(column.z)) * side;
+			}
+			world.aabb[0] = (world.translationOnly ? box[0] + world.Position() : center - reach);
+			world.aabb[1] = (world.translationOnly ? box[1] + world.Position() : center + reach);
+			return world;
+		}
+	};
+
+	//Indexed, so every corner shared by several faces is only stored once, and the per-face data is kept in 1 array each
+	//	(Passes that only need the colors or the normals don't have to drag everything else through the cache)
+	//The clipper and the rasterizer still work with Triangle, which GetTriangle() builds out of a face
+	struct Mesh
+	{
+		std::vector<cmde::VEC3F> positions;
+		//3 per face, pointing into 'positions'
+		std::vector<unsigned int> indices;
+		//Per face
+		std::vector<cmde::VEC3F> normals;
+		std::vector<short> colors;
+		//Bit 'i' is Triangle::visibleSides[i]
+		std::vector<unsigned char> edges;
+		float radius;
+		//Simpler versions of the mesh, each with about half the faces of the one before (Empty unless GenerateLodsAsync() has been run)
+		std::vector<Mesh> lods;
+		//Only used by the meshes in 'lods', the face of the full mesh that each face was simplified down from (So that painting the full mesh can reach them)
+		std::vector<unsigned int> sourceFaces;
+		//Every face exactly once, grouped by meshlet (The faces themselves keep their order, so face indices stay the same)
+		std::vector<Meshlet> meshlets;
+		std::vector<unsigned int> meshletFaces;
+
+		//Only exact matches get merged, which is what comes out of files that list each position once (Like OBJ)
+		struct PositionHash
+		{
+			size_t operator()(const cmde::VEC3F& v) const
+			{
+				std::hash<float> h;
+				return h(v.x) ^ (h(v.y) * 31) ^ (h(v.z) * 961);
+			}
+		};
+		typedef std::unordered_map<cmde::VEC3F, unsigned int, PositionHash> POSITIONLOOKUP;
+
+		Mesh(std::vector<Triangle>& triangles = *new std::vector<Triangle>())
+		{
+			POSITIONLOOKUP lookup;
+			Reserve(triangles.size());
+			for (Triangle& t : triangles)
+			{
+				AddTriangle(t, lookup);
+			}
+			CalculateRadius();
+			BuildMeshlets();
+		}
+
+						/// <summary>Coroutine version of the constructor for big meshes, checking the task budget every 'ASYNC_STRIDE' triangles (Both 'source' and this mesh must outlive the task)</summary>
+		cmde::TASK BuildAsync(std::vector<Triangle>& source)
+		{
+			positions.clear();
+			indices.clear();
+			normals.clear();
+			colors.clear();
+			edges.clear();
+			POSITIONLOOKUP lookup;
+			Reserve(source.size());
+			for (size_t i = 0; i < source.size(); i++)
+			{
+				AddTriangle(source[i], lookup);
+				if (i % ASYNC_STRIDE == ASYNC_STRIDE - 1)
+				{
+					co_await cmde::TASKSCHEDULER::Checkpoint();
+				}
+			}
+			CalculateRadius();
+			co_await cmde::TASKSCHEDULER::Checkpoint();
+			BuildMeshlets();
+		}
+
+		size_t FaceCount() const { return colors.size(); }
+
+						/// <summary>How many levels of detail there are, counting the full mesh as level 0</summary>
+		size_t LodCount() const { return lods.size() + 1; }
+
+						/// <summary>The mesh for level of detail 'level' (Past the last level just gives the last level)</summary>
+		const Mesh& Lod(size_t level) const { return (level == 0 || lods.empty() ? *this : lods[min(level, lods.size()) - 1]); }
+
+						/// <summary>Picks the level of detail to draw the mesh with when it covers 'cells' screen cells, the coarsest level with at least 'LOD_FACES_PER_CELL' faces per cell (Only moving off of 'current', the level it was last drawn with, once the wanted face count is 'LOD_HYSTERESIS' times past its range)</summary>
+		size_t PickLod(size_t current, float cells) const
+		{
+			float wanted = cells * LOD_FACES_PER_CELL;
+			size_t last = LodCount() - 1;
+			size_t level = min(current, last);
+			if (Lod(level).FaceCount() * LOD_HYSTERESIS < wanted)
+			{
+				//Too coarse, so step up to the 1st level that's detailed enough
+				while (level > 0 && Lod(level).FaceCount() < wanted)
+				{
+					level--;
+				}
+			}
+			else
+			{
+				//Step down while the next level still has plenty
+				while (level < last && Lod(level + 1).FaceCount() >= wanted * LOD_HYSTERESIS)
+				{
+					level++;
+				}
 			}
+			return level;
+		}
 
-			//Tries to scale the font up to make the window occupy the most screen space possible
-			if (upscale)
+						/// <summary>Builds the chain of simpler meshes in 'lods' with MeshSimplifier, each one out of the one before, checking the task budget every 'ASYNC_STRIDE' collapses (The mesh must outlive the task)</summary>
+		cmde::TASK GenerateLodsAsync()
+		{
+			lods.clear();
+			//Reserved up front, since each level is built from a reference to the one before it
+			lods.reserve(LOD_MAX_LEVELS);
+			while (lods.size() < LOD_MAX_LEVELS && Lod(lods.size()).FaceCount() >= LOD_MIN_FACES * 2)
 			{
-				float fontRatio = ((float)fontWidth) / ((float)fontHeight);
-				short tFW = fontWidth;
-				short tFH = fontHeight;
-				short i = 1;
-				while (true)
+				const Mesh& previous = Lod(lods.size());
+				MeshSimplifier simplifier(previous);
+				co_await cmde::TASKSCHEDULER::Checkpoint();
+				size_t collapses = 0;
+				while (simplifier.FaceCount() > previous.FaceCount() / 2 && simplifier.Collapse())
 				{
-					if ((fontRatio * i) == (trunc(fontRatio * i)))
+					if (++collapses % ASYNC_STRIDE == 0)
 					{
-						cfi.dwFontSize.X = fontWidth + (short)(fontRatio * i);
-						cfi.dwFontSize.Y = fontHeight + i;
-						SetCurrentConsoleFontEx(console, false, &cfi);
-						GetConsoleScreenBufferInfo(console, &csbi);
-						if (_screenSize.X > csbi.dwMaximumWindowSize.X || _screenSize.Y > csbi.dwMaximumWindowSize.Y)
-						{
-							break;
-						}
-						tFW = fontWidth + (short)(fontRatio * i);
-						tFH = fontHeight + i;
+						co_await cmde::TASKSCHEDULER::Checkpoint();
 					}
-					i++;
 				}
-				cfi.dwFontSize.X = tFW;
-				cfi.dwFontSize.Y = tFH;
-				SetCurrentConsoleFontEx(console, false, &cfi);
-				GetConsoleScreenBufferInfo(console, &csbi);
+				//Stop once the simplifier runs out of collapses it's willing to make
+				if (simplifier.FaceCount() * 10 > previous.FaceCount() * 9)
+					break;
+				lods.push_back(simplifier.Build(previous));
 			}
+		}
 
-			//Set the window size to the wanted screen size
-			sr = { 0, 0, (short)(screenWidth - 1), (short)(screenHeight - 1) };
-			if (!SetConsoleWindowInfo(console, true, &sr))
-			{
-				ThrowError(L"SetConsoleWindowInfo");
-				return;
-			}
-#pragma endregion
+						/// <summary>Builds the triangle for face 'face', moved by 'offset'</summary>
+		Triangle GetTriangle(size_t face, cmde::VEC3F offset = cmde::VEC3F()) const
+		{
+			const unsigned int* i = &indices[face * 3];
+			return Triangle(positions[i[0]] + offset, positions[i[1]] + offset, positions[i[2]] + offset, normals[face], colors[face], (edges[face] & 1) != 0, (edges[face] & 2) != 0, (edges[face] & 4) != 0);
+		}
+						/// <summary>Builds the triangle for face 'face', placed in the world by 'world'</summary>
+		Triangle GetTriangle(size_t face, const WorldTransform& world) const
+		{
+			const unsigned int* i = &indices[face * 3];
+			return Triangle(world.ToWorld(positions[i[0]]), world.ToWorld(positions[i[1]]), world.ToWorld(positions[i[2]]), world.NormalToWorld(normals[face]), colors[face], (edges[face] & 1) != 0, (edges[face] & 2) != 0, (edges[face] & 4) != 0);
 		}
 
-		//Used the same name as a function in 'Windows.h', this is horrible practice
-						/// <summary>
-						/// Moves the command prompt window to a specific point on the screen (This function has the same name as one in 'Windows.h', if by any chance you meant to use that one, use '::SetWindowPos')
-						/// </summary>
-						/// <param name="x">Moves the window so that there are this many pixels between the edge of the screen and the left side of the window (0 pixels seems to actually be -7)</param>
-						/// <param name="y">Moves the window so that there are this many pixels between the edge of the screen and the top side of the window (In order to hide the Windows top bar use -29)</param>
-		void SetWindowPos(short x, short y)
+						/// <summary>Builds every face back into a list of triangles (For code that still wants the old layout)</summary>
+		std::vector<Triangle> Triangles() const
 		{
-			::SetWindowPos(window, NULL, x, y, NULL, NULL, SWP_NOSIZE);
+			std::vector<Triangle> output;
+			output.reserve(FaceCount());
+			for (size_t f = 0; f < FaceCount(); f++)
+			{
+				output.push_back(GetTriangle(f));
+			}
+			return output;
 		}
-						/// <summary>Moves the command prompt window to a specific point on the screen (This function has the same name as one in 'Windows.h', if by any chance you meant to use that one, use '::SetWindowPos')</summary> /// <param name="x">Moves the window so that there are this many pixels between the edge of the screen and the left side of the window (0 pixels seems to actually be -7)</param> /// <param name="y">Moves the window so that there are this many pixels between the edge of the screen and the top side of the window (In order to hide the Windows top bar use -29)</param>
-		void SetWindowPos(VEC2F v) { ::SetWindowPos(window, NULL, (int)v.x, (int)v.y, NULL, NULL, SWP_NOSIZE); }
 
-		//Used the same name as a function in 'Windows.h', this is horrible practice
-						/// <summary>
-						/// Moves the command prompt window by a number of pixels on the screen (This function has the same name as one in 'Windows.h', if by any chance you meant to use that one, use '::MoveWindow')
-						/// </summary>
-						/// <param name="x">Moves the window this many pixels to the right (Negative numbers go to the left)</param>
-						/// <param name="y">Moves the window this many pixels down (Negative numbers go up)</param>
-		void MoveWindow(short x, short y)
+		void ChangeColor(short col)
 		{
-			WINDOWINFO winInfo = WINDOWINFO();
-			GetWindowInfo(window, &winInfo);
-			::SetWindowPos(window, NULL, winInfo.rcWindow.left + x, winInfo.rcWindow.top + y, NULL, NULL, SWP_NOSIZE);
+			for (short& c : colors)
+			{
+				c = col;
+			}
+			for (Mesh& lod : lods)
+			{
+				lod.ChangeColor(col);
+			}
 		}
-						/// <summary>Moves the command prompt window by a number of pixels on the screen (This function has the same name as one in 'Windows.h', if by any chance you meant to use that one, use '::MoveWindow')</summary> /// <param name="x">Moves the window this many pixels to the right (Negative numbers go to the left)</param> /// <param name="y">Moves the window this many pixels down (Negative numbers go up)</param>
-		void MoveWindow(VEC2F v) { MoveWindow((short)v.x, (short)v.y); }
 
-		void SetTitle(const wchar_t* msg)
+						/// <summary>The face of the full mesh that face 'face' was simplified from (Itself, for the full mesh)</summary>
+		unsigned int SourceFace(size_t face) const { return (sourceFaces.empty() ? (unsigned int)face : sourceFaces[face]); }
+
+						/// <summary>How many bytes the mesh's arrays take up</summary>
+		size_t MemoryUsed() const
 		{
-			swprintf(title, 256, msg);
+			size_t bytes = positions.capacity() * sizeof(cmde::VEC3F) + indices.capacity() * sizeof(unsigned int) + normals.capacity() * sizeof(cmde::VEC3F)
+				+ colors.capacity() * sizeof(short) + edges.capacity() * sizeof(unsigned char) + sourceFaces.capacity() * sizeof(unsigned int)
+				+ meshlets.capacity() * sizeof(Meshlet) + meshletFaces.capacity() * sizeof(unsigned int);
+			for (const Mesh& lod : lods)
+			{
+				bytes += lod.MemoryUsed();
+			}
+			return bytes;
 		}
 
-		void UpdateTitle()
+	private:
+		friend struct MeshSimplifier;
+
+		static unsigned long long EdgeKey(unsigned int a, unsigned int b) { return (a < b ? (unsigned long long)a << 32 | b : (unsigned long long)b << 32 | a); }
+
+		void Reserve(size_t faces)
 		{
-			wchar_t tmp[256];
-			swprintf(tmp, 256, L"%s  |  FPS:%f", title, 1.0f / deltaTime);
-			//More data: swprintf(tmp, 256, L"%s  |  FPS:%f | Max: %f | Avg: %f", title, 1.0f / deltaTime, 1.0f / quickest, 1.0f / (sum / frameAmount));
-			SetConsoleTitle(tmp);
+			indices.reserve(faces * 3);
+			normals.reserve(faces);
+			colors.reserve(faces);
+			edges.reserve(faces);
 		}
 
-						/// <summary>0 -> nothing ; 1 -> released ; 2 -> pressed ; 3 -> held ; MOUSE_X and MOUSE_Y -> point on the command prompt</summary>
-		void ReadInputs()
+		void AddTriangle(Triangle& t, POSITIONLOOKUP& lookup)
 		{
-			short tx = inputs[MOUSE_X];
-			short ty = inputs[MOUSE_Y];
-			for (auto& o : inputs)
+			for (int i = 0; i < 3; i++)
 			{
-				switch (o.second)
+				std::pair<POSITIONLOOKUP::iterator, bool> found = lookup.emplace(t.vertices[i], (unsigned int)positions.size());
+				if (found.second)
 				{
-				case 2:
-					o.second = 3;
-					break;
-				case 1:
-					o.second = 0;
-					break;
-				case -1:
-					o.second = 0;
-					break;
+					positions.push_back(t.vertices[i]);
 				}
+				indices.push_back(found.first->second);
 			}
-			inputs[MOUSE_X] = tx;
-			inputs[MOUSE_Y] = ty;
-			INPUT_RECORD buf;
-			DWORD count = 0;
-			DWORD trash;
+			normals.push_back(t.normal);
+			colors.push_back(t.color);
+			edges.push_back((unsigned char)(t.visibleSides[0] | t.visibleSides[1] << 1 | t.visibleSides[2] << 2));
+		}
+
+		void CalculateRadius()
+		{
+			radius = 0;
+			for (cmde::VEC3F& p : positions)
+			{
+				radius = max(radius, Magnitude(p));
+			}
+		}
 
-			GetNumberOfConsoleInputEvents(consoleInput, &count);
-			for (DWORD c = 0; c < count; c++)
+						/// <summary>Splits the faces up into meshlets, each grown out from a face across its edges, always taking the neighbour that's closest to facing the same way as the faces already in it</summary>
+		void BuildMeshlets()
+		{
+			meshlets.clear();
+			meshletFaces.clear();
+			meshletFaces.reserve(FaceCount());
+			//The face across each face's 3 edges (UINT_MAX for none)
+			std::vector<unsigned int> across(FaceCount() * 3, UINT_MAX);
+			std::unordered_map<unsigned long long, unsigned int> firstSide;
+			firstSide.reserve(FaceCount() * 2);
+			for (unsigned int side = 0; side < across.size(); side++)
 			{
-				if (!ReadConsoleInputW(consoleInput, &buf, 1, &trash))
+				unsigned int f = side / 3;
+				std::pair<std::unordered_map<unsigned long long, unsigned int>::iterator, bool> found = firstSide.emplace(EdgeKey(indices[side], indices[f * 3 + (side + 1) % 3]), side);
+				if (!found.second && across[found.first->second] == UINT_MAX)
 				{
-					ThrowError(L"FailedToReadInput");
-					return;
+					across[side] = found.first->second / 3;
+					across[found.first->second] = f;
 				}
+			}
 
-				if (buf.EventType == KEY_EVENT)
+			std::vector<bool> used(FaceCount(), false);
+			std::vector<unsigned int> frontier;
+			for (unsigned int seed = 0; seed < FaceCount(); seed++)
+			{
+				if (used[seed])
+					continue;
+				Meshlet m = {};
+				m.first = (unsigned int)meshletFaces.size();
+				cmde::VEC3F normalSum;
+				frontier.clear();
+				frontier.push_back(seed);
+				while (!frontier.empty() && m.count < MESHLET_SIZE)
 				{
-					wchar_t t = buf.Event.KeyEvent.uChar.UnicodeChar;
-					std::map<wchar_t, short>::iterator k = inputs.find(t);
-					if (k == inputs.end())
+					size_t best = 0;
+					float bestAlignment = -2;
+					for (size_t i = 0; i < frontier.size(); i++)
 					{
+						float alignment = (m.count == 0 ? 1 : DotProduct(normals[frontier[i]], normalSum) / m.count);
+						if (alignment > bestAlignment)
+						{
+							bestAlignment = alignment;
+							best = i;
+						}
+					}
+					if (bestAlignment < MESHLET_MIN_ALIGNMENT)
+						break;
+					unsigned int f = frontier[best];
+					frontier[best] = frontier.back();
+					frontier.pop_back();
+					if (used[f])
 						continue;
+					used[f] = true;
+					meshletFaces.push_back(f);
+					m.count++;
+					normalSum = normalSum + normals[f];
+					for (int i = 0; i < 3; i++)
+					{
+						if (across[f * 3 + i] != UINT_MAX && !used[across[f * 3 + i]])
+						{
+							frontier.push_back(across[f * 3 + i]);
+						}
 					}
+				}
 
-					k->second = (!buf.Event.KeyEvent.bKeyDown ? 1 : (k->second <= 1 ? 2 : 3));
-
-					if (buf.Event.KeyEvent.dwControlKeyState > 0)
+				cmde::VEC3F low = positions[indices[seed * 3]];
+				cmde::VEC3F high = low;
+				for (unsigned int i = m.first; i < m.first + m.count; i++)
+				{
+					for (int c = 0; c < 3; c++)
 					{
-						inputs[LALT] = (inputs[LALT] == 0 && (buf.Event.KeyEvent.dwControlKeyState & LEFT_ALT_PRESSED) == 0 ? 0 : 1);
-						inputs[RALT] = (inputs[RALT] == 0 && (buf.Event.KeyEvent.dwControlKeyState & RIGHT_ALT_PRESSED) == 0 ? 0 : 1);
-						inputs[LCTRL] = (inputs[LCTRL] == 0 && (buf.Event.KeyEvent.dwControlKeyState & LEFT_CTRL_PRESSED) == 0 ? 0 : 1);
-						inputs[RCTRL] = (inputs[RCTRL] == 0 && (buf.Event.KeyEvent.dwControlKeyState & RIGHT_CTRL_PRESSED) == 0 ? 0 : 1);
-						inputs[SHIFT] = (inputs[SHIFT] == 0 && (buf.Event.KeyEvent.dwControlKeyState & SHIFT_PRESSED) == 0 ? 0 : 1);
+						cmde::VEC3F& p = positions[indices[meshletFaces[i] * 3 + c]];
+						low = cmde::VEC3F(min(low.x, p.x), min(low.y, p.y), min(low.z, p.z));
+						high = cmde::VEC3F(max(high.x, p.x), max(high.y, p.y), max(high.z, p.z));
 					}
 				}
-				else
+				m.center = (low + high) * 0.5f;
+				float length = Magnitude(normalSum);
+				m.axis = (length > 0 ? normalSum / length : normalSum);
+				float narrowest = (length > 0 ? 1.0f : -1.0f);
+				for (unsigned int i = m.first; i < m.first + m.count; i++)
 				{
-					if (buf.EventType == MOUSE_EVENT)
+					for (int c = 0; c < 3; c++)
 					{
-						switch (buf.Event.MouseEvent.dwEventFlags)
-						{
-						case MOUSE_MOVED:
-							inputs[MOUSE_X] = buf.Event.MouseEvent.dwMousePosition.X;
-							inputs[MOUSE_Y] = buf.Event.MouseEvent.dwMousePosition.Y;
-							break;
-						case DOUBLE_CLICK:
-							inputs[MOUSE_DCLICK] = 1;
-							break;
-						case MOUSE_WHEELED:
-							inputs[MOUSE_SCROLL] = (buf.Event.MouseEvent.dwButtonState >> 31 == 0 ? 1 : -1); inputs[MOUSE_SCROLL] = -1;
-							break;
-						case 0: //Means a button was clicked
-							for (int i = 0; i < 8; i++)
-							{
-								inputs[MOUSE_BTN + i] += ((buf.Event.MouseEvent.dwButtonState & (1 << i)) > 0 ? 1 : 1 - inputs[MOUSE_BTN + i]);
-							}
-							break;
-						}
+						m.radius = max(m.radius, Magnitude(positions[indices[meshletFaces[i] * 3 + c]] - m.center));
 					}
+					narrowest = min(narrowest, DotProduct(normals[meshletFaces[i]], m.axis));
 				}
+				m.coneSine = (narrowest > 0 ? sqrtf(max(1 - narrowest * narrowest, 0.0f)) : 2.0f);
+				meshlets.push_back(m);
 			}
 		}
+	};
 
-						/// <summary>Starts the game loop (Clears the frame; Runs Setup(); Runs Update() in a loop while 'running' is true)</summary>
-		void Start()
-		{
-			auto curT = std::chrono::system_clock::now();
-			auto preT = curT;
-			std::chrono::duration<float> dT;
+	//Sum of the squared distances to a set of planes, kept as the 10 unique values of a symmetric 4x4 matrix
+	//	(Doubles, since a quadric adds up hundreds of tiny planes and floats lose too much of them)
+	struct Quadric
+	{
+		double a[10];
 
-			ClearFrame();
-			Setup();
-			WriteConsoleOutput(console, screen, { screenSize.X, screenSize.Y }, { 0, 0 }, &sr);
-			if (autoClearScreen)
+		Quadric() { for (double& v : a) v = 0; }
+
+		//The plane through 'point' with unit normal 'normal', counted 'weight' times
+		Quadric(cmde::VEC3F normal, cmde::VEC3F point, double weight)
+		{
+			double n[4] = { normal.x, normal.y, normal.z, -DotProduct(normal, point) };
+			int k = 0;
+			for (int i = 0; i < 4; i++)
 			{
-				while (running)
+				for (int j = i; j < 4; j++)
 				{
-					curT = std::chrono::system_clock::now();
-					dT = curT - preT;
-					_deltaTime = dT.count();
-					//More data: sum += _deltaTime; frameAmount++; quickest = min(quickest, _deltaTime);
-					if (deltaTime < fpsLimit)
-						continue;
-					preT = curT;
-					UpdateTitle();
-					ClearFrame();
-					ReadInputs();
-					Update();
-					//Draw Frame
-					WriteConsoleOutput(console, screen, { screenSize.X, screenSize.Y }, { 0, 0 }, &sr);
+					a[k++] = n[i] * n[j] * weight;
 				}
 			}
-			else
+		}
+
+		Quadric& operator+=(const Quadric& other)
+		{
+			for (int i = 0; i < 10; i++)
 			{
-				while (running)
-				{
-					curT = std::chrono::system_clock::now();
-					dT = curT - preT;
-					_deltaTime = dT.count();
-					if (deltaTime < fpsLimit)
-						continue;
-					preT = curT;
-					UpdateTitle();
-					ReadInputs();
-					Update();
-					//Draw frame
-					WriteConsoleOutput(console, screen, { screenSize.X, screenSize.Y }, { 0, 0 }, &sr);
-				}
+				a[i] += other.a[i];
 			}
-			CloseHandle(window);
-			CloseHandle(console);
-			CloseHandle(consoleInput);
+			return *this;
 		}
 
-		virtual void Setup() = 0;
+		Quadric operator+(const Quadric& other) const { Quadric sum = *this; return sum += other; }
 
-		virtual void Update() = 0;
+						/// <summary>The summed squared distance from 'v' to every plane</summary>
+		double Error(cmde::VEC3F v) const
+		{
+			double x = v.x, y = v.y, z = v.z;
+			return x * x * a[0] + 2 * x * y * a[1] + 2 * x * z * a[2] + 2 * x * a[3] + y * y * a[4] + 2 * y * z * a[5] + 2 * y * a[6] + z * z * a[7] + 2 * z * a[8] + a[9];
+		}
 
-						/// <summary>
-						/// Opens a Windows Explorer window, allowing the user to choose a file of the designated file type to open. Will return true if a file is chosen.
-						/// </summary>
-						/// <param name="openFile">The variable to which this function will write the output file to if the user picks a file</param>
-						/// <param name="fileType">The file type the user will be asked for</param>
-						/// <param name="fileExtensions">The internal file type info. Must be formatted correctly: L"*.txt;*.jpg;*.png"</param>
-		bool PromptFileSearch(FILE* openFile, const wchar_t* fileType, const wchar_t* fileExtensions)
+						/// <summary>Finds the point with the smallest error, failing if there isn't a single one (Like when all the planes are parallel)</summary>
+		bool Minimum(cmde::VEC3F* output) const
 		{
-			openFile->fileName.lStructSize = sizeof(OPENFILENAMEW);
-			openFile->fileName.hwndOwner = window;
-			wchar_t temp[128] = { 0 };
-			swprintf(temp, 128, L"%ls (%ls)%c%ls%c%c", fileType, fileExtensions, '\0', fileExtensions, '\0', '\0');
-			openFile->fileName.lpstrFilter = temp;
-			wchar_t flnm[MAX_PATH] = { 0 };
-			flnm[0] = L'\0';
-			openFile->fileName.lpstrFile = flnm;
-			openFile->fileName.nMaxFile = MAX_PATH;
-			openFile->fileName.Flags = OFN_FILEMUSTEXIST;
-			wchar_t temp2[128];
-			swprintf(temp2, 128, L"Open %ls file to import...", fileType);
-			openFile->fileName.lpstrTitle = temp2;
-			if (GetOpenFileNameW(&(openFile->fileName)))
+			double det = a[0] * (a[4] * a[7] - a[5] * a[5]) - a[1] * (a[1] * a[7] - a[5] * a[2]) + a[2] * (a[1] * a[5] - a[4] * a[2]);
+			double scale = a[0] + a[4] + a[7];
+			if (fabs(det) <= 1e-6 * scale * scale * scale)
+				return false;
+			//Cramer's rule on (The top left 3x3) * v = -(The right column)
+			double b[3] = { -a[3], -a[6], -a[8] };
+			double divideDet = 1.0 / det;
+			output->x = (float)((b[0] * (a[4] * a[7] - a[5] * a[5]) - a[1] * (b[1] * a[7] - a[5] * b[2]) + a[2] * (b[1] * a[5] - a[4] * b[2])) * divideDet);
+			output->y = (float)((a[0] * (b[1] * a[7] - a[5] * b[2]) - b[0] * (a[1] * a[7] - a[5] * a[2]) + a[2] * (a[1] * b[2] - b[1] * a[2])) * divideDet);
+			output->z = (float)((a[0] * (a[4] * b[2] - b[1] * a[5]) - a[1] * (a[1] * b[2] - b[1] * a[2]) + b[0] * (a[1] * a[5] - a[4] * a[2])) * divideDet);
+			return true;
+		}
+	};
+
+	//Quadric error metric simplification (Garland & Heckbert): every position gets the quadric of the faces around it, and the edge whose 2 ends can be merged into 1 point for the least error is always the next one collapsed
+	//	Edges on the mesh's border, or between faces of different colors, add planes along them, so that holes don't grow and color patches keep their shape
+	struct MeshSimplifier
+	{
+		//A possible collapse, which is only still valid if neither end has changed since it was queued
+		struct Candidate
+		{
+			float cost;
+			unsigned int ends[2];
+			unsigned int stamps[2];
+			cmde::VEC3F target;
+
+			bool operator>(const Candidate& other) const { return cost > other.cost; }
+		};
+
+		//How much more the planes along borders and color seams count than the faces' own planes
+		static constexpr double SEAM_WEIGHT = 100.0;
+
+		std::vector<cmde::VEC3F> positions;
+		std::vector<unsigned int> indices;
+		std::vector<Quadric> quadrics;
+		//The faces using each position, including ones that have since been removed (Which get skipped)
+		std::vector<std::vector<unsigned int>> positionFaces;
+		//Bumped each time a position moves, which invalidates every candidate queued with the old value
+		std::vector<unsigned int> stamps;
+		//Positions that were merged into another one
+		std::vector<bool> merged;
+		std::vector<bool> removed;
+		std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> queue;
+		size_t faceCount;
+
+		MeshSimplifier(const Mesh& mesh)
+		{
+			positions = mesh.positions;
+			indices = mesh.indices;
+			faceCount = mesh.FaceCount();
+			quadrics.resize(positions.size());
+			positionFaces.resize(positions.size());
+			stamps.resize(positions.size(), 0);
+			merged.resize(positions.size(), false);
+			removed.resize(faceCount, false);
+
+			for (size_t f = 0; f < faceCount; f++)
 			{
-				HANDLE fileHandle = CreateFileW(
-					openFile->fileName.lpstrFile,	// Filename
-					GENERIC_READ,					// Desired access
-					0,								// Share mode
-					NULL,							// Security attributes
-					OPEN_EXISTING,					// Opens a file only if it already exist
-					FILE_ATTRIBUTE_NORMAL,			// Flags and attributes
-					NULL);							// Template file handle
-				if (fileHandle != INVALID_HANDLE_VALUE)
+				const unsigned int* i = &indices[f * 3];
+				cmde::VEC3F cross = CrossProduct(positions[i[1]] - positions[i[0]], positions[i[2]] - positions[i[0]]);
+				float area = Magnitude(cross);
+				//Weighted by area, so that lots of tiny faces don't outvote 1 big one
+				Quadric q = (area > 0 ? Quadric(cross / area, positions[i[0]], area * 0.5) : Quadric());
+				for (int c = 0; c < 3; c++)
 				{
-					openFile->fileHandle = fileHandle;
+					quadrics[i[c]] += q;
+					positionFaces[i[c]].push_back((unsigned int)f);
+				}
+			}
 
-					wchar_t fullDirectory[MAX_PATH] = { 0 };
-					int length1 = swprintf(fullDirectory, MAX_PATH, L"%ls", openFile->fileName.lpstrFile);
-					int lastSlash = 0;
-					for (int i = 0; i < length1; i++)
-					{
-						if (fullDirectory[i] == L'\\')
-						{
-							lastSlash = i;
-						}
-					}
-					bool extension = false;
-					int index = 0;
-					for (int i = lastSlash + 1; i < length1; i++)
+			//Every edge, with the 1st face that uses it, and whether it's a border or a color seam
+			struct EdgeInfo { unsigned int face; unsigned int uses; bool seam; };
+			std::unordered_map<unsigned long long, EdgeInfo> edgeInfo;
+			edgeInfo.reserve(faceCount * 2);
+			for (size_t f = 0; f < faceCount; f++)
+			{
+				for (int c = 0; c < 3; c++)
+				{
+					std::pair<std::unordered_map<unsigned long long, EdgeInfo>::iterator, bool> found = edgeInfo.emplace(Mesh::EdgeKey(indices[f * 3 + c], indices[f * 3 + (c + 1) % 3]), EdgeInfo{ (unsigned int)f, 0, false });
+					EdgeInfo& e = found.first->second;
+					e.uses++;
+					e.seam |= (mesh.colors[e.face] != mesh.colors[f]);
+				}
+			}
+			for (std::pair<const unsigned long long, EdgeInfo>& e : edgeInfo)
+			{
+				unsigned int a = (unsigned int)(e.first >> 32);
+				unsigned int b = (unsigned int)e.first;
+				if (e.second.uses == 1 || e.second.seam)
+				{
+					//A plane through the edge standing straight up off of the face, so that sliding the edge sideways costs a lot
+					cmde::VEC3F along = positions[b] - positions[a];
+					cmde::VEC3F normal = CrossProduct(along, mesh.normals[e.second.face]);
+					float length = Magnitude(normal);
+					if (length > 0)
 					{
-						if (!extension)
-						{
-							if (fullDirectory[i] == L'.')
-							{
-								extension = true;
-								index = -1;
-							}
-							else
-							{
-								openFile->name[index] = fullDirectory[i];
-							}
-						}
-						else
-						{
-							openFile->extension[index] = fullDirectory[i];
-						}
-						index++;
+						Quadric q(normal / length, positions[a], SEAM_WEIGHT * DotProduct(along, along));
+						quadrics[a] += q;
+						quadrics[b] += q;
 					}
-					return true;
 				}
 			}
-			return false;
+			for (std::pair<const unsigned long long, EdgeInfo>& e : edgeInfo)
+			{
+				queue.push(Evaluate((unsigned int)(e.first >> 32), (unsigned int)e.first));
+			}
 		}
 
-						/// <summary>
-						/// Opens a Windows Explorer window, allowing the user to choose the name and location of the file to save to, with the designated file type. Will return true if a file is chosen.
-						/// </summary>
-						/// <param name="saveFile">The variable to which this function will write the output file to if the user picks a file</param>
-						/// <param name="fileType">The file type the user will be asked for</param>
-						/// <param name="fileExtensions">The internal file type info. Must be formatted correctly: L"*.txt;*.jpg;*.png"</param>
-		bool PromptFileSave(FILE* saveFile, const wchar_t* fileType, const wchar_t* fileExtensions)
+		size_t FaceCount() const { return faceCount; }
+
+						/// <summary>Collapses the cheapest edge that can be collapsed without folding the mesh over, returning false once there are none left</summary>
+		bool Collapse()
 		{
-			saveFile->fileName.lStructSize = sizeof(OPENFILENAMEW);
-			saveFile->fileName.hwndOwner = window;
-			wchar_t temp[128] = { 0 };
-			swprintf(temp, 128, L"%ls (%ls)%c%ls%c%c", fileType, fileExtensions, '\0', fileExtensions, '\0', '\0');
-			saveFile->fileName.lpstrFilter = temp;
-			wchar_t flnm[MAX_PATH] = { 0 };
-			flnm[0] = L'\0';
-			saveFile->fileName.lpstrFile = flnm;
-			saveFile->fileName.nMaxFile = MAX_PATH;
-			saveFile->fileName.lpstrTitle = L"Save as";
-			wchar_t temp2[128] = { 0 };
-			int extensionsLength = swprintf(temp2, 128, L"%ls", fileExtensions);
-			for (int i = 0; i < extensionsLength; i++)
+			while (!queue.empty())
 			{
-				if (fileExtensions[i] == L'.')
+				Candidate c = queue.top();
+				queue.pop();
+				unsigned int keep = c.ends[0];
+				unsigned int lose = c.ends[1];
+				if (merged[keep] || merged[lose] || stamps[keep] != c.stamps[0] || stamps[lose] != c.stamps[1])
+					continue;
+				if (!CanCollapse(keep, lose, c.target))
+					continue;
+
+				positions[keep] = c.target;
+				quadrics[keep] += quadrics[lose];
+				merged[lose] = true;
+				stamps[keep]++;
+				for (unsigned int f : positionFaces[lose])
 				{
-					i++;
-					for (int  j = 0; j + i < extensionsLength; j++)
+					if (removed[f])
+						continue;
+					unsigned int* i = &indices[f * 3];
+					if (i[0] == keep || i[1] == keep || i[2] == keep)
 					{
-						if (fileExtensions[j + i] == L';')
+						//The faces along the edge get squashed flat
+						removed[f] = true;
+						faceCount--;
+					}
+					else
+					{
+						for (int k = 0; k < 3; k++)
 						{
-							temp2[j] = L'\0';
-							break;
+							if (i[k] == lose)
+							{
+								i[k] = keep;
+							}
 						}
-						temp2[j] = fileExtensions[j + i];
+						positionFaces[keep].push_back(f);
 					}
-					break;
 				}
-			}
-			saveFile->fileName.lpstrDefExt = temp2;
-			if (GetSaveFileNameW(&(saveFile->fileName)))
-			{
-				HANDLE fileHandle = CreateFileW(
-					saveFile->fileName.lpstrFile,	// Filename
-					GENERIC_WRITE,					// Desired access
-					0,								// Share mode
-					NULL,							// Security attributes
-					CREATE_NEW,						// Creates a new file, only if it doesn't already exist
-					FILE_ATTRIBUTE_NORMAL,			// Flags and attributes
-					NULL);							// Template file handle
-				if (fileHandle != INVALID_HANDLE_VALUE)
+				positionFaces[lose] = std::vector<unsigned int>();
+				std::vector<unsigned int>& faces = positionFaces[keep];
+				faces.erase(std::remove_if(faces.begin(), faces.end(), [this](unsigned int f) { return (bool)removed[f]; }), faces.end());
+
+				//Every edge touching the moved position has a new cost
+				std::vector<unsigned int> neighbours = Neighbours(keep);
+				for (unsigned int n : neighbours)
 				{
-					saveFile->fileHandle = fileHandle;
-					return true;
+					queue.push(Evaluate(keep, n));
 				}
+				return true;
 			}
 			return false;
 		}
 
-		bool ScreenPosDrawnTo(short x, short y)
+						/// <summary>Builds what's left into a new mesh, with each face keeping the color and edges of the face of 'source' it came from</summary>
+		Mesh Build(const Mesh& source) const
 		{
-			return OnScreen(x, y) && zBuffer[y * screenSize.X + x] != 1;
+			std::vector<Triangle> none;
+			Mesh output(none);
+			std::vector<unsigned int> remap(positions.size(), UINT_MAX);
+			output.indices.reserve(faceCount * 3);
+			output.normals.reserve(faceCount);
+			output.colors.reserve(faceCount);
+			output.edges.reserve(faceCount);
+			output.sourceFaces.reserve(faceCount);
+			for (size_t f = 0; f < removed.size(); f++)
+			{
+				if (removed[f])
+					continue;
+				for (int c = 0; c < 3; c++)
+				{
+					unsigned int p = indices[f * 3 + c];
+					if (remap[p] == UINT_MAX)
+					{
+						remap[p] = (unsigned int)output.positions.size();
+						output.positions.push_back(positions[p]);
+					}
+					output.indices.push_back(remap[p]);
+				}
+				const unsigned int* i = &indices[f * 3];
+				output.normals.push_back(NormalizeFast(CrossProduct(positions[i[1]] - positions[i[0]], positions[i[2]] - positions[i[0]])));
+				output.colors.push_back(source.colors[f]);
+				output.edges.push_back(source.edges[f]);
+				output.sourceFaces.push_back(source.sourceFaces.empty() ? (unsigned int)f : source.sourceFaces[f]);
+			}
+			output.CalculateRadius();
+			output.BuildMeshlets();
+			return output;
 		}
 
-		short ScreenPosColor(short x, short y)
+	private:
+						/// <summary>Works out where merging 'a' and 'b' should put the merged point, and what it costs</summary>
+		Candidate Evaluate(unsigned int a, unsigned int b) const
 		{
-			if (ScreenPosDrawnTo(x, y))
+			Quadric q = quadrics[a] + quadrics[b];
+			cmde::VEC3F middle = (positions[a] + positions[b]) * 0.5f;
+			cmde::VEC3F target;
+			double cost;
+			//The best point can end up far off of the edge when the planes are nearly parallel, in which case the ends and the middle are safer
+			bool solved = q.Minimum(&target);
+			cmde::VEC3F offset = target - middle;
+			if (solved && DotProduct(offset, offset) <= DotProduct(positions[b] - positions[a], positions[b] - positions[a]))
 			{
-				return screen[y * screenSize.X + x].Attributes;
+				cost = q.Error(target);
 			}
-			return 0xFFFF;
+			else
+			{
+				cmde::VEC3F options[3] = { positions[a], positions[b], middle };
+				target = options[0];
+				cost = q.Error(target);
+				for (int i = 1; i < 3; i++)
+				{
+					double error = q.Error(options[i]);
+					if (error < cost)
+					{
+						cost = error;
+						target = options[i];
+					}
+				}
+			}
+			return { (float)max(cost, 0.0), { a, b }, { stamps[a], stamps[b] }, target };
 		}
 
-		//General useful functions
-#pragma region MiscFunctions
-						/// <summary>Elevates a number to the power of 2</summary>
-		static double Pow2(double value) { return value * value; }
-						/// <summary>Calculates the dot product of 2 vectors</summary>
-		static float DotProduct(VEC4F v1, VEC4F v2) { return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z + v1.w * v2.w; }
-						/// <summary>Calculates the orthagonal vector of a plane defined by 2 vectors (Index = v1; Middle = v2; Thumb = result)</summary>
-		static VEC3F CrossProduct(VEC3F v1, VEC3F v2) { return { v1.y * v2.z - v1.z * v2.y, v1.z * v2.x - v1.x * v2.z, v1.x * v2.y - v1.y * v2.x }; }
-						/// <summary>Calculates the length of a vector</summary>
-		static float Magnitude(VEC4F v) { return (float)sqrt((DotProduct(v, v))); }
-						/// <summary>Limits 'value' to the range between 'low' and 'high'</summary>
-		static float Clamp(float value, float low, float high) { return (value < low ? low : (high < value ? high : value)); }
-						/// <summary>Gives the sign of a value (Positive = 1; Negative = -1; Other = itself)</summary>
-		static int Sign(int value) { return (value > 0 ? 1 : (value < 0 ? -1 : value)); }
-						/// <summary>Gives the sign of a value (Positive = 1; Negative = -1; Other = itself)</summary>
-		static double Sign(double value) { return (value > 0.0 ? 1.0 : (value < 0.0 ? -1.0 : value)); }
-						/// <summary>Calculates the angle between 2 vectors in degrees</summary>
-		static float Angle(VEC4F v1, VEC4F v2) { return (float)acos(Clamp(DotProduct(v1, v2) / (Magnitude(v2) * Magnitude(v1)), -1.0f, 1.0f)) * DEG; }
-						/// <summary>Gives a vector of length 1 in the same direction</summary>
-		static VEC4F Normalize(VEC4F v) { return v / Magnitude(v); }
-
-#pragma region LinearFunction
-						/// <summary>Calculates the y value of point x on the line defined by the 2 points provided (Returns y1 if x1 == x2)</summary>
-		static float LinearFunction(float x1, float y1, float x2, float y2, float x)
-		{
-			if (y1 == y2 || x1 == x2)
-				return y1;
-			return y1 + ((y2 - y1) / (x2 - x1) * (x - x1));
-		}
-						/// <summary>Calculates the point at 'x' on the line defined by the 2 points provided (Returns p1 if p1.x == p2.x)</summary>
-		static VEC4F LinearFunction(VEC4F p1, VEC4F p2, float x)
-		{
-			if (p1.x == p2.x)
-				return p1;
-			return { x, LinearFunction(p1.x, p1.y, p2.x, p2.y, x), LinearFunction(p1.x, p1.z, p2.x, p2.z, x), LinearFunction(p1.x, p1.w, p2.x, p2.w, x) };
-		}
-		//Warn if both points have the same X and thus can't be made into a linear function
-						/// <summary>Calculates the y value of point x on the line defined by the 2 points provided and inserts it into 'output' (Returns false if x1 == x2)</summary>
-		static bool LinearFunction(float x1, float y1, float x2, float y2, float x, float* output) { if (x1 == x2) { return false; } *output = LinearFunction(x1, y1, x2, y2, x); return true; }
-						/// <summary>Calculates the point at 'x' on the line defined by the 2 points provided and inserts it into 'output' (Returns false if p1.x == p2.x)</summary>
-		static bool LinearFunction(VEC4F p1, VEC4F p2, float x, VEC4F* output) { if (p1.x == p2.x) { return false; } *output = LinearFunction(p1, p2, x); return true; }
-						/// <summary>Generates the linear function based on 'x' defined by the 2 points provided (Returns y=0 if x1 == x2)</summary>
-		static LINEAR LinearFunction(float x1, float y1, float x2, float y2)
+		std::vector<unsigned int> Neighbours(unsigned int p) const
 		{
-			if (x1 == x2)
-				return LINEAR();
-			return { VEC4F(0, (y2 - y1) / (x2 - x1), 0, 0), VEC4F(0, -(y2 - y1) / (x2 - x1) * x1 + y1, 0, 0) };
-		}
-						/// <summary>Generates the linear function based on 'x' defined by the 2 points provided (Returns y=z=w=0 if p1.x == p2.x)</summary>
-		static LINEAR LinearFunction(VEC4F p1, VEC4F p2)
-		{
-			if (p1.x == p2.x)
-				return LINEAR();
-			float t = 1.0f / (p2.x - p1.x);
-			return { VEC4F(1, (p2.y - p1.y) * t, (p2.z - p1.z) * t, (p2.w - p1.w) * t), VEC4F(0, -(p2.y - p1.y) * t * p1.x + p1.y, -(p2.z - p1.z) * t * p1.x + p1.z, -(p2.w - p1.w) * t * p1.x + p1.w) };
+			std::vector<unsigned int> output;
+			for (unsigned int f : positionFaces[p])
+			{
+				if (removed[f])
+					continue;
+				for (int c = 0; c < 3; c++)
+				{
+					unsigned int n = indices[f * 3 + c];
+					if (n != p && std::find(output.begin(), output.end(), n) == output.end())
+					{
+						output.push_back(n);
+					}
+				}
+			}
+			return output;
 		}
-		//Warn if both points have the same X and thus can't be made into a linear function
-						/// <summary>Generates the linear function based on 'x' defined by the 2 points provided and inserts it into 'output' (Returns false if x1 == x2)</summary>
-		static bool LinearFunction(float x1, float y1, float x2, float y2, LINEAR* output) { if (x1 == x2) { return false; } *output = LinearFunction(x1, y1, x2, y2); return true; }
-						/// <summary>Generates the linear function based on 'x' defined by the 2 points provided and inserts it into 'output' (Returns false if p1.x == p2.x)</summary>
-		static bool LinearFunction(VEC4F p1, VEC4F p2, LINEAR* output) { if (p1.x == p2.x) { return false; } *output = LinearFunction(p1, p2); return true; }
-#pragma endregion
 
-						/// <summary>Calculates the point at 'x' on the line defined by the 3 points provided and inserts it into 'output' (Returns false if there is any repeat value in p1.x, p2.x, and p3.x)</summary>
-		static bool QuadraticFunction(VEC2F p1, VEC2F p2, VEC2F p3, float x, VEC2F* output)
+						/// <summary>Whether merging 'lose' into 'keep' at 'target' keeps the mesh in 1 piece without flipping any faces</summary>
+		bool CanCollapse(unsigned int keep, unsigned int lose, cmde::VEC3F target) const
 		{
-			if (p1.x == p2.x || p1.x == p3.x || p2.x == p3.x)
+			//The 2 ends can only share the neighbours across the faces along the edge, or else the collapse would pinch the mesh together
+			std::vector<unsigned int> keepNeighbours = Neighbours(keep);
+			std::vector<unsigned int> loseNeighbours = Neighbours(lose);
+			size_t shared = 0;
+			for (unsigned int n : loseNeighbours)
 			{
-				return false;
+				shared += (std::find(keepNeighbours.begin(), keepNeighbours.end(), n) != keepNeighbours.end());
 			}
-			float d = (p1.x * (p3.x * p3.x - p2.x * p2.x) + (p3.x * p2.x + p1.x * p1.x) * (p2.x - p3.x));
-			if (d == 0)
+			size_t edgeFaces = 0;
+			for (unsigned int f : positionFaces[lose])
 			{
-				return false;
+				const unsigned int* i = &indices[f * 3];
+				edgeFaces += (!removed[f] && (i[0] == keep || i[1] == keep || i[2] == keep));
 			}
-			float a = (-p1.y * (p3.x - p2.x) - p2.y * (p1.x - p3.x) + p3.y * (p1.x + p2.x)) / d;
-			float b = (p2.y - p3.y + a * p3.x * p3.x - a * p2.x * p2.x) / (p2.x - p3.x);
-			float c = p3.y - b * p3.x - a * p3.x * p3.x;
-			*output = { x, a * x * x + b * x + c };
-			return true;
-		}
-						/// <summary>Generates the quadratic function based on 'x' defined by the 3 points provided and inserts it into 'output' (Returns false if there is any repeat value in p1.x, p2.x, and p3.x)</summary>
-		static bool QuadraticFunction(VEC4F p1, VEC4F p2, VEC4F p3, QUADRATIC* output)
-		{
-			if (p1.x == p2.x || p1.x == p3.x || p2.x == p3.x)
-			{
+			if (shared > edgeFaces)
 				return false;
-			}
-			float d = (p1.x * (p3.x * p3.x - p2.x * p2.x) + (p3.x * p2.x + p1.x * p1.x) * (p2.x - p3.x));
-			if (d == 0)
+
+			for (unsigned int moved : { keep, lose })
 			{
-				return false;
+				for (unsigned int f : positionFaces[moved])
+				{
+					const unsigned int* i = &indices[f * 3];
+					if (removed[f] || i[0] == (moved == keep ? lose : keep) || i[1] == (moved == keep ? lose : keep) || i[2] == (moved == keep ? lose : keep))
+						continue;
+					cmde::VEC3F corners[3] = { positions[i[0]], positions[i[1]], positions[i[2]] };
+					cmde::VEC3F before = CrossProduct(corners[1] - corners[0], corners[2] - corners[0]);
+					for (int c = 0; c < 3; c++)
+					{
+						if (i[c] == moved)
+						{
+							corners[c] = target;
+						}
+					}
+					cmde::VEC3F after = CrossProduct(corners[1] - corners[0], corners[2] - corners[0]);
+					if (DotProduct(before, after) <= 0)
+						return false;
+				}
 			}
-			VEC4F a = { 0, (-p1.y * (p3.x - p2.x) - p2.y * (p1.x - p3.x) + p3.y * (p1.x + p2.x)) / d, (-p1.z * (p3.x - p2.x) - p2.z * (p1.x - p3.x) + p3.z * (p1.x + p2.x)) / d, (-p1.w * (p3.x - p2.x) - p2.w * (p1.x - p3.x) + p3.w * (p1.x + p2.x)) / d };
-			VEC4F b = { 1, (p2.y - p3.y + a.y * p3.x * p3.x - a.y * p2.x * p2.x) / (p2.x - p3.x), (p2.z - p3.z + a.z * p3.x * p3.x - a.z * p2.x * p2.x) / (p2.x - p3.x), (p2.w - p3.w + a.w * p3.x * p3.x - a.w * p2.x * p2.x) / (p2.x - p3.x) };
-			VEC4F c = { 0, p3.y - b.y * p3.x - a.y * p3.x * p3.x, p3.z - b.z * p3.x - a.z * p3.x * p3.x, p3.w - b.w * p3.x - a.w * p3.x * p3.x };
-			*output = { a, b, c };
 			return true;
 		}
-
-						/// <summary>Assumes the XYZ axis are set up correctly (X+ is left when Z+ is forwards and Y+ is up)</summary>
-		static VEC3F VectorFromAngles(float h, float v)
-		{
-			return { (float)(sin(h * RAD) * cos(v * RAD)), (float)sin(v * RAD), (float)(cos(h * RAD) * cos(v * RAD)) };
-		}
-#pragma endregion
 	};
-}
-
-class RotateShape : public cmde::CMDEngine
-{
-public:
-	int angle;
-	int edges;
-	float radius;
-	cmde::VEC2F c;
-	float r;
-	wchar_t msg[128];
-	float t;
-
-	RotateShape(short screenWidth, short screenHeight, short fontWidth, short fontHeight) : cmde::CMDEngine(screenWidth, screenHeight, fontWidth, fontHeight, false, true, FPS60)
-	{
-		swprintf(msg, 128, L"");
-		radius = 38;
-		angle = 360;
-		edges = 3;
-		c = { 0.5f, 0.5f };
-		r = 0.49f;
-		t = 0;
-	}
 
-	void Setup()
-	{
-		SetTitle(L"Sketchy Program");
-		c = ScreenPosToPoint(c.x, c.y);
-		r = ScreenPosToPoint(0, r).y;
-		SetWindowPos(600, 40);
-	}
 
-	void Update()
+	//1 object on its own, which is what a Scene's objects are made from (And what Camera::RenderShapeProjection() and the like draw directly)
+	struct Object
 	{
-		DrawRPoly(c, edges, r, (float)angle);
-		angle++;
+		//Never changed once it's shared, so any number of objects can draw the same mesh (Swapping in a different one is fine)
+		std::shared_ptr<const Mesh> mesh;
+		//Per face of the full mesh, the colors to draw this object with instead of the mesh's own (Null to use the mesh's)
+		//	Copies of the object share these too, until one of them gets painted (See SetColor())
+		std::shared_ptr<const std::vector<short>> colors;
+		//Where it is, how it's turned (Degrees around x, y and z, turned around z first and y last) and how big it is
+		//	Only changed through SetPosition(), SetRotation() and SetScale(), so that 'world' keeps up
+		cmde::VEC3F position;
+		cmde::VEC3F rotation;
+		float scale;
+		//Where it is in the world (Everything that draws or hits the object goes by this)
+		WorldTransform world;
+		//The mesh's bounding box, in its own space
+		cmde::VEC3F aabb[2];
+		//The level of detail it was last drawn with (See PickLod())
+		size_t lod;
 
-		if (angle % 60 == 0)
+		Object(std::shared_ptr<const Mesh> m = std::make_shared<const Mesh>(), cmde::VEC3F pos = { 0, 0, 0 })
 		{
-			edges++;
+			mesh = m;
+			position = pos;
+			rotation = { 0, 0, 0 };
+			scale = 1;
+			lod = 0;
+			if (mesh->positions.size() > 0)
+			{
+				RecalculateAABB();
+			}
+			else
+			{
+				UpdateWorld();
+			}
 		}
 
-		MoveWindow((short)cos(angle * 9 * RAD) * 18, (short)sin(angle * 0.8f * RAD) * 10);
-	}
-};
-
-#include <vector>
-#include <thread>
-
-class Test3D : public cmde::CMDEngine
-{
-	struct PLANE
-	{
-		cmde::VEC3F point;
-		cmde::VEC3F normal;
-
-		PLANE() { point = normal = cmde::VEC3F(); }
-		PLANE(cmde::VEC3F p, cmde::VEC3F n) { point = p; normal = Normalize(n); }
-	};
+		void SetPosition(cmde::VEC3F pos) { position = pos; UpdateWorld(); }
+		void SetRotation(cmde::VEC3F rot) { rotation = rot; UpdateWorld(); }
+						/// <summary>Scales the object by the same amount along every axis (Must be above 0)</summary>
+		void SetScale(float s) { scale = s; UpdateWorld(); }
 
-	struct Triangle
-	{
-		cmde::VEC3F vertices[3];
-		short color;
-		cmde::VEC3F normal;
-		//Used for wireframe rendering, so that only the actual triangles' lines get drawn and not the clipped triangles' lines
-		bool visibleSides[3];
+						/// <summary>Recalculates 'world' from the transform, along with the world space bounds</summary>
+		void UpdateWorld() { world = WorldTransform::Build(position, rotation, scale, nullptr, aabb, mesh->radius); }
 
-		Triangle(cmde::VEC3F p1, cmde::VEC3F p2, cmde::VEC3F p3, short col = 0x00FF)
-		{
-			vertices[0] = p1;
-			vertices[1] = p2;
-			vertices[2] = p3;
-			visibleSides[0] = true;
-			visibleSides[1] = true;
-			visibleSides[2] = true;
-			color = col;
-			//normal = Normalize(CrossProduct(vertices[0] - vertices[1], vertices[2] - vertices[1]));
-			normal = Normalize(CrossProduct(vertices[1] - vertices[0], vertices[2] - vertices[0]));
-		}
+						/// <summary>The color face 'face' of the full mesh gets drawn with on this object</summary>
+		short Color(size_t face) const { return (colors ? (*colors)[face] : mesh->colors[face]); }
 
-		Triangle(cmde::VEC3F p1, cmde::VEC3F p2, cmde::VEC3F p3, short col, bool s1, bool s2, bool s3)
+		void ChangeColor(short col)
 		{
-			vertices[0] = p1;
-			vertices[1] = p2;
-			vertices[2] = p3;
-			visibleSides[0] = s1;
-			visibleSides[1] = s2;
-			visibleSides[2] = s3;
-			color = col;
-			//normal = Normalize(CrossProduct(vertices[0] - vertices[1], vertices[2] - vertices[1]));
-			normal = Normalize(CrossProduct(vertices[1] - vertices[0], vertices[2] - vertices[0]));
+			colors = std::make_shared<const std::vector<short>>(mesh->FaceCount(), col);
 		}
 
-		Triangle GetWithOffset(cmde::VEC3F offset)
+						/// <summary>Changes the color of face 'face' of the full mesh on this object only (Copy on write, since the old colors could still be shared with other objects)</summary>
+		void SetColor(size_t face, short col)
 		{
-			return Triangle(vertices[0] + offset, vertices[1] + offset, vertices[2] + offset, color, visibleSides[0], visibleSides[1], visibleSides[2]);
+			std::shared_ptr<std::vector<short>> edited = std::make_shared<std::vector<short>>(colors ? *colors : mesh->colors);
+			(*edited)[face] = col;
+			colors = edited;
 		}
-	};
-
-	struct Mesh
-	{
-		std::vector<Triangle> triangles;
-		float radius;
 
-		Mesh(std::vector<Triangle>& triangles = *new std::vector<Triangle>())
+		void RecalculateAABB()
 		{
-			this->triangles = triangles;
-			radius = 0;
-			for (Triangle& t : triangles)
+			aabb[0] = mesh->positions.at(0);
+			aabb[1] = mesh->positions.at(0);
+			for (const cmde::VEC3F& p : mesh->positions)
 			{
-				radius = max(max(radius, Magnitude(t.vertices[0])), max(Magnitude(t.vertices[1]), Magnitude(t.vertices[2])));
+				aabb[0].x = min(aabb[0].x, p.x);
+				aabb[1].x = max(aabb[1].x, p.x);
+				aabb[0].y = min(aabb[0].y, p.y);
+				aabb[1].y = max(aabb[1].y, p.y);
+				aabb[0].z = min(aabb[0].z, p.z);
+				aabb[1].z = max(aabb[1].z, p.z);
 			}
+			UpdateWorld();
 		}
 
-		void ChangeColor(short col)
+						/// <summary>Coroutine version of RecalculateAABB() for big meshes, checking the task budget every 'ASYNC_STRIDE' positions (The object must outlive the task)</summary>
+		cmde::TASK RecalculateAABBAsync()
 		{
-			for (Triangle& t : triangles)
+			if (mesh->positions.size() == 0)
+			{
+				co_return;
+			}
+			cmde::VEC3F bounds[2] = { mesh->positions[0], mesh->positions[0] };
+			for (size_t j = 0; j < mesh->positions.size(); j++)
 			{
-				t.color = col;
+				const cmde::VEC3F& p = mesh->positions[j];
+				bounds[0].x = min(bounds[0].x, p.x);
+				bounds[1].x = max(bounds[1].x, p.x);
+				bounds[0].y = min(bounds[0].y, p.y);
+				bounds[1].y = max(bounds[1].y, p.y);
+				bounds[0].z = min(bounds[0].z, p.z);
+				bounds[1].z = max(bounds[1].z, p.z);
+				if (j % ASYNC_STRIDE == ASYNC_STRIDE - 1)
+				{
+					co_await cmde::TASKSCHEDULER::Checkpoint();
+				}
 			}
+			//Only written at the end, so the object never has a half-computed box
+			aabb[0] = bounds[0];
+			aabb[1] = bounds[1];
+			UpdateWorld();
 		}
+
+						/// <summary>Picks the level of detail to draw the object with when it covers 'cells' screen cells (See Mesh::PickLod())</summary>
+		size_t PickLod(float cells) { return lod = mesh->PickLod(lod, cells); }
 	};
 
-	struct Object
+	//Refers to 1 of a Scene's objects, and keeps referring to it however the scene's arrays get shuffled around
+	//	Removing the object bumps its slot's generation, so old handles stop matching instead of referring to whatever gets the slot next
+	struct ObjectHandle
 	{
-		Mesh mesh;
-		cmde::VEC3F position;
-		cmde::VEC3F aabb[2];
+		unsigned int slot;
+		unsigned int generation;
+
+		ObjectHandle() { slot = UINT_MAX; generation = 0; }
+
+		bool operator==(const ObjectHandle& other) const { return slot == other.slot && generation == other.generation; }
+		bool operator!=(const ObjectHandle& other) const { return !(*this == other); }
+	};
 
-		Object(Mesh& m = *new Mesh(), cmde::VEC3F pos = { 0, 0, 0 })
+	//The objects in the world, stored as 1 packed array per component instead of 1 array of Objects, so that a pass that only needs 1 component
+	//	(Like the bounding spheres for culling, or the transforms for updating) sweeps straight through it without dragging the rest of every object through the cache
+	//The arrays are indexed by an object's place in the scene (See Index()), which shifts down when an object before it is removed, so anything kept between frames should hold an ObjectHandle
+	//	Only the main thread touches the scene; the render stage draws from the packet Update() copied out of it, which holds its own references to the meshes and colors,
+	//	so giving an object a different mesh or colors never frees the ones still being drawn (Meshes and color lists are never changed in place, only replaced)
+	struct Scene
+	{
+		enum Flag : unsigned char
 		{
-			mesh = m;
-			position = pos;
-			if (mesh.triangles.size() > 0)
+			//Gets drawn
+			VISIBLE = 1,
+			//Can be hit by RaycastAll()
+			RAYCASTABLE = 2
+		};
+
+		std::vector<ObjectHandle> handles;
+		//Flag bits
+		std::vector<unsigned char> flags;
+		//What each object draws (See Object::mesh and Object::colors), and the level of detail it was last drawn with
+		std::vector<std::shared_ptr<const Mesh>> meshes;
+		std::vector<std::shared_ptr<const std::vector<short>>> colors;
+		std::vector<size_t> lods;
+		//Transforms, relative to the parent (Which is the index of an earlier object, or -1 for none; Parents come before their children, so that 1 pass in order updates them all)
+		std::vector<cmde::VEC3F> positions;
+		std::vector<cmde::VEC3F> rotations;
+		std::vector<float> scales;
+		std::vector<int> parents;
+		//Whether the transform or the mesh changed since the last UpdateTransforms(), and whether the last UpdateTransforms() changed 'worlds' (The children have to be updated too)
+		std::vector<unsigned char> dirty;
+		std::vector<unsigned char> moved;
+		std::vector<WorldTransform> worlds;
+		//The mesh's bounding box in its own space (2 corners per object), and the bounding sphere in the world (Center in xyz, radius in w)
+		//	The spheres are a copy of what's in 'worlds', kept apart so that culling only reads 16 bytes per object
+		std::vector<cmde::VEC3F> boxes;
+		std::vector<cmde::VEC4F> spheres;
+
+	private:
+		//Per slot, the index of its object (UINT_MAX while it's free) and how many objects have had it before
+		std::vector<unsigned int> slotIndices;
+		std::vector<unsigned int> slotGenerations;
+		std::vector<unsigned int> freeSlots;
+
+	public:
+		size_t Size() const { return handles.size(); }
+		bool Valid(ObjectHandle object) const { return object.slot < slotIndices.size() && slotGenerations[object.slot] == object.generation && slotIndices[object.slot] != UINT_MAX; }
+						/// <summary>Where the object is in the arrays (UINT_MAX for handles that don't refer to anything)</summary>
+		unsigned int Index(ObjectHandle object) const { return (Valid(object) ? slotIndices[object.slot] : UINT_MAX); }
+
+						/// <summary>Adds a copy of 'object' to the end of the scene, attached to 'parent' (None by default) so that its transform is relative to the parent's</summary>
+		ObjectHandle Add(const Object& object, ObjectHandle parent = ObjectHandle(), unsigned char flag = VISIBLE | RAYCASTABLE)
+		{
+			ObjectHandle added;
+			if (freeSlots.empty())
 			{
-				RecalculateAABB();
+				added.slot = (unsigned int)slotIndices.size();
+				slotIndices.push_back(0);
+				slotGenerations.push_back(0);
+			}
+			else
+			{
+				added.slot = freeSlots.back();
+				freeSlots.pop_back();
 			}
+			added.generation = slotGenerations[added.slot];
+			unsigned int parentIndex = Index(parent);
+			slotIndices[added.slot] = (unsigned int)handles.size();
+			handles.push_back(added);
+			flags.push_back(flag);
+			meshes.push_back(object.mesh);
+			colors.push_back(object.colors);
+			lods.push_back(object.lod);
+			positions.push_back(object.position);
+			rotations.push_back(object.rotation);
+			scales.push_back(object.scale);
+			parents.push_back(parentIndex == UINT_MAX ? -1 : (int)parentIndex);
+			dirty.push_back(true);
+			moved.push_back(false);
+			worlds.push_back(object.world);
+			boxes.push_back(object.aabb[0]);
+			boxes.push_back(object.aabb[1]);
+			spheres.push_back(object.world.Position() + cmde::VEC4F(0, 0, 0, object.world.radius));
+			return added;
 		}
 
-		void RecalculateAABB()
+						/// <summary>Removes the object, keeping the rest in the same order (Anything attached to it gets detached, so its transform is then relative to the world)</summary>
+		void Remove(ObjectHandle object)
 		{
-			aabb[0] = mesh.triangles.at(0).vertices[0];
-			aabb[1] = mesh.triangles.at(0).vertices[0];
-			for (Triangle& t : mesh.triangles)
+			unsigned int index = Index(object);
+			if (index == UINT_MAX)
+				return;
+			//Not swapped with the last object, since parents have to stay before their children
+			auto erase = [index](auto& items, size_t stride = 1) { items.erase(items.begin() + index * stride, items.begin() + (index + 1) * stride); };
+			erase(handles);
+			erase(flags);
+			erase(meshes);
+			erase(colors);
+			erase(lods);
+			erase(positions);
+			erase(rotations);
+			erase(scales);
+			erase(parents);
+			erase(dirty);
+			erase(moved);
+			erase(worlds);
+			erase(boxes, 2);
+			erase(spheres);
+			for (size_t i = index; i < handles.size(); i++)
 			{
-				for (int i = 0; i < 3; i++)
+				slotIndices[handles[i].slot] = (unsigned int)i;
+				if (parents[i] == (int)index)
 				{
-					aabb[0].x = min(aabb[0].x, t.vertices[i].x);
-					aabb[1].x = max(aabb[1].x, t.vertices[i].x);
-					aabb[0].y = min(aabb[0].y, t.vertices[i].y);
-					aabb[1].y = max(aabb[1].y, t.vertices[i].y);
-					aabb[0].z = min(aabb[0].z, t.vertices[i].z);
-					aabb[1].z = max(aabb[1].z, t.vertices[i].z);
+					parents[i] = -1;
+					dirty[i] = true;
 				}
+				else if (parents[i] > (int)index)
+				{
+					parents[i]--;
+				}
+			}
+			slotIndices[object.slot] = UINT_MAX;
+			slotGenerations[object.slot]++;
+			freeSlots.push_back(object.slot);
+		}
+
+		void SetPosition(ObjectHandle object, cmde::VEC3F pos) { unsigned int i = Index(object); if (i != UINT_MAX) { positions[i] = pos; dirty[i] = true; } }
+		void SetRotation(ObjectHandle object, cmde::VEC3F rot) { unsigned int i = Index(object); if (i != UINT_MAX) { rotations[i] = rot; dirty[i] = true; } }
+						/// <summary>Scales the object by the same amount along every axis (Must be above 0)</summary>
+		void SetScale(ObjectHandle object, float s) { unsigned int i = Index(object); if (i != UINT_MAX) { scales[i] = s; dirty[i] = true; } }
+		void SetFlags(ObjectHandle object, unsigned char flag) { unsigned int i = Index(object); if (i != UINT_MAX) { flags[i] = flag; } }
+
+						/// <summary>Attaches the object to 'parent' (Which has to come before it in the scene, otherwise nothing changes; An invalid handle detaches it), keeping its transform as is, so that it's now relative to the parent</summary>
+		void SetParent(ObjectHandle object, ObjectHandle parent)
+		{
+			unsigned int i = Index(object);
+			if (i == UINT_MAX)
+				return;
+			unsigned int parentIndex = Index(parent);
+			//UpdateTransforms() goes through the objects in order, so a parent at or after its child wouldn't be up to date yet when the child reads it
+			if (parentIndex != UINT_MAX && parentIndex >= i)
+				return;
+			parents[i] = (parentIndex == UINT_MAX ? -1 : (int)parentIndex);
+			dirty[i] = true;
+		}
+
+						/// <summary>Swaps in a different mesh with the bounding box 'box' (In its own space), dropping the object's own colors since they were for the old mesh's faces</summary>
+		void SetMesh(ObjectHandle object, std::shared_ptr<const Mesh> mesh, const cmde::VEC3F box[2])
+		{
+			unsigned int i = Index(object);
+			if (i == UINT_MAX)
+				return;
+			meshes[i] = mesh;
+			colors[i] = nullptr;
+			lods[i] = 0;
+			boxes[i * 2] = box[0];
+			boxes[i * 2 + 1] = box[1];
+			dirty[i] = true;
+		}
+
+						/// <summary>Changes the color of face 'face' of the full mesh on this object only (Copy on write, see Object::SetColor())</summary>
+		void SetColor(ObjectHandle object, size_t face, short col)
+		{
+			unsigned int i = Index(object);
+			if (i == UINT_MAX)
+				return;
+			std::shared_ptr<std::vector<short>> edited = std::make_shared<std::vector<short>>(colors[i] ? *colors[i] : meshes[i]->colors);
+			(*edited)[face] = col;
+			colors[i] = edited;
+		}
+
+						/// <summary>Brings every object's world transform and bounding sphere up to date in 1 pass in order, only recalculating the objects that changed and the ones attached to them</summary>
+		void UpdateTransforms()
+		{
+			for (size_t i = 0; i < handles.size(); i++)
+			{
+				int parent = parents[i];
+				moved[i] = dirty[i] || (parent >= 0 && moved[parent]);
+				if (!moved[i])
+					continue;
+				worlds[i] = WorldTransform::Build(positions[i], rotations[i], scales[i], (parent >= 0 ? &worlds[parent] : nullptr), &boxes[i * 2], meshes[i]->radius);
+				spheres[i] = worlds[i].Position() + cmde::VEC4F(0, 0, 0, worlds[i].radius);
+				dirty[i] = false;
 			}
 		}
 	};
@@ -1719,11 +4970,16 @@ class Test3D : public cmde::CMDEngine
 			}
 		}
 
-		static bool Export(cmde::FILE& exportFile, Mesh mesh)
+		static bool Export(cmde::FILE& exportFile, const Mesh& mesh, const std::vector<short>* colors = nullptr)
 		{
 			wchar_t lineBuffer[cmde::FILE::CHUNK_SIZE] = { 0 };
-			for (Triangle& t : mesh.triangles)
+			for (size_t f = 0; f < mesh.FaceCount(); f++)
 			{
+				Triangle t = mesh.GetTriangle(f);
+				if (colors)
+				{
+					t.color = (*colors)[f];
+				}
 				//UTF-8 Version
 				DWORD writeCount = swprintf(lineBuffer, cmde::FILE::CHUNK_SIZE,
 					L"(%c%011f %c%011f %c%011f) ; (%c%011f %c%011f %c%011f) ; (%c%011f %c%011f %c%011f) #0x%04hx\n",
@@ -1768,28 +5024,120 @@ class Test3D : public cmde::CMDEngine
 		}
 	};
 
+	//What the render stage needs to draw 1 object, copied out of the scene by Update()
+	//	The mesh itself isn't copied, only shared, so it stays alive for as long as the packet does even if the scene moves on to another one
+	struct DrawCommand
+	{
+		ObjectHandle object;
+		//The object's full mesh and its own colors (See Object::colors)
+		std::shared_ptr<const Mesh> mesh;
+		std::shared_ptr<const std::vector<short>> colors;
+		WorldTransform world;
+		//The mesh's bounding box in its own space (For raycasts, which go into the mesh's space)
+		cmde::VEC3F box[2];
+		//Which of the mesh's levels of detail gets drawn (Raycasts still use the full mesh)
+		size_t lod;
+		//Roughly how many screen cells it covers (See Camera::CoveredCells())
+		float cells;
+
+						/// <summary>The color face 'face' of the full mesh gets drawn with on this object</summary>
+		short Color(size_t face) const { return (colors ? (*colors)[face] : mesh->colors[face]); }
+	};
+
+	//1 face of 1 of a render packet's objects (Lets a pass work on a few faces without copying them out of their meshes)
+	struct FaceRef
+	{
+		//Index into the packet's draw commands
+		unsigned int draw;
+		unsigned int face;
+	};
+
+	//How far past the screen's sides triangles can reach (As a multiple of the screen's size) before they're actually cut, instead of being left to the rasterizer's clip rect
+	static constexpr float GUARD_BAND = 4.0f;
+
+	//What CullObject() found out about an object (CULL_OCCLUDED only ever comes from DrawGeometry()'s occlusion test)
+	enum CullResult { CULL_OUTSIDE, CULL_INSIDE, CULL_INTERSECTING, CULL_OCCLUDED, CULL_RESULT_COUNT };
+
+	//DrawGeometry() draws up to 'OCCLUDER_COUNT' of the biggest objects that cover at least 'OCCLUDER_MIN_COVERAGE' of the screen first, and then skips the objects hidden behind them
+	static const int OCCLUDER_COUNT = 4;
+	static constexpr float OCCLUDER_MIN_COVERAGE = 0.02f;
+	//How many frames an object that passed the occlusion test gets drawn for before it's tested again (Hidden objects get tested every frame, so nothing stays hidden after it comes into view)
+	static const unsigned char OCCLUSION_REUSE_FRAMES = 4;
+	//With depth sorting on, DrawGeometry() draws objects nearest first, and so does the clipper with the meshlets of meshes that have at least 'SORT_MIN_MESHLETS' of them, so the depth test throws out more of what's behind instead of it getting drawn and then drawn over
+	//	An order only changes when the camera turns (Moving shifts every depth by the same amount), so it's kept until the camera has turned more than 'SORT_REUSE_ANGLE' degrees since (Objects are also re-sorted every 'SORT_REUSE_FRAMES' frames, since they can move)
+	static const size_t SORT_MIN_MESHLETS = 8;
+	static constexpr float SORT_REUSE_ANGLE = 5.0f;
+	static const unsigned char SORT_REUSE_FRAMES = 8;
+
+	//A face, or a piece of one, that made it through clipping
+	struct ClippedFace
+	{
+		//Point into ClippedMesh::vertices
+		unsigned int corners[3];
+		//The mesh face it came from (For the normal and color)
+		unsigned int face;
+		//Same as Mesh::edges, but the sides made by cutting the face are always hidden
+		unsigned char edges;
+	};
+
+	//What's left of a mesh after ClipTriangles(), with the faces pointing into 'vertices' instead of each holding its own copy
+	//	Kept between frames so that the buffers only grow (Once they're big enough, clipping doesn't allocate anything)
+	struct ClippedMesh
+	{
+		const Mesh* mesh = nullptr;
+		//The object's colors to use instead of the mesh's (See Object::colors), and where the mesh was placed
+		const std::vector<short>* colors = nullptr;
+		WorldTransform world;
+		//The mesh's positions moved into place, followed by the corners made by cutting faces (Only faces that cross the near plane or the guard band add any)
+		std::vector<cmde::VEC3F> vertices;
+		std::vector<ClippedFace> faces;
+		//Per mesh position, bit 'i' is set if it's outside clipping plane 'i' (See ClipTriangles())
+		std::vector<unsigned short> outcodes;
+		//How many faces were skipped without being looked at, because their whole meshlet was off-screen or facing away
+		unsigned int skippedFaces = 0;
+		//The order 'sortedMesh''s meshlets were last drawn in, nearest first along 'sortedFacing' (See SortMeshlets()), and the buffers for sorting them
+		std::vector<unsigned int> meshletOrder;
+		std::vector<unsigned int> sortScratch;
+		std::vector<unsigned short> sortKeys;
+		const Mesh* sortedMesh = nullptr;
+		cmde::VEC3F sortedFacing;
+	};
+
 	struct RaycastHit
 	{
 		PLANE plane;
-		Object* object;
-		Triangle* triangle;
-		wchar_t error[128];
+		//The object that was hit (Invalid for objects that aren't in a scene), and the mesh and colors it was hit with, so the hit's color doesn't have to be looked up in the scene
+		ObjectHandle object;
+		std::shared_ptr<const Mesh> mesh;
+		std::shared_ptr<const std::vector<short>> colors;
+		//Index of the face that was hit in the object's mesh
+		size_t face;
 
-		RaycastHit() { object = new Object(); triangle = new Triangle({ cmde::VEC3F(), cmde::VEC3F(), cmde::VEC3F() }); }
+		RaycastHit() { face = 0; }
 
-		RaycastHit(PLANE p, Object* o, Triangle* t) { plane = p; object = o; triangle = t; }
+		RaycastHit(PLANE p, ObjectHandle o, const std::shared_ptr<const Mesh>& m, const std::shared_ptr<const std::vector<short>>& c, size_t f) { plane = p; object = o; mesh = m; colors = c; face = f; }
+
+		short Color() { return (colors ? (*colors)[face] : mesh->colors[face]); }
 
 		/// <summary>
 		/// Casts a ray and detects the first plane of the objects with which it intersects
 		/// </summary>
 		/// <param name="origin">The point from ray starts at</param>
 		/// <param name="direction">The direction the ray goes</param>
-		/// <param name="objects">The objects to test against</param>
-		bool Raycast(cmde::VEC3F origin, cmde::VEC3F direction, std::vector<Object>& objects, std::vector<Object*>& ignore = *new std::vector<Object*>())
+		/// <param name="scene">The objects to test against</param>
+		/// <param name="arena">Where the list of hits is kept while they're compared</param>
+		/// <param name="ignore">Objects to skip (Optional)</param>
+		bool Raycast(cmde::VEC3F origin, cmde::VEC3F direction, const Scene& scene, cmde::FRAMEARENA& arena, const std::vector<ObjectHandle>* ignore = nullptr)
 		{
 			Test3D::rayCount++;
-			std::vector<RaycastHit> hits = std::vector<RaycastHit>();
-			RaycastAll(origin, direction, objects, &hits, ignore);
+			cmde::ARENAVECTOR<RaycastHit> hits(arena);
+			RaycastAll(origin, direction, scene, &hits, ignore);
+			return Nearest(origin, hits);
+		}
+
+		//Keeps whichever hit is closest to 'origin'
+		bool Nearest(cmde::VEC3F origin, cmde::ARENAVECTOR<RaycastHit>& hits)
+		{
 			float distance = -1;
 			for (RaycastHit& p : hits)
 			{
@@ -1798,14 +5146,60 @@ class Test3D : public cmde::CMDEngine
 				{
 					distance = tempDist;
 
-					plane = p.plane;
-					object = p.object;
-					triangle = p.triangle;
+					*this = p;
 				}
 			}
 			return hits.size() > 0;
 		}
 
+		/// <summary>Casts a ray and detects the first plane of the objects in a render packet with which it intersects</summary> /// <param name="origin">The point from ray starts at</param> /// <param name="direction">The direction the ray goes</param> /// <param name="draws">The draw commands of the objects to test against</param> /// <param name="arena">Where the list of hits is kept while they're compared</param>
+		bool Raycast(cmde::VEC3F origin, cmde::VEC3F direction, std::vector<DrawCommand>& draws, cmde::FRAMEARENA& arena)
+		{
+			Test3D::rayCount++;
+			cmde::ARENAVECTOR<RaycastHit> hits(arena);
+			RaycastAll(origin, direction, draws, &hits);
+			return Nearest(origin, hits);
+		}
+
+		/// <summary>Casts a ray and detects the first of the listed faces of a render packet's objects with which it intersects</summary> /// <param name="origin">The point from ray starts at</param> /// <param name="direction">The direction the ray goes</param> /// <param name="draws">The draw commands the faces belong to</param> /// <param name="faces">The faces to test against</param>
+		bool Raycast(cmde::VEC3F origin, cmde::VEC3F direction, std::vector<DrawCommand>& draws, cmde::ARENAVECTOR<FaceRef>& faces)
+		{
+			Test3D::rayCount++;
+			direction = Normalize(direction);
+			cmde::VEC3F point = cmde::VEC3F();
+			float distance = -1;
+			//The ray goes into the mesh's space instead of the face coming out of it, once per object, since the faces come grouped by draw command (See Mirrors())
+			unsigned int localDraw = UINT_MAX;
+			cmde::VEC3F localOrigin;
+			cmde::VEC3F localDirection;
+			for (FaceRef& r : faces)
+			{
+				DrawCommand& d = draws[r.draw];
+				if (r.draw != localDraw)
+				{
+					localDraw = r.draw;
+					localOrigin = d.world.ToLocal(origin);
+					localDirection = d.world.DirectionToLocal(direction);
+				}
+				if (RayHitsFace(*d.mesh, r.face, localOrigin, localDirection, &point))
+				{
+					point = d.world.ToWorld(point);
+					float tempDist = Magnitude(point - origin);
+					if (tempDist < distance || distance < 0)
+					{
+						distance = tempDist;
+
+						plane = PLANE(point, d.world.NormalToWorld(d.mesh->normals[r.face]));
+						object = d.object;
+						mesh = d.mesh;
+						colors = d.colors;
+						face = r.face;
+					}
+				}
+			}
+			return distance >= 0;
+		}
+
 		/// <summary>
 		/// Casts a ray and detects the first plane of the objects with which it intersects
 		/// </summary>
@@ -1815,43 +5209,39 @@ class Test3D : public cmde::CMDEngine
 		bool Raycast(cmde::VEC3F origin, cmde::VEC3F direction, Object& obj)
 		{
 			Test3D::rayCount++;
-			std::vector<RaycastHit> hits = std::vector<RaycastHit>();
 
 			direction = Normalize(direction);
 			cmde::VEC3F nearest;
-			Triangle tOff = { cmde::VEC3F(), cmde::VEC3F(), cmde::VEC3F() };
 			cmde::VEC3F point = cmde::VEC3F();
-			nearest = origin + direction * DotProduct(obj.position - origin, direction) - obj.position;
-			if (Pow2(obj.mesh.radius) >= DotProduct(nearest, nearest))
+			float distance = -1;
+			cmde::VEC3F center = obj.world.Position();
+			nearest = origin + direction * DotProduct(center - origin, direction) - center;
+			if (Pow2(obj.world.radius) >= DotProduct(nearest, nearest))
 			{
 				//Ray passes through this object's bounding sphere (Could possibly collide)
-				for (Triangle& t : obj.mesh.triangles)
+				cmde::VEC3F localOrigin = obj.world.ToLocal(origin);
+				cmde::VEC3F localDirection = obj.world.DirectionToLocal(direction);
+				for (size_t f = 0; f < obj.mesh->FaceCount(); f++)
 				{
-					if (DotProduct(t.normal, direction) < 0)
+					if (RayHitsFace(*obj.mesh, f, localOrigin, localDirection, &point))
 					{
-						tOff = Triangle(t.vertices[0] + obj.position, t.vertices[1] + obj.position, t.vertices[2] + obj.position);
-						if (RayPlaneIntersection(PLANE(tOff.vertices[0], tOff.normal), origin, direction, &point) && PointInTriangle(point, tOff))
+						//Only the nearest hit is needed, so there's no list of them to keep
+						point = obj.world.ToWorld(point);
+						float tempDist = Magnitude(point - origin);
+						if (tempDist < distance || distance < 0)
 						{
-							hits.push_back(RaycastHit(PLANE(point, tOff.normal), &obj, &t));
+							distance = tempDist;
+
+							plane = PLANE(point, obj.world.NormalToWorld(obj.mesh->normals[f]));
+							object = ObjectHandle();
+							mesh = obj.mesh;
+							colors = obj.colors;
+							face = f;
 						}
 					}
 				}
 			}
-
-			float distance = -1;
-			for (RaycastHit& p : hits)
-			{
-				float tempDist = Magnitude(p.plane.point - origin);
-				if (tempDist < distance || distance < 0)
-				{
-					distance = tempDist;
-
-					plane = p.plane;
-					object = p.object;
-					triangle = p.triangle;
-				}
-			}
-			return hits.size() > 0;
+			return distance >= 0;
 		}
 	};
 
@@ -1867,13 +5257,26 @@ class Test3D : public cmde::CMDEngine
 		cmde::VEC2F fov;
 		float nearPlane;
 		float farPlane;
-		PLANE* inBounds;
+		//The 4 sides, the near plane and the far plane, all facing inwards (Rebuilt by Update() when the camera moves or turns)
+		PLANE inBounds[6];
+		//The part of the engine's screen the camera draws into, edges included (See SetViewport())
+		SMALL_RECT viewport;
+		//The viewport's size
 		COORD screenSize;
 		CMDEngine* engine;
 		float divideFarMinusNear;
 		float aspectRatio;
 		float f1;
 		float f2;
+		//World space to camera space (x along 'left', y along 'up', z along 'forwards'), rebuilt by UpdateRotation()
+		cmde::MAT4 view;
+		//World space straight to screen cells (x and y still need dividing by w, z is the depth), rebuilt by UpdateRotation()
+		cmde::MAT4 viewProjection;
+		//Set when something 'inBounds' and the matrices are built from changes, other than the position and facing (Update() notices those by itself)
+		bool dirty;
+		//The position and facing the last Update() built everything for
+		cmde::VEC3F builtPosition;
+		cmde::VEC2F builtFacing;
 		//static std::vector<cmde::VEC3F> mirrorPoints;
 
 						///<summary>There must be a default constructor or computer gets mad (This should be unusable though)</summary>
@@ -1881,8 +5284,10 @@ class Test3D : public cmde::CMDEngine
 		{
 			farPlane = -1;
 			nearPlane = -1;
+			viewport = SMALL_RECT();
 			screenSize = COORD();
-			UpdateInBounds();
+			engine = nullptr;
+			dirty = true;
 		}
 
 		Camera(cmde::VEC3F position, cmde::VEC2F facing, cmde::VEC2F fov, float nearPlane, float farPlane, CMDEngine* engine)
@@ -1891,60 +5296,125 @@ class Test3D : public cmde::CMDEngine
 			this->fov = fov;
 			this->nearPlane = nearPlane;
 			this->farPlane = farPlane;
-			this->screenSize = engine->screenSize;
 			this->engine = engine;
 			this->divideFarMinusNear = 1 / (farPlane - nearPlane);
-			this->aspectRatio = (float)screenSize.Y / (float)screenSize.X;
-			this->f1 = aspectRatio / tanf(fov.x * 0.5f * RAD);
 			this->f2 = 1.0f / tanf(fov.y * 0.5f * RAD);
-			UpdateInBounds();
+			this->facing = facing;
+			SetViewport({ 0, 0, (short)(engine->screenSize.X - 1), (short)(engine->screenSize.Y - 1) });
+			Update();
+		}
+
+						///<summary>Makes the camera draw into just the cells in 'area' of the screen (Edges included), with the image squeezed to fit its shape</summary>
+		void SetViewport(SMALL_RECT area)
+		{
+			viewport = area;
+			screenSize = { (short)(area.Right - area.Left + 1), (short)(area.Bottom - area.Top + 1) };
+			aspectRatio = (float)screenSize.Y / (float)screenSize.X;
+			f1 = aspectRatio / tanf(fov.x * 0.5f * RAD);
+			dirty = true;
+		}
+
+						///<summary>Rebuilds the camera's axes, matrices and 'inBounds' if it has moved or turned (Or been marked 'dirty') since the last time, so it's cheap to call as often as needed</summary>
+		void Update()
+		{
+			if (!dirty && position == builtPosition && facing == builtFacing)
+				return;
+			//The planes are built from the axes, so the rotation goes first
 			UpdateRotation();
+			UpdateInBounds();
+			builtPosition = position;
+			builtFacing = facing;
+			dirty = false;
 		}
 
 		void UpdateInBounds()
 		{
 			cmde::VEC3F slr = left * -sin(fov.x * 0.5f * RAD) + forwards * cos(fov.x * 0.5f * RAD);
 			cmde::VEC3F slb = up * -sin(fov.x * 0.5f * RAD) + forwards * cos(fov.x * 0.5f * RAD);
-			inBounds = new PLANE[]{ { position, CrossProduct(sightLimitL, up) }, { position, CrossProduct(left, sightLimitT) }, { position, CrossProduct(up, slr) }, { position, CrossProduct(slb, left) }, { forwards * nearPlane + position, forwards }, { forwards * farPlane + position, forwards * -1 } };
+			inBounds[0] = { position, CrossProduct(sightLimitL, up) };
+			inBounds[1] = { position, CrossProduct(left, sightLimitT) };
+			inBounds[2] = { position, CrossProduct(up, slr) };
+			inBounds[3] = { position, CrossProduct(slb, left) };
+			inBounds[4] = { forwards * nearPlane + position, forwards };
+			inBounds[5] = { forwards * farPlane + position, forwards * -1 };
+		}
+
+						///<summary>Roughly how many screen cells a sphere at 'center' covers (The whole screen if the camera is inside it)</summary>
+		float CoveredCells(cmde::VEC3F center, float radius) const
+		{
+			float screen = (float)screenSize.X * screenSize.Y;
+			float distance = Magnitude(center - position);
+			if (distance <= radius)
+				return screen;
+			//Same scaling the projection matrix gives the x and y axes, with the radius at the sphere's distance
+			float across = radius / distance;
+			return min(PI * (across * f1 * screenSize.X * 0.5f) * (across * f2 * screenSize.Y * 0.5f), screen);
+		}
+
+						///<summary>Whether the box from 'low' to 'high' is entirely behind what 'occlusion' was built from (Never if any corner is closer than the near plane, since those can't be projected)</summary>
+		bool BoxOccluded(cmde::VEC3F low, cmde::VEC3F high, const cmde::OCCLUSIONBUFFER& occlusion) const
+		{
+			float left = FLT_MAX, top = FLT_MAX, right = -FLT_MAX, bottom = -FLT_MAX, nearest = FLT_MAX;
+			for (int i = 0; i < 8; i++)
+			{
+				cmde::VEC4F corner = viewProjection * cmde::VEC4F((i & 1 ? high.x : low.x), (i & 2 ? high.y : low.y), (i & 4 ? high.z : low.z), 1);
+				//w is minus the distance in front of the camera
+				if (-corner.w < nearPlane)
+					return false;
+				float divideW = 1.0f / corner.w;
+				left = min(left, corner.x * divideW);
+				right = max(right, corner.x * divideW);
+				top = min(top, corner.y * divideW);
+				bottom = max(bottom, corner.y * divideW);
+				nearest = min(nearest, corner.z);
+			}
+			return occlusion.Occluded(left, top, right, bottom, nearest);
 		}
 
 		void RenderShapeSpherical(Object& obj, bool wireframe = false)
 		{
-			UpdateInBounds();
-			std::vector<Triangle> newTriangles = ClipTriangles(obj, position, inBounds);
-			for (Triangle& t : newTriangles)
+			Update();
+			static thread_local ClippedMesh clipped;
+			ClipTriangles(obj, inBounds, &clipped);
+			DrawSpherical(clipped, wireframe);
+		}
+
+						///<summary>Draws a mesh that has already been clipped to 'inBounds' (Lets the clipping happen elsewhere, like on other threads), only inside 'viewport'</summary>
+		void DrawSpherical(ClippedMesh& clipped, bool wireframe = false)
+		{
+			//Kept between calls the same way as DrawProjection()'s (See there)
+			static thread_local std::vector<cmde::VEC4F> points;
+			//Like DrawProjection(), every vertex gets projected once and then the faces just read them back
+			points.resize(clipped.vertices.size());
+			for (size_t i = 0; i < points.size(); i++)
+			{
+				points[i] = clipped.vertices[i] + cmde::VEC4F(0, 0, 0, 1);
+			}
+			ProjectSpherical(points.data(), points.data(), points.size());
+
+			for (ClippedFace& f : clipped.faces)
 			{
-				if (DotProduct(CrossProduct(t.vertices[1] - t.vertices[0], t.vertices[2] - t.vertices[0]), t.vertices[0] - position) > 0)
+				cmde::VEC3F t[3] = { clipped.vertices[f.corners[0]], clipped.vertices[f.corners[1]], clipped.vertices[f.corners[2]] };
+				if (DotProduct(CrossProduct(t[1] - t[0], t[2] - t[0]), t[0] - position) > 0)
 				{
 					//Backface culling (This isn't a TODO, skipping the triangle like this is the backface culling)
 					continue;
 				}
-				cmde::VEC3F vertices[3];
-				for (int i = 0; i < 3; i++)
-				{
-					cmde::VEC3F temp = t.vertices[i] - position;
-					cmde::VEC3F hTemp = forwards * DotProduct(temp, forwards);
-					cmde::VEC3F vTemp = hTemp + up * DotProduct(temp, up);
-					hTemp = hTemp + left * DotProduct(temp, left);
-					float hAngle = Angle(hTemp, sightLimitL);
-					float vAngle = Angle(vTemp, sightLimitT);
-
-					vertices[i] = engine->ScreenPosToPoint((hAngle / fov.x), (vAngle / fov.y));
-					vertices[i].z = (Magnitude(temp) - nearPlane) * divideFarMinusNear;
-				}
+				cmde::VEC4F vertices[3] = { points[f.corners[0]], points[f.corners[1]], points[f.corners[2]] };
 				if (wireframe)
 				{
-					short color = (DotProduct(CrossProduct(t.vertices[1] - t.vertices[0], t.vertices[2] - t.vertices[0]), forwards) < 0 ? 0x00EE : 0x00BB);
-					if (t.visibleSides[0])
-						engine->DrawLine(vertices[0], vertices[1], color, 0x2588, vertices[0].z, vertices[1].z);
-					if (t.visibleSides[1])
-						engine->DrawLine(vertices[1], vertices[2], color, 0x2588, vertices[1].z, vertices[2].z);
-					if (t.visibleSides[2])
-						engine->DrawLine(vertices[2], vertices[0], color, 0x2588, vertices[2].z, vertices[0].z);
+					short color = (DotProduct(CrossProduct(t[1] - t[0], t[2] - t[0]), forwards) < 0 ? 0x00EE : 0x00BB);
+					if (f.edges & 1)
+						engine->DrawLineTo(cmde::LAYER_SCREEN, viewport, vertices[0].x, vertices[0].y, vertices[1].x, vertices[1].y, color, 0x2588, vertices[0].z, vertices[1].z);
+					if (f.edges & 2)
+						engine->DrawLineTo(cmde::LAYER_SCREEN, viewport, vertices[1].x, vertices[1].y, vertices[2].x, vertices[2].y, color, 0x2588, vertices[1].z, vertices[2].z);
+					if (f.edges & 4)
+						engine->DrawLineTo(cmde::LAYER_SCREEN, viewport, vertices[2].x, vertices[2].y, vertices[0].x, vertices[0].y, color, 0x2588, vertices[2].z, vertices[0].z);
 				}
 				else
 				{
-					engine->DrawTriangle(vertices[0], vertices[1], vertices[2], t.color, 0x2588, vertices[0].z, vertices[1].z, vertices[2].z);
+					short color = (clipped.colors ? (*clipped.colors)[clipped.mesh->SourceFace(f.face)] : clipped.mesh->colors[f.face]);
+					engine->DrawTriangleTo(cmde::LAYER_SCREEN, viewport, vertices[0], vertices[1], vertices[2], color, 0x2588, vertices[0].z, vertices[1].z, vertices[2].z);
 				}
 			}
 			engine->DrawLine({ 0, 0 }, { 2, 0 });
@@ -1956,38 +5426,59 @@ class Test3D : public cmde::CMDEngine
 
 		void RenderShapeProjection(Object& obj, bool wireframe = false)
 		{
+			Update();
+			static thread_local ClippedMesh clipped;
+			ClipTriangles(obj, inBounds, &clipped);
+			DrawProjection(clipped, wireframe);
+		}
 
-			UpdateInBounds();
-			std::vector<Triangle> newTriangles = ClipTriangles(obj, position, inBounds);
-			cmde::VEC3F temp;
-			cmde::VEC3F vertices[3];
-			for (Triangle &t : newTriangles)
+						///<summary>Draws a mesh that has already been clipped to 'inBounds' (Lets the clipping happen elsewhere, like on other threads) only inside 'viewport', projecting its uncut vertices from 'shared' if it's given and the object is only moved, not turned or scaled (See ProjectShared())</summary>
+		void DrawProjection(ClippedMesh& clipped, bool wireframe = false, const cmde::VEC4F* shared = nullptr)
+		{
+			//Reused between calls so that the buffer only grows (Each thread that draws gets its own; The frame arena is only for what has to last the whole frame)
+			static thread_local std::vector<cmde::VEC4F> points;
+			//Every vertex gets projected once in 1 go, however many faces share it, and then the faces just read them back
+			//	(Vertices that only belonged to clipped away faces get projected too, but nothing reads them)
+			points.resize(clipped.vertices.size());
+			size_t first = 0;
+			if (shared && clipped.world.translationOnly && points.size() >= clipped.mesh->positions.size())
+			{
+				first = clipped.mesh->positions.size();
+				ProjectInstance(shared, clipped.world.Position(), points.data(), first);
+			}
+			//The corners made by cutting faces belong to this object only
+			for (size_t i = first; i < points.size(); i++)
+			{
+				points[i] = clipped.vertices[i] + cmde::VEC4F(0, 0, 0, 1);
+			}
+			Project(points.data() + first, points.data() + first, points.size() - first);
+
+			const Mesh& mesh = *clipped.mesh;
+			for (ClippedFace& f : clipped.faces)
 			{
-				if (DotProduct(t.normal, t.vertices[0] - position) >= 0)
+				cmde::VEC3F& t0 = clipped.vertices[f.corners[0]];
+				//The scale is always above 0, so the normal only needs turning for the sign to come out right
+				cmde::VEC3F normal = (clipped.world.translationOnly ? mesh.normals[f.face] : cmde::VEC3F(clipped.world.matrix * mesh.normals[f.face]));
+				if (DotProduct(normal, t0 - position) >= 0)
 				{
 					//Backface culling (This isn't a TODO, skipping the triangle like this is the backface culling)
 					continue;
 				}
-				for (int i = 0; i < 3; i++)
-				{
-					temp = t.vertices[i] - position;
-					temp = { DotProduct(temp, left), DotProduct(temp, up), DotProduct(temp, forwards) };
-					vertices[i] = (ProjectionMatrixify(temp) + cmde::VEC2F(1, 1)) * 0.5f * cmde::VEC2F(screenSize.X, screenSize.Y);
-					vertices[i].z = (temp.z - nearPlane) * divideFarMinusNear;
-				}
+				cmde::VEC4F vertices[3] = { points[f.corners[0]], points[f.corners[1]], points[f.corners[2]] };
 				if (wireframe)
 				{
-					short color = (DotProduct(CrossProduct(t.vertices[1] - t.vertices[0], t.vertices[2] - t.vertices[0]), forwards) < 0 ? 0x00EE : 0x00BB);
-					if (t.visibleSides[0])
-						engine->DrawLine(vertices[0], vertices[1], color, 0x2588, vertices[0].z, vertices[1].z);
-					if (t.visibleSides[1])
-						engine->DrawLine(vertices[1], vertices[2], color, 0x2588, vertices[1].z, vertices[2].z);
-					if (t.visibleSides[2])
-						engine->DrawLine(vertices[2], vertices[0], color, 0x2588, vertices[2].z, vertices[0].z);
+					short color = (DotProduct(CrossProduct(clipped.vertices[f.corners[1]] - t0, clipped.vertices[f.corners[2]] - t0), forwards) < 0 ? 0x00EE : 0x00BB);
+					if (f.edges & 1)
+						engine->DrawLineTo(cmde::LAYER_SCREEN, viewport, vertices[0].x, vertices[0].y, vertices[1].x, vertices[1].y, color, 0x2588, vertices[0].z, vertices[1].z);
+					if (f.edges & 2)
+						engine->DrawLineTo(cmde::LAYER_SCREEN, viewport, vertices[1].x, vertices[1].y, vertices[2].x, vertices[2].y, color, 0x2588, vertices[1].z, vertices[2].z);
+					if (f.edges & 4)
+						engine->DrawLineTo(cmde::LAYER_SCREEN, viewport, vertices[2].x, vertices[2].y, vertices[0].x, vertices[0].y, color, 0x2588, vertices[2].z, vertices[0].z);
 				}
 				else
 				{
-					engine->DrawTriangle(vertices[0], vertices[1], vertices[2], t.color, 0x2588, vertices[0].z, vertices[1].z, vertices[2].z);
+					short color = (clipped.colors ? (*clipped.colors)[mesh.SourceFace(f.face)] : mesh.colors[f.face]);
+					engine->DrawTriangleTo(cmde::LAYER_SCREEN, viewport, vertices[0], vertices[1], vertices[2], color, 0x2588, vertices[0].z, vertices[1].z, vertices[2].z);
 				}
 			}
 			engine->DrawLine({ 0, 0 }, { 2, 0 });
@@ -1996,6 +5487,92 @@ class Test3D : public cmde::CMDEngine
 			engine->Draw(2.0f, 1.0f);
 		}
 
+						///<summary>Takes world space points (w = 1) to screen cells (x, y) with their depth (z), using 'viewProjection' (The points must be in front of the camera, like after clipping)</summary>
+		void Project(const cmde::VEC4F* input, cmde::VEC4F* output, size_t count)
+		{
+			size_t i = 0;
+#ifdef CMDE_SIMD_MATH
+			//4 points at a time, turned sideways so that the perspective divide is done for all of them together as well
+			__m128 m[16];
+			viewProjection.Broadcast(m);
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128 v[4] = { input[i].m, input[i + 1].m, input[i + 2].m, input[i + 3].m };
+				_MM_TRANSPOSE4_PS(v[0], v[1], v[2], v[3]);
+				__m128 r[4];
+				cmde::MAT4::TransformGroup(m, v, r);
+				__m128 divideW = _mm_div_ps(_mm_set1_ps(1.0f), r[3]);
+				r[0] = _mm_mul_ps(r[0], divideW);
+				r[1] = _mm_mul_ps(r[1], divideW);
+				r[3] = _mm_setzero_ps();
+				_MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+				output[i].m = r[0];
+				output[i + 1].m = r[1];
+				output[i + 2].m = r[2];
+				output[i + 3].m = r[3];
+			}
+#endif
+			for (; i < count; i++)
+			{
+				cmde::VEC4F clip = viewProjection * input[i];
+				float divideW = 1.0f / clip.w;
+				output[i] = cmde::VEC4F(clip.x * divideW, clip.y * divideW, clip.z, 0);
+			}
+		}
+
+						///<summary>Takes the positions of 'mesh' to clip space without the perspective divide, so that every object drawing the mesh can be projected from them with ProjectInstance()</summary>
+		void ProjectShared(const Mesh& mesh, cmde::VEC4F* output)
+		{
+			for (size_t i = 0; i < mesh.positions.size(); i++)
+			{
+				output[i] = viewProjection * (mesh.positions[i] + cmde::VEC4F(0, 0, 0, 1));
+			}
+		}
+
+						///<summary>Does what Project() does for the first 'count' points of a mesh moved to 'position' (Without being turned or scaled), starting from its ProjectShared() points (Moving a point moves it in clip space by the same amount for all of them, so that's 1 matrix multiply instead of 1 per point)</summary>
+		void ProjectInstance(const cmde::VEC4F* shared, cmde::VEC3F position, cmde::VEC4F* output, size_t count)
+		{
+			//A VEC3F's w is 0, so this is only the move
+			cmde::VEC4F offset = viewProjection * position;
+			for (size_t i = 0; i < count; i++)
+			{
+				cmde::VEC4F clip = shared[i] + offset;
+				float divideW = 1.0f / clip.w;
+				output[i] = cmde::VEC4F(clip.x * divideW, clip.y * divideW, clip.z, 0);
+			}
+		}
+
+						///<summary>Takes world space points (w = 1) to screen cells (x, y) with their depth (z) the way the spherical renderer sees them, by their angles from the edges of the view (The points must be in front of the camera, like after clipping)</summary>
+		void ProjectSpherical(const cmde::VEC4F* input, cmde::VEC4F* output, size_t count)
+		{
+			//In camera space the angle from 'forwards' is just atan2() of x (Or y) and z, so nothing needs normalizing, and the angle from the edge is half the fov minus that
+			//	(The top edge is built from fov.x too, like 'sightLimitT')
+			float edge = fov.x * 0.5f;
+			float scaleX = screenSize.X / fov.x;
+			float scaleY = screenSize.Y / fov.y;
+			view.Transform(input, output, count);
+			for (size_t i = 0; i < count; i += 4)
+			{
+				//4 at a time with the components turned sideways, the last group padded out with points straight ahead
+				cmde::VEC4F group[4];
+				size_t groupSize = min(count - i, (size_t)4);
+				for (size_t j = 0; j < 4; j++)
+				{
+					group[j] = (j < groupSize ? output[i + j] : cmde::VEC4F(0, 0, 1, 0));
+				}
+				cmde::VEC4F x = { group[0].x, group[1].x, group[2].x, group[3].x };
+				cmde::VEC4F y = { group[0].y, group[1].y, group[2].y, group[3].y };
+				cmde::VEC4F z = { group[0].z, group[1].z, group[2].z, group[3].z };
+				cmde::VEC4F h = Atan2Fast(x, z) * (float)DEG;
+				cmde::VEC4F v = Atan2Fast(y, z) * (float)DEG;
+				cmde::VEC4F distance = SquareRoots(x * x + y * y + z * z);
+				for (size_t j = 0; j < groupSize; j++)
+				{
+					output[i + j] = cmde::VEC4F((edge - (&h.x)[j]) * scaleX + viewport.Left, (edge - (&v.x)[j]) * scaleY + viewport.Top, ((&distance.x)[j] - nearPlane) * divideFarMinusNear, 0);
+				}
+			}
+		}
+
 		void UpdateRotation()
 		{
 			//X+ is left when Z+ is forwards and Y+ is up
@@ -2004,6 +5581,24 @@ class Test3D : public cmde::CMDEngine
 			up = VectorFromAngles(facing.x, facing.y + 90);		//  0,  1,  0
 			sightLimitL = left * sin(fov.x * 0.5f * RAD) + forwards * cos(fov.x * 0.5f * RAD);
 			sightLimitT = up * sin(fov.x * 0.5f * RAD) + forwards * cos(fov.x * 0.5f * RAD);
+
+			//The view matrix's rows are the camera's axes, so multiplying by it does 3 dot products at once
+			view = cmde::MAT4::FromRows(
+				{ left.x, left.y, left.z, -DotProduct(left, position) },
+				{ up.x, up.y, up.z, -DotProduct(up, position) },
+				{ forwards.x, forwards.y, forwards.z, -DotProduct(forwards, position) },
+				{ 0, 0, 0, 1 }
+			);
+			//Same as ProjectionMatrixify() with w = -z, and the screen mapping ((p + 1) * 0.5 * screenSize + the viewport's corner) folded into the x and y rows so that it also gets divided by w
+			float halfX = screenSize.X * 0.5f;
+			float halfY = screenSize.Y * 0.5f;
+			cmde::MAT4 projection = cmde::MAT4::FromRows(
+				{ f1 * halfX, 0, -halfX - viewport.Left, 0 },
+				{ 0, f2 * halfY, -halfY - viewport.Top, 0 },
+				{ 0, 0, divideFarMinusNear, -nearPlane * divideFarMinusNear },
+				{ 0, 0, -1, 0 }
+			);
+			viewProjection = projection * view;
 		}
 
 		cmde::VEC2F ProjectionMatrixify(cmde::VEC3F v)
@@ -2027,93 +5622,316 @@ class Test3D : public cmde::CMDEngine
 
 	static bool PointInTriangle(cmde::VEC3F point, Triangle& triangle)
 	{
-		return (DotProduct(point - triangle.vertices[0], CrossProduct(triangle.vertices[2] - triangle.vertices[0], triangle.normal)) > 0) &&
-			(DotProduct(point - triangle.vertices[1], CrossProduct(triangle.vertices[0] - triangle.vertices[1], triangle.normal)) > 0) &&
-			(DotProduct(point - triangle.vertices[2], CrossProduct(triangle.vertices[1] - triangle.vertices[2], triangle.normal)) > 0);
+		//All 3 edges get checked at once, since doing them together is cheaper than stopping early at the first one that fails
+		cmde::VEC4F sides = DotProducts(point - triangle.vertices[0], CrossProduct(triangle.vertices[2] - triangle.vertices[0], triangle.normal),
+			point - triangle.vertices[1], CrossProduct(triangle.vertices[0] - triangle.vertices[1], triangle.normal),
+			point - triangle.vertices[2], CrossProduct(triangle.vertices[1] - triangle.vertices[2], triangle.normal));
+		return sides.x > 0 && sides.y > 0 && sides.z > 0;
 	}
 
-	static std::vector<Triangle> ClipTriangles(Object& obj, cmde::VEC3F cameraPos, PLANE inBounds[6])
+					/// <summary>Tests 'count' bounding spheres (Center in xyz, radius in w) against 'inBounds', setting 'outside[i]' for each one that's entirely outside of it (Only a first pass; The rest still need CullObject() to find which planes they cross)</summary>
+	static void CullSpheres(const cmde::VEC4F* spheres, size_t count, PLANE inBounds[6], unsigned char* outside)
 	{
-		std::vector<Triangle> output = std::vector<Triangle>();
-		for (Triangle& t : obj.mesh.triangles)
+		//Each plane's offset along its normal, so that a sphere's distance from it is a dot product away
+		float offsets[6];
+		for (short p = 0; p < 6; p++)
+		{
+			offsets[p] = DotProduct(inBounds[p].point, inBounds[p].normal);
+		}
+		size_t i = 0;
+		//4 spheres at a time, turned sideways so that each part of a vector holds a different sphere
+		for (; i + 4 <= count; i += 4)
+		{
+			cmde::MAT4 group = cmde::MAT4::FromRows(spheres[i], spheres[i + 1], spheres[i + 2], spheres[i + 3]);
+			bool out[4] = { false, false, false, false };
+			for (short p = 0; p < 6; p++)
+			{
+				cmde::VEC3F& n = inBounds[p].normal;
+				//How far each sphere's nearest point is past the plane (Below 0 is outside)
+				cmde::VEC4F reach = group.columns[0] * n.x + group.columns[1] * n.y + group.columns[2] * n.z + group.columns[3] - cmde::VEC4F(offsets[p], offsets[p], offsets[p], offsets[p]);
+				out[0] |= reach.x < 0;
+				out[1] |= reach.y < 0;
+				out[2] |= reach.z < 0;
+				out[3] |= reach.w < 0;
+			}
+			for (short j = 0; j < 4; j++)
+			{
+				outside[i + j] = out[j];
+			}
+		}
+		for (; i < count; i++)
 		{
-			output.push_back(t.GetWithOffset(obj.position));
+			outside[i] = false;
+			for (short p = 0; p < 6; p++)
+			{
+				outside[i] |= DotProduct(cmde::VEC3F(spheres[i]), inBounds[p].normal) - offsets[p] + spheres[i].w < 0;
+			}
 		}
-		ClipTriangles(&output, cameraPos, inBounds);
-		return output;
 	}
 
-	static void ClipTriangles(std::vector<Triangle>* ts, cmde::VEC3F cameraPos, PLANE inBounds[6])
+					/// <summary>Tests 'mesh' placed by 'world' against 'inBounds', with its bounding sphere first and then its bounding box for the planes the sphere crosses. Sets bit 'i' of 'planes' for each plane 'i' the object crosses (The only ones it needs clipping against)</summary>
+	static CullResult CullObject(const Mesh& mesh, const WorldTransform& world, PLANE inBounds[6], unsigned char* planes)
 	{
-		std::vector<Triangle> temp;
+		*planes = 0;
+		if (mesh.FaceCount() == 0)
+			return CULL_OUTSIDE;
+		cmde::VEC3F position = world.Position();
+		cmde::VEC3F low = world.aabb[0];
+		cmde::VEC3F high = world.aabb[1];
 		for (short i = 0; i < 6; i++)
 		{
-			temp = std::vector<Triangle>();
-			for (Triangle& t : *ts)
+			PLANE& p = inBounds[i];
+			float distance = DotProduct(position - p.point, p.normal);
+			if (distance < -world.radius)
+				return CULL_OUTSIDE;
+			if (distance >= world.radius)
+				continue;
+			//The sphere crosses the plane, but the box is usually a tighter fit
+			//	(If the corner furthest along the normal is outside then all of it is, and if the corner furthest against it is inside then all of it is)
+			cmde::VEC3F outer = { (p.normal.x >= 0 ? high.x : low.x), (p.normal.y >= 0 ? high.y : low.y), (p.normal.z >= 0 ? high.z : low.z) };
+			cmde::VEC3F inner = { (p.normal.x >= 0 ? low.x : high.x), (p.normal.y >= 0 ? low.y : high.y), (p.normal.z >= 0 ? low.z : high.z) };
+			if (DotProduct(outer - p.point, p.normal) < 0)
+				return CULL_OUTSIDE;
+			if (DotProduct(inner - p.point, p.normal) < 0)
 			{
-				ClipTriangle(t, inBounds[i], &temp);
+				*planes |= 1 << i;
 			}
-			*ts = temp;
 		}
+		return (*planes == 0 ? CULL_INSIDE : CULL_INTERSECTING);
 	}
 
-	static void ClipTriangle(Triangle& t, PLANE inBounds, std::vector<Triangle>* output)
+	static CullResult ClipTriangles(Object& obj, PLANE inBounds[6], ClippedMesh* output) { return ClipTriangles(obj, obj.world, inBounds, output); }
+
+					/// <summary>Culls an object placed by 'world' against 'inBounds' and then clips level of detail 'lod' of it into 'output' (Objects that are entirely inside skip the clipping, and ones that are entirely outside leave 'output' empty)</summary>
+	static CullResult ClipTriangles(Object& obj, const WorldTransform& world, PLANE inBounds[6], ClippedMesh* output, size_t lod = 0)
 	{
-		bool oob[3] = { false };
-		short c = 0;
-		for (short i = 0; i < 3; i++)
+		unsigned char planes;
+		CullResult result = CullObject(*obj.mesh, world, inBounds, &planes);
+		if (result == CULL_OUTSIDE)
+		{
+			output->mesh = &obj.mesh->Lod(lod);
+			output->vertices.clear();
+			output->faces.clear();
+			output->skippedFaces = 0;
+		}
+		else
+		{
+			ClipTriangles(obj.mesh->Lod(lod), world, inBounds, output, planes);
+		}
+		output->colors = obj.colors.get();
+		return result;
+	}
+
+					/// <summary>Clips 'mesh', placed by 'world', to the planes of 'inBounds' picked by the bits of 'planes' (All 6 by default), replacing whatever 'output' held before (With 'frontToBack' set, big meshes' faces come out nearest meshlet first)</summary>
+	static void ClipTriangles(const Mesh& mesh, const WorldTransform& world, PLANE inBounds[6], ClippedMesh* output, unsigned char planes = 0x3F, bool frontToBack = false)
+	{
+		output->mesh = &mesh;
+		output->colors = nullptr;
+		output->world = world;
+		//Planes 0-5 are 'inBounds', and 6-9 are the sides (0-3) pushed out to the guard band
+		//	A face is thrown away if it's entirely outside any of the first 6, but only the near plane and the guard band actually cut faces
+		//	(Whatever's left past the sides gets skipped by the rasterizer's clip rect, and whatever's past the far plane by the depth test)
+		PLANE clipPlanes[10];
+		for (short i = 0; i < 6; i++)
+		{
+			clipPlanes[i] = inBounds[i];
+		}
+		cmde::VEC3F forwards = inBounds[4].normal;
+		for (short i = 0; i < 4; i++)
+		{
+			//The side planes go through the camera, so widening one is just scaling up the part of its normal along 'forwards'
+			float along = DotProduct(inBounds[i].normal, forwards);
+			clipPlanes[6 + i] = PLANE(inBounds[i].point, forwards * (along * GUARD_BAND) + (inBounds[i].normal - forwards * along));
+		}
+		//A point's distance to a plane is Dot(point, normal) - Dot(planePoint, normal), and the 2nd half is the same for every point
+		float offsets[10];
+		for (short i = 0; i < 10; i++)
+		{
+			offsets[i] = DotProduct(clipPlanes[i].point, clipPlanes[i].normal);
+		}
+		//An object that doesn't cross a side plane can't cross its guard band either
+		unsigned short active = (unsigned short)(planes | (planes & 0x0F) << 6);
+		short activePlanes[10];
+		short activeCount = 0;
+		for (short i = 0; i < 10; i++)
+		{
+			if (active & (1 << i))
+			{
+				activePlanes[activeCount++] = i;
+			}
+		}
+		const unsigned short CUTTING = (1 << 4) | (0x0F << 6);
+
+		//Each shared corner only gets moved into place and tested against the planes once, rather than once for every face that uses it
+		output->vertices.resize(mesh.positions.size());
+		output->outcodes.resize(mesh.positions.size());
+		//Every vertex is taken into the world once here, so nothing after this needs the transform for them
+		cmde::VEC3F position = world.Position();
+		for (size_t i = 0; i < mesh.positions.size(); i++)
 		{
-			if (DotProduct(t.vertices[i] - inBounds.point, inBounds.normal) < 0)
+			cmde::VEC3F p = (world.translationOnly ? mesh.positions[i] + position : world.ToWorld(mesh.positions[i]));
+			output->vertices[i] = p;
+			unsigned short code = 0;
+			for (short j = 0; j < activeCount; j++)
 			{
-				oob[i] = true;
-				c++;
+				short plane = activePlanes[j];
+				if (DotProduct(p, clipPlanes[plane].normal) < offsets[plane])
+				{
+					code |= 1 << plane;
+				}
 			}
+			output->outcodes[i] = code;
 		}
 
-		//Apparently the inside of a switch is all considered the same scope, so you can't have 2 variables with the same name in different cases
-		cmde::VEC3F g;
-		cmde::VEC3F g1;
-		cmde::VEC3F g2;
-		cmde::VEC3F new1;
-		cmde::VEC3F new2;
-		//Must flip the booleans around if c is 2 because then the one that is inside the bounds is the one that's needed
-		if (c == 2)
+		output->faces.clear();
+		output->faces.reserve(mesh.FaceCount());
+		output->skippedFaces = 0;
+		//The camera in the mesh's space (The side planes all go through it)
+		cmde::VEC3F viewer = world.ToLocal(inBounds[0].point);
+		const unsigned short* codes = output->outcodes.data();
+		const unsigned int* order = (frontToBack && mesh.meshlets.size() >= SORT_MIN_MESHLETS ? SortMeshlets(mesh, world.DirectionToLocal(forwards) * world.scale, output) : nullptr);
+		for (size_t k = 0; k < mesh.meshlets.size(); k++)
 		{
-			for (short i = 0; i < 3; i++)
+			const Meshlet& m = mesh.meshlets[order ? order[k] : k];
+			if (MeshletHidden(m, viewer, world, clipPlanes, offsets, activePlanes, activeCount))
+			{
+				output->skippedFaces += m.count;
+				continue;
+			}
+			const unsigned int* faces = &mesh.meshletFaces[m.first];
+			if (activeCount == 0)
+			{
+				//Entirely inside (See CullObject()), so there's nothing to test
+				for (unsigned int i = 0; i < m.count; i++)
+				{
+					const unsigned int* index = &mesh.indices[faces[i] * 3];
+					output->faces.push_back({ { index[0], index[1], index[2] }, faces[i], mesh.edges[faces[i]] });
+				}
+				continue;
+			}
+			for (unsigned int i = 0; i < m.count; i++)
 			{
-				oob[i] = !oob[i];
+				unsigned int f = faces[i];
+				const unsigned int* index = &mesh.indices[f * 3];
+				unsigned short c0 = codes[index[0]], c1 = codes[index[1]], c2 = codes[index[2]];
+				if (c0 & c1 & c2 & 0x3F)
+				{
+					//All 3 corners are outside the same plane
+					continue;
+				}
+				unsigned short cut = (c0 | c1 | c2) & CUTTING;
+				if (cut == 0)
+				{
+					//Nothing that needs cutting, so the indices just get passed along
+					output->faces.push_back({ { index[0], index[1], index[2] }, f, mesh.edges[f] });
+					continue;
+				}
+				ClipPolygon(output, index, f, mesh.edges[f], cut, clipPlanes, offsets);
 			}
 		}
-		short o = 0;
+	}
+
+					/// <summary>Puts 'mesh''s meshlets in order from nearest to furthest along 'forwards' (In the mesh's space) into 'output''s meshletOrder, unless the order it already holds for 'mesh' was sorted facing close enough to the same way, and returns it</summary>
+	static const unsigned int* SortMeshlets(const Mesh& mesh, cmde::VEC3F forwards, ClippedMesh* output)
+	{
+		size_t count = mesh.meshlets.size();
+		if (output->sortedMesh == &mesh && output->meshletOrder.size() == count && DotProduct(forwards, output->sortedFacing) >= cosf(SORT_REUSE_ANGLE * RAD))
+			return output->meshletOrder.data();
+		//Where the camera is only adds the same amount to every depth, so the depths are taken from the mesh's origin, where every meshlet's nearest point is between -3 and 1 times the mesh's radius (A meshlet's sphere can be twice as big as the mesh's)
+		output->sortKeys.resize(count);
+		float scale = 65535.0f / (4 * max(mesh.radius, FLT_MIN));
+		for (size_t i = 0; i < count; i++)
+		{
+			const Meshlet& m = mesh.meshlets[i];
+			float depth = DotProduct(m.center, forwards) - m.radius + 3 * mesh.radius;
+			output->sortKeys[i] = (unsigned short)min(max(depth * scale, 0.0f), 65535.0f);
+		}
+		output->meshletOrder.resize(count);
+		output->sortScratch.resize(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			output->meshletOrder[i] = (unsigned int)i;
+		}
+		RadixSort(output->meshletOrder.data(), count, output->sortKeys.data(), output->sortScratch.data());
+		output->sortedMesh = &mesh;
+		output->sortedFacing = forwards;
+		return output->meshletOrder.data();
+	}
+
+					/// <summary>Whether none of a meshlet's faces could get drawn, because its bounding sphere is outside 1 of the active planes out of the first 6, or every face in it faces away from 'viewer' (Which is in the mesh's space, unlike the planes)</summary>
+	static bool MeshletHidden(const Meshlet& meshlet, cmde::VEC3F viewer, const WorldTransform& world, const PLANE planes[10], const float offsets[10], const short activePlanes[10], short activeCount)
+	{
+		cmde::VEC3F center = world.ToWorld(meshlet.center);
+		float radius = meshlet.radius * world.scale;
+		for (short j = 0; j < activeCount; j++)
+		{
+			short plane = activePlanes[j];
+			if (plane < 6 && DotProduct(center, planes[plane].normal) - offsets[plane] < -radius)
+				return true;
+		}
+		if (meshlet.coneSine > 1)
+			return false;
+		//If every point of the sphere is within (90 degrees - the cone's half-angle) of the axis as seen from the viewer, then no normal in the cone can point back towards it
+		cmde::VEC3F toCenter = meshlet.center - viewer;
+		return DotProduct(toCenter, meshlet.axis) - meshlet.radius >= meshlet.coneSine * (Magnitude(toCenter) + meshlet.radius);
+	}
+
+					/// <summary>Cuts a face down to the part that's inside every plane picked by the bits of 'cut', and adds what's left to 'output' as a fan of triangles (Sutherland-Hodgman, with the new corners added to the end of its vertices)</summary>
+	static void ClipPolygon(ClippedMesh* output, const unsigned int corners[3], unsigned int face, unsigned char edges, unsigned short cut, const PLANE planes[10], const float offsets[10])
+	{
+		std::vector<cmde::VEC3F>& vertices = output->vertices;
+		//Each plane adds 1 corner at most, and the polygon gets passed back and forth between the 2 halves
+		unsigned int polygon[2][13];
+		//Whether the edge from each corner to the next one is 1 of the face's own (visible) edges
+		bool visible[2][13];
+		short count = 3;
+		short current = 0;
 		for (short i = 0; i < 3; i++)
 		{
-			if (oob[i])
+			polygon[0][i] = corners[i];
+			visible[0][i] = ((edges >> i) & 1) != 0;
+		}
+		for (short p = 0; p < 10; p++)
+		{
+			if (!(cut & (1 << p)))
+				continue;
+			unsigned int* in = polygon[current];
+			bool* inVisible = visible[current];
+			unsigned int* out = polygon[1 - current];
+			bool* outVisible = visible[1 - current];
+			short outCount = 0;
+			for (short i = 0; i < count; i++)
 			{
-				o = i;
-				g = t.vertices[i];
-				g1 = t.vertices[(i + 1) % 3];
-				g2 = t.vertices[(i + 2) % 3];
-				break;
+				unsigned int a = in[i];
+				unsigned int b = in[(i + 1) % count];
+				float da = DotProduct(vertices[a], planes[p].normal) - offsets[p];
+				float db = DotProduct(vertices[b], planes[p].normal) - offsets[p];
+				if (da >= 0)
+				{
+					out[outCount] = a;
+					outVisible[outCount++] = inVisible[i];
+				}
+				if ((da >= 0) != (db >= 0))
+				{
+					vertices.push_back(vertices[a] + (vertices[b] - vertices[a]) * (da / (da - db)));
+					out[outCount] = (unsigned int)vertices.size() - 1;
+					//On the way out, the edge from here runs along the plane, and on the way back in it's what's left of edge 'i'
+					outVisible[outCount++] = (da < 0 && inVisible[i]);
+				}
 			}
+			count = outCount;
+			current = 1 - current;
+			if (count < 3)
+				return;
 		}
-		RayPlaneIntersection(inBounds, g, g1 - g, &new1);
-		RayPlaneIntersection(inBounds, g, g2 - g, &new2);
 
-		switch (c)
+		unsigned int* fan = polygon[current];
+		bool* fanVisible = visible[current];
+		for (short i = 1; i < count - 1; i++)
 		{
-		case 0:
-			output->push_back(Triangle(t));
-			break;
-		case 3:
-			//nothing
-			break;
-		case 1:
-			output->push_back(Triangle(new1, g1, g2, t.color, true && t.visibleSides[o], true && t.visibleSides[(o + 1) % 3], false));
-			output->push_back(Triangle(new1, g2, new2, t.color, false, true && t.visibleSides[(o + 2) % 3], false));
-			break;
-		case 2:
-			output->push_back(Triangle(g, new1, new2, t.color, true && t.visibleSides[o], false, true && t.visibleSides[(o + 2) % 3]));
-			break;
+			//The diagonals inside the polygon are never drawn in wireframe
+			unsigned char e = (unsigned char)((i == 1 && fanVisible[0]) | fanVisible[i] << 1 | (i == count - 2 && fanVisible[count - 1]) << 2);
+			output->faces.push_back({ { fan[0], fan[i], fan[i + 1] }, face, e });
 		}
 	}
 
@@ -2127,47 +5945,72 @@ class Test3D : public cmde::CMDEngine
 					/// </summary>
 					/// <param name="origin">The point from ray starts at</param>
 					/// <param name="direction">The direction the ray goes</param>
-					/// <param name="objects">The objects to test against</param>
+					/// <param name="scene">The objects to test against (Only the ones flagged Scene::RAYCASTABLE)</param>
 					/// <param name="output">The vector in which to store the data of every hit</param>
-	static bool RaycastAll(cmde::VEC3F origin, cmde::VEC3F direction, std::vector<Object>& objects, std::vector<RaycastHit>* output, std::vector<Object*>& ignore = *new std::vector<Object*>())
+	static bool RaycastAll(cmde::VEC3F origin, cmde::VEC3F direction, const Scene& scene, cmde::ARENAVECTOR<RaycastHit>* output, const std::vector<ObjectHandle>* ignore = nullptr)
 	{
 		//Camera::mirrorPoints.clear();
 		direction = Normalize(direction);
-		cmde::VEC3F dirDiv = { 1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z };
+		for (size_t i = 0; i < scene.Size(); i++)
+		{
+			if (!(scene.flags[i] & Scene::RAYCASTABLE) || (ignore != nullptr && std::find(ignore->begin(), ignore->end(), scene.handles[i]) != ignore->end()))
+			{
+				continue;
+			}
+			RaycastObject(origin, direction, scene.handles[i], scene.meshes[i], scene.colors[i], &scene.boxes[i * 2], scene.worlds[i], output);
+		}
+		return output->size() > 0;
+	}
+					/// <summary>Casts a ray and detects every plane of the objects in a render packet with which it intersects (Uses the positions stored in the packet, not the objects' current ones)</summary> /// <param name="origin">The point from ray starts at</param> /// <param name="direction">The direction the ray goes</param> /// <param name="draws">The draw commands of the objects to test against</param> /// <param name="output">The vector in which to store the data of every hit</param>
+	static bool RaycastAll(cmde::VEC3F origin, cmde::VEC3F direction, std::vector<DrawCommand>& draws, cmde::ARENAVECTOR<RaycastHit>* output)
+	{
+		direction = Normalize(direction);
+		for (DrawCommand& d : draws)
+		{
+			RaycastObject(origin, direction, d.object, d.mesh, d.colors, d.box, d.world, output);
+		}
+		return output->size() > 0;
+	}
+
+					/// <summary>Tests a ray against 1 object, drawing 'meshRef' (With the bounding box 'box' in its own space) placed by 'world', adding every hit to 'output' ('direction' must already be normalized)</summary>
+	static void RaycastObject(cmde::VEC3F origin, cmde::VEC3F direction, ObjectHandle object, const std::shared_ptr<const Mesh>& meshRef, const std::shared_ptr<const std::vector<short>>& colors, const cmde::VEC3F box[2], const WorldTransform& world, cmde::ARENAVECTOR<RaycastHit>* output)
+	{
+		const Mesh& mesh = *meshRef;
 		cmde::VEC3F t1, t2, nearest;
-		Triangle tOff = { cmde::VEC3F(), cmde::VEC3F(), cmde::VEC3F() };
 		cmde::VEC3F point = cmde::VEC3F();
-		for (Object& o : objects)
+		cmde::VEC3F position = world.Position();
+		nearest = origin + direction * DotProduct(position - origin, direction) - position;
+		if (Pow2(world.radius) >= DotProduct(nearest, nearest))
 		{
-			if (ignore.size() > 0 && std::find(ignore.begin(), ignore.end(), &o) != ignore.end())
+			//Ray passes through this object's bounding sphere (Could possibly collide)
+			//	From here on the ray is in the mesh's space, where the box is the mesh's own and the faces can be read straight out of the mesh
+			cmde::VEC3F localOrigin = world.ToLocal(origin);
+			cmde::VEC3F localDirection = world.DirectionToLocal(direction);
+			cmde::VEC3F dirDiv = Reciprocal(localDirection);
+			t1 = (box[0] - localOrigin) * dirDiv;
+			t2 = (box[1] - localOrigin) * dirDiv;
+			if (max(max(min(t1.z, t2.z), min(t1.x, t2.x)), min(t1.y, t2.y)) <= min(min(max(t1.z, t2.z), max(t1.x, t2.x)), max(t1.y, t2.y)))
 			{
-				continue;
-			}
-			nearest = origin + direction * DotProduct(o.position - origin, direction) - o.position;
-			if (Pow2(o.mesh.radius) >= DotProduct(nearest, nearest))
-			{
-				//Ray passes through this object's bounding sphere (Could possibly collide)
-				t1 = (o.aabb[0] + o.position - origin) * dirDiv;
-				t2 = (o.aabb[1] + o.position - origin) * dirDiv;
-				if (max(max(min(t1.z, t2.z), min(t1.x, t2.x)), min(t1.y, t2.y)) <= min(min(max(t1.z, t2.z), max(t1.x, t2.x)), max(t1.y, t2.y)))
+				//Ray passes through this object's bounding box (Could possibly collide)
+				for (size_t f = 0; f < mesh.FaceCount(); f++)
 				{
-					//Ray passes through this object's axis aligned bounding box (Could possibly collide)
-					for (Triangle& t : o.mesh.triangles)
+					if (RayHitsFace(mesh, f, localOrigin, localDirection, &point))
 					{
-						if (DotProduct(t.normal, direction) < 0)
-						{
-							tOff = Triangle(t.vertices[0] + o.position, t.vertices[1] + o.position, t.vertices[2] + o.position);
-							if (RayPlaneIntersection(PLANE(tOff.vertices[0], tOff.normal), origin, direction, &point) && PointInTriangle(point, tOff))
-							{
-								//Camera::mirrorPoints.push_back(point);
-								output->push_back(RaycastHit(PLANE(point, tOff.normal), &o, &t));
-							}
-						}
+						//Camera::mirrorPoints.push_back(point);
+						output->push_back(RaycastHit(PLANE(world.ToWorld(point), world.NormalToWorld(mesh.normals[f])), object, meshRef, colors, f));
 					}
 				}
 			}
 		}
-		return output->size() > 0;
+	}
+
+					/// <summary>Whether a ray hits the front of face 'f' of 'mesh', with the ray ('origin' and 'direction') and the hit point ('point') in the mesh's space</summary>
+	static bool RayHitsFace(const Mesh& mesh, size_t f, cmde::VEC3F origin, cmde::VEC3F direction, cmde::VEC3F* point)
+	{
+		if (DotProduct(mesh.normals[f], direction) >= 0)
+			return false;
+		Triangle t = mesh.GetTriangle(f);
+		return RayPlaneIntersection(PLANE(t.vertices[0], t.normal), origin, direction, point) && PointInTriangle(*point, t);
 	}
 
 public:
@@ -2177,10 +6020,79 @@ public:
 	Camera camera;
 	bool myRenderingSystem;
 	bool wireframe;
-	std::vector<Object> objects = {};
+	//Everything in the world
+	Scene scene;
+	//The cube that FixedUpdate() moves, and the object that LoadObject() puts loaded meshes on (And that 'g' exports)
+	ObjectHandle movingObject;
+	ObjectHandle loadTarget;
 	short selCol = 0x0000;
 	short selPost = 0x0000;
-	static int rayCount;
+	//Where the mouse was when the last frame's events ended (Where this frame's mouse path starts)
+	short lastMouse[2] = { 0, 0 };
+	//How fast the camera turns while the mouse is at the edge of the screen, in degrees per second
+	float turnSpeed = 24.0f;
+	static std::atomic<int> rayCount;
+	//Results of the last BenchmarkMath(): nanoseconds per face clipped by ClipTriangles() (All 6 planes), nanoseconds per PointInTriangle() call, and the % of points that were inside (0 until it's been run)
+	std::atomic<float> mathBenchmark[3] = {};
+	//Extra cameras drawn alongside 'camera', each into its own part of the screen (See Camera::SetViewport(); 'v' toggles a split screen)
+	std::vector<Camera> views;
+	//How many objects the last frame's culling dropped, drew without clipping, and had to clip (Indexed by CullResult, written by the render stage)
+	std::atomic<int> cullCounts[CULL_RESULT_COUNT] = {};
+	//How many faces the objects that weren't culled last frame had, at the levels of detail they were drawn with
+	std::atomic<int> drawnFaces = 0;
+	//How many of those were skipped by meshlet culling
+	std::atomic<int> skippedFaces = 0;
+	//How many bytes the meshes of the last frame's draw commands take up, counting each shared mesh once (See Mesh::MemoryUsed())
+	std::atomic<size_t> meshMemory = 0;
+	//Whether DrawGeometry() skips objects hidden behind the biggest ones (Toggled with 'o')
+	bool occlusionCulling = true;
+	//Whether DrawGeometry() draws objects and big meshes' meshlets nearest first (Toggled with 'z'; See SORT_MIN_MESHLETS)
+	bool depthSorting = true;
+	//How many more frames a draw command's object skips the occlusion test for (Reset whenever the slot's object changes)
+	struct OcclusionState
+	{
+		ObjectHandle object;
+		unsigned char skipTests;
+	};
+	//How many of this frame's draw commands draw each mesh (Counted once per draw command, only for the ones that are just moved, and shared by every viewport)
+	std::unordered_map<const Mesh*, unsigned int> meshUses;
+	//What the render stage keeps for each viewport ('camera' first, then 'views'), so they can all be drawn at the same time and don't reallocate between frames
+	struct ViewportState
+	{
+		//Each object's faces after clipping, filled in parallel and then drawn in order (Indexed like the packet's draws)
+		std::vector<ClippedMesh> clippedObjects;
+		std::vector<OcclusionState> occlusionStates;
+		//The occluders' depths in the viewport, rebuilt every frame
+		cmde::OCCLUSIONBUFFER occlusionBuffer;
+		//Per mesh in 'meshUses' drawn more than once, its positions in clip space for this viewport's camera (Filled in by whichever object drawing it gets drawn first)
+		std::unordered_map<const Mesh*, cmde::VEC4F*> sharedPoints;
+		//The draw commands' indices in the order they get drawn (Nearest first with depth sorting on), which way the camera was facing when they were sorted, and how many frames ago that was
+		std::vector<unsigned int> drawOrder;
+		cmde::VEC3F sortedFacing;
+		unsigned char sortAge = 0;
+	};
+	std::vector<ViewportState> viewportStates;
+
+	//Everything the render stage needs for 1 frame, so that it never has to look at the live scene while Update() changes it
+	struct RenderPacket
+	{
+		Camera camera;
+		std::vector<Camera> views;
+		std::vector<DrawCommand> draws;
+		//Each draw command's bounding sphere (See Scene::spheres), packed together for CullSpheres()
+		std::vector<cmde::VEC4F> spheres;
+		bool myRenderingSystem;
+		bool wireframe;
+		bool occlusionCulling;
+		bool depthSorting;
+		short selCol;
+		short selPost;
+	};
+	cmde::PACKETBUFFER<RenderPacket> packets;
+	//Changes to meshes made during Update(), held back until SyncFrame() so that they all land between 2 frames (They replace the scene's meshes and colors rather than editing them, so the packet being drawn keeps the old ones)
+	std::vector<std::function<void()>> pendingEdits;
+	//The moving cube's simulated position on the previous and the latest 'FixedUpdate()' (It gets drawn in between the 2)
+	cmde::VEC3F movingPos[2];
 
 
 	Test3D(short screenWidth, short screenHeight, short fontWidth, short fontHeight) : cmde::CMDEngine(screenWidth, screenHeight, fontWidth, fontHeight, true, true, FPS60)
@@ -2448,13 +6360,25 @@ public:
 		});
 		*/
 
-		obj1 = Object(cube1, cmde::VEC3F(0, 0, 0));
-		obj1.mesh.ChangeColor(0x00AA);
-		obj1.mesh.triangles.at(9).color = 0x02CC;
-		objects.push_back(obj1);
-		obj2 = Object(cube1, cmde::VEC3F(0, 1, 0));
-		obj2.mesh.ChangeColor(0x00BB);
-		objects.push_back(obj2);
+		//Both cubes draw the same mesh, and only keep their own colors
+		std::shared_ptr<const Mesh> cube = std::make_shared<const Mesh>(std::move(cube1));
+		obj1 = Object(cube, cmde::VEC3F(0, 0, 0));
+		obj1.ChangeColor(0x00AA);
+		obj1.SetColor(9, 0x02CC);
+		movingObject = scene.Add(obj1);
+		obj2 = Object(cube, cmde::VEC3F(0, 1, 0));
+		obj2.ChangeColor(0x00BB);
+		loadTarget = scene.Add(obj2);
+		//A smaller cube sitting turned on top of them, attached to the moving one so that it gets carried along (See Scene::UpdateTransforms())
+		Object rider(cube, cmde::VEC3F(0.5f, 2, 0.15f));
+		rider.SetRotation(cmde::VEC3F(0, 45, 0));
+		rider.SetScale(0.5f);
+		rider.ChangeColor(0x00DD);
+		scene.Add(rider, movingObject);
+		movingPos[0] = movingPos[1] = obj1.position;
+		fixedTimeStep = 0.01f;
+		pipelineFrames = true;
+		autoTune = true;
 		myRenderingSystem = false;
 		wireframe = false;
 		emptyChar.Attributes = 0x0088;
@@ -2470,47 +6394,632 @@ public:
 
 	void Setup()
 	{
+		//Passes are listed in the order they'd run in serially, and the render graph runs the ones that don't touch the same resources in parallel
+		//	(Ex. the HUD gets drawn while the geometry is still being rasterized, and is only redrawn when the pallet changes)
+		renderGraph.AddPass(L"Geometry", 0, RES_DEPTH | RES_COLOR, [this]() { DrawGeometry(packets.Front()); });
+		//Reads back the colors and depths the geometry left on the screen to find mirror pixels
+		renderGraph.AddPass(L"Mirrors", RES_DEPTH | RES_COLOR, RES_DEPTH | RES_COLOR, [this]() { Mirrors(packets.Front()); });
+		renderGraph.AddPass(L"Pallet", 0, RES_HUD, [this]() { DrawPallet(cmde::LAYER_HUD, 3, 0, 25, 10, packets.Front().selCol, packets.Front().selPost); }, [this]() { return (size_t)(unsigned short)packets.Front().selCol << 16 | (unsigned short)packets.Front().selPost; });
+		renderGraph.AddPass(L"Crosshair", 0, RES_HUD, [this]() { DrawCrosshair(cmde::LAYER_HUD, packets.Front().camera.viewport); }, [this]() { return (size_t)(unsigned short)packets.Front().camera.viewport.Left << 16 | (unsigned short)packets.Front().camera.viewport.Right; });
+		renderGraph.AddPass(L"HUD", RES_HUD | RES_DEPTH | RES_COLOR, RES_DEPTH | RES_COLOR, [this]() { CompositeHUD(); });
+		renderGraph.AddPass(L"Stats", 0, RES_DEPTH | RES_COLOR, [this]() { DrawStats(); });
+	}
 
+	void FixedUpdate()
+	{
+		//Move object
+		movingPos[0] = movingPos[1];
+		movingPos[1] = movingPos[1] + cmde::VEC3F(0.1f, 0, 0) * fixedTimeStep;
 	}
 
 	void Update()
 	{
-		Test3D::rayCount = 0;
-		wchar_t print[128] = {};
-		int printLength = 0;
+		//Public update:
+			//Place the moving object between its last 2 simulated positions
+			scene.SetPosition(movingObject, movingPos[0] + (movingPos[1] - movingPos[0]) * interpolationAlpha);
 
-		camera.UpdateInBounds();
-		camera.UpdateRotation();
+			Inputs();
 
-		//Public update:
-			//Move object
-			objects.at(0).position = objects.at(0).position + cmde::VEC3F(0.1f, 0, 0) * deltaTime;
+		//After the inputs, so that the clipping planes and the projection matrix match where the camera is this frame
+		camera.Update();
+		for (Camera& view : views)
+		{
+			view.Update();
+		}
+		scene.UpdateTransforms();
+
+		//Hand the frame over to the render stage
+		RenderPacket& packet = packets.Back();
+		packet.camera = camera;
+		packet.views = views;
+		packet.draws.clear();
+		packet.spheres.clear();
+		for (size_t i = 0; i < scene.Size(); i++)
+		{
+			if (!(scene.flags[i] & Scene::VISIBLE))
+				continue;
+			cmde::VEC4F sphere = scene.spheres[i];
+			float cells = camera.CoveredCells(cmde::VEC3F(sphere), sphere.w);
+			scene.lods[i] = scene.meshes[i]->PickLod(scene.lods[i], cells);
+			packet.draws.push_back({ scene.handles[i], scene.meshes[i], scene.colors[i], scene.worlds[i], { scene.boxes[i * 2], scene.boxes[i * 2 + 1] }, scene.lods[i], cells });
+			packet.spheres.push_back(sphere);
+		}
+		packet.myRenderingSystem = myRenderingSystem;
+		packet.wireframe = wireframe;
+		packet.occlusionCulling = occlusionCulling;
+		packet.depthSorting = depthSorting;
+		packet.selCol = selCol;
+		packet.selPost = selPost;
+	}
+
+	//Times the vector math on every loaded triangle, clipping them against the camera's bounds and testing points against them
+	//	(Building once with CMDE_SCALAR_MATH defined gives the numbers to compare against)
+	void BenchmarkMath(int rounds)
+	{
+		std::vector<Triangle> triangles;
+		for (size_t i = 0; i < scene.Size(); i++)
+		{
+			for (size_t f = 0; f < scene.meshes[i]->FaceCount(); f++)
+			{
+				triangles.push_back(scene.meshes[i]->GetTriangle(f, scene.worlds[i]));
+			}
+		}
+		if (triangles.empty() || rounds <= 0)
+			return;
+		ClippedMesh clipped;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int r = 0; r < rounds; r++)
+		{
+			for (size_t i = 0; i < scene.Size(); i++)
+			{
+				ClipTriangles(*scene.meshes[i], scene.worlds[i], camera.inBounds, &clipped);
+			}
+		}
+		float clipTime = std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+		//Half the points are inside their triangle (Weighted towards the 3rd corner) and half are off past the 1st corner, so neither answer gets predicted every time
+		int inside = 0;
+		start = std::chrono::steady_clock::now();
+		for (int r = 0; r < rounds; r++)
+		{
+			for (size_t i = 0; i < triangles.size(); i++)
+			{
+				Triangle& t = triangles[i];
+				cmde::VEC3F point = (i & 1 ? t.vertices[0] * 2 - (t.vertices[1] + t.vertices[2]) * 0.5f : (t.vertices[0] + t.vertices[1]) * 0.25f + t.vertices[2] * 0.5f);
+				inside += PointInTriangle(point, t);
+			}
+		}
+		float pointTime = std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+		mathBenchmark[0] = clipTime / ((float)rounds * triangles.size());
+		mathBenchmark[1] = pointTime / ((float)rounds * triangles.size());
+		mathBenchmark[2] = inside * 100.0f / ((float)rounds * triangles.size());
+	}
+
+					/// <summary>Runs the headless checks (Started with '--check' on the command line, see main()), printing each result, and returns how many failed</summary>
+	static int RunChecks()
+	{
+		int failed = 0;
+		//A low frame rate too, since that's where taps used to get lost and turning used to go slower
+		for (float fps : { 60.0f, 10.0f })
+		{
+			failed += !CheckScriptedInput(fps);
+		}
+		failed += !CheckScene();
+		failed += !CheckTransforms();
+		return failed;
+	}
+
+					/// <summary>
+					/// Adds, removes and re-adds objects in a Scene, checking that a removed object's handle stops working even once its slot is reused, that what was attached to it gets detached,
+					/// that the objects after it still point at the right parents, that SetParent() only takes parents that come first, and that RaycastAll() skips objects that aren't RAYCASTABLE
+					/// </summary>
+	static bool CheckScene()
+	{
+		//A 1x1 square facing -Z (Towards the ray below)
+		std::vector<Triangle> triangles{
+			{ { 0, 0, 0 }, { 0, 1, 0 }, { 1, 0, 0 }, 0x00AA },
+			{ { 0, 1, 0 }, { 1, 1, 0 }, { 1, 0, 0 }, 0x00AA }
+		};
+		std::shared_ptr<const Mesh> square = std::make_shared<const Mesh>(triangles);
+		Scene scene;
+		ObjectHandle parent = scene.Add(Object(square, { 0, 0, 1 }));
+		ObjectHandle child = scene.Add(Object(square, { 0, 0, 2 }), parent);
+		ObjectHandle later = scene.Add(Object(square, { 0, 0, 4 }));
+		ObjectHandle laterChild = scene.Add(Object(square, { 0, 0, 1 }), later);
+		scene.UpdateTransforms();
+		bool passed = scene.worlds[scene.Index(child)].Position().z == 3;
+
+		//Everything after the removed object shifts down 1, and the child is left where its own transform puts it, now relative to the world
+		scene.Remove(parent);
+		scene.UpdateTransforms();
+		passed = passed && !scene.Valid(parent) && scene.Index(parent) == UINT_MAX && scene.Size() == 3;
+		passed = passed && scene.Index(child) == 0 && scene.parents[0] == -1 && scene.worlds[0].Position().z == 2;
+		passed = passed && scene.Index(later) == 1 && scene.Index(laterChild) == 2 && scene.parents[2] == 1 && scene.worlds[2].Position().z == 5;
+
+		//The freed slot gets reused, but with a new generation, so the old handle still refers to nothing (Removing it again does nothing)
+		ObjectHandle reused = scene.Add(Object(square, { 0, 0, 6 }));
+		scene.Remove(parent);
+		passed = passed && reused.slot == parent.slot && reused.generation == parent.generation + 1;
+		passed = passed && scene.Valid(reused) && scene.Index(reused) == 3 && scene.Index(parent) == UINT_MAX && scene.Size() == 4;
+
+		//Parents have to come before their children, so attaching to a later object or to itself does nothing
+		scene.SetParent(later, reused);
+		scene.SetParent(laterChild, laterChild);
+		scene.SetParent(reused, child);
+		passed = passed && scene.parents[1] == -1 && scene.parents[2] == 1 && scene.parents[3] == 0;
+		scene.SetParent(reused, ObjectHandle());
+
+		//A ray through every square (Away from the edge between its 2 triangles) hits the child first, then the later object once the child can't be hit
+		cmde::FRAMEARENA arena;
+		RaycastHit hit;
+		passed = passed && hit.Raycast({ 0.25f, 0.5f, -5 }, { 0, 0, 1 }, scene, arena) && hit.object == child;
+		scene.SetFlags(child, Scene::VISIBLE);
+		passed = passed && hit.Raycast({ 0.25f, 0.5f, -5 }, { 0, 0, 1 }, scene, arena) && hit.object == later && hit.Color() == 0x00AA;
+
+		wprintf(L"%ls Scene add, remove and reuse\n", (passed ? L"PASS" : L"FAIL"));
+		return passed;
+	}
 
-			if (myRenderingSystem)
+					/// <summary>
+					/// Checks a turned and scaled cube, attached to a turned parent, against the same cube built straight into the world:
+					/// clipping it with its transform has to keep the same front faces as clipping the world space copy (With or without culling first), and raycasts in its own space have to hit the same points as raycasts against the world space faces
+					/// </summary>
+	static bool CheckTransforms()
+	{
+		std::vector<Triangle> triangles{
+			{ { 0, 0, 0 }, { 0, 1, 0 }, { 1, 0, 0 }, 0x00AA },
+			{ { 0, 1, 0 }, { 1, 1, 0 }, { 1, 0, 0 }, 0x00AA },
+			{ { 0, 0, 0 }, { 1, 0, 0 }, { 0, 0, 1 }, 0x00AA },
+			{ { 1, 0, 0 }, { 1, 0, 1 }, { 0, 0, 1 }, 0x00AA },
+			{ { 1, 0, 0 }, { 1, 1, 0 }, { 1, 0, 1 }, 0x00AA },
+			{ { 1, 1, 0 }, { 1, 1, 1 }, { 1, 0, 1 }, 0x00AA },
+			{ { 0, 1, 0 }, { 0, 1, 1 }, { 1, 1, 1 }, 0x00AA },
+			{ { 0, 1, 0 }, { 1, 1, 1 }, { 1, 1, 0 }, 0x00AA },
+			{ { 0, 0, 0 }, { 0, 0, 1 }, { 0, 1, 1 }, 0x00AA },
+			{ { 0, 0, 0 }, { 0, 1, 1 }, { 0, 1, 0 }, 0x00AA },
+			{ { 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 }, 0x00AA },
+			{ { 0, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 }, 0x00AA }
+		};
+		std::shared_ptr<const Mesh> cube = std::make_shared<const Mesh>(triangles);
+		Scene scene;
+		Object base(cube);
+		base.SetRotation({ 10, 30, 0 });
+		ObjectHandle parent = scene.Add(base);
+		Object child(cube, { 1, 0.5f, 0.5f });
+		child.SetRotation({ 25, -40, 15 });
+		child.SetScale(1.5f);
+		ObjectHandle turned = scene.Add(child, parent);
+		std::vector<ObjectHandle> ignore = { parent };
+
+		//A camera at the origin looking along +Z with a 90 degree field of view (Sides first, then near and far, like Camera::UpdateInBounds())
+		PLANE inBounds[6] = {
+			PLANE({ 0, 0, 0 }, { 1, 0, 1 }), PLANE({ 0, 0, 0 }, { -1, 0, 1 }), PLANE({ 0, 0, 0 }, { 0, 1, 1 }), PLANE({ 0, 0, 0 }, { 0, -1, 1 }),
+			PLANE({ 0, 0, 0.1f }, { 0, 0, 1 }), PLANE({ 0, 0, 50 }, { 0, 0, -1 })
+		};
+		//How many faces facing the camera are left after clipping, and how much area they cover
+		auto frontFaces = [](const ClippedMesh& clipped, const WorldTransform& world, float* area)
+		{
+			int count = 0;
+			*area = 0;
+			for (const ClippedFace& f : clipped.faces)
 			{
-				for (Object& o : objects)
+				const cmde::VEC3F& a = clipped.vertices[f.corners[0]];
+				if (DotProduct(world.NormalToWorld(clipped.mesh->normals[f.face]), a) < 0)
 				{
-					camera.RenderShapeSpherical(o, wireframe);
+					count++;
+					*area += Magnitude(CrossProduct(clipped.vertices[f.corners[1]] - a, clipped.vertices[f.corners[2]] - a)) * 0.5f;
 				}
 			}
-			else
+			return count;
+		};
+
+		bool passed = true;
+		int placements = 0;
+		int mismatches = 0;
+		unsigned int seed = 12345;
+		cmde::FRAMEARENA arena;
+		ClippedMesh full, culled, reference;
+		//Placed inside, outside, across the sides and across the near and far planes
+		for (float z : { -3.0f, -0.5f, 0.5f, 4.0f, 12.0f, 49.0f, 60.0f })
+		{
+			for (float x = -16; x <= 16; x += 4)
+			{
+				scene.SetPosition(parent, { x, -0.75f, z });
+				scene.UpdateTransforms();
+				const WorldTransform& world = scene.worlds[scene.Index(turned)];
+				placements++;
+
+				std::vector<Triangle> placed;
+				for (size_t f = 0; f < cube->FaceCount(); f++)
+				{
+					placed.push_back(cube->GetTriangle(f, world));
+				}
+				Object flat(std::make_shared<const Mesh>(placed));
+				ClipTriangles(*flat.mesh, flat.world, inBounds, &reference);
+				ClipTriangles(*cube, world, inBounds, &full);
+				unsigned char planes;
+				if (CullObject(*cube, world, inBounds, &planes) == CULL_OUTSIDE)
+				{
+					culled.faces.clear();
+				}
+				else
+				{
+					ClipTriangles(*cube, world, inBounds, &culled, planes);
+				}
+				float referenceArea, fullArea, culledArea;
+				int referenceCount = frontFaces(reference, flat.world, &referenceArea);
+				int fullCount = frontFaces(full, world, &fullArea);
+				int culledCount = frontFaces(culled, world, &culledArea);
+				if (fullCount != referenceCount || culledCount != referenceCount || fabsf(fullArea - referenceArea) > 1e-3f * (1 + referenceArea) || fabsf(culledArea - referenceArea) > 1e-3f * (1 + referenceArea))
+				{
+					mismatches++;
+				}
+
+				//Rays from the camera spread across the cube and a bit past it
+				for (int r = 0; r < 50; r++)
+				{
+					seed = seed * 1103515245 + 12345;
+					float dx = (float)((seed >> 8) % 1000) / 1000.0f * 3 - 1.5f;
+					seed = seed * 1103515245 + 12345;
+					float dy = (float)((seed >> 8) % 1000) / 1000.0f * 3 - 1.5f;
+					cmde::VEC3F origin = { 0, 0, 0 };
+					cmde::VEC3F direction = Normalize(world.Position() + cmde::VEC3F(dx, dy, 0) - origin);
+					float nearest = -1;
+					cmde::VEC3F nearestPoint;
+					for (Triangle& t : placed)
+					{
+						cmde::VEC3F point;
+						if (DotProduct(t.normal, direction) < 0 && RayPlaneIntersection(PLANE(t.vertices[0], t.normal), origin, direction, &point) && PointInTriangle(point, t))
+						{
+							float distance = Magnitude(point - origin);
+							if (nearest < 0 || distance < nearest)
+							{
+								nearest = distance;
+								nearestPoint = point;
+							}
+						}
+					}
+					RaycastHit hit;
+					bool hitLocal = hit.Raycast(origin, direction, scene, arena, &ignore);
+					if (hitLocal != (nearest >= 0) || (hitLocal && (hit.object != turned || Magnitude(hit.plane.point - nearestPoint) > 1e-3f * (1 + nearest))))
+					{
+						mismatches++;
+					}
+				}
+				arena.Reset();
+			}
+		}
+		passed = mismatches == 0;
+		wprintf(L"%ls Turned and scaled objects: %d mismatches over %d placements of clipping and raycasts against world space copies\n", (passed ? L"PASS" : L"FAIL"), mismatches, placements);
+		return passed;
+	}
+
+					/// <summary>
+					/// Plays a script through SCRIPTEDINPUT at 'fps' frames per second and checks what it did to the camera
+					/// The mouse spends 0.5 seconds at the right edge, which should turn it by 0.5 * 'turnSpeed' degrees at any frame rate, and 'w' gets tapped for 10 milliseconds, which should move it exactly 1 step even when the tap starts and ends within 1 frame
+					/// </summary>
+	static bool CheckScriptedInput(float fps)
+	{
+		struct ScriptedRun : public Test3D
+		{
+			cmde::SCRIPTEDINPUT script;
+			int framesAfter = 0;
+
+			ScriptedRun(float fps) : Test3D(250, 250, 3, 3)
+			{
+				fpsLimit = 1 / fps;
+				autoTune = false;
+				//Starts in the middle, away from every edge
+				lastMouse[0] = lastMouse[1] = 125;
+				script.MouseMove(0.1f, 240, 125);
+				script.Key(0.3f, L'w', true);
+				script.Key(0.31f, L'w', false);
+				script.MouseMove(0.6f, 125, 125);
+				SetInputSource(&script);
+			}
+
+			void Update()
 			{
-				for (Object& o : objects)
+				Test3D::Update();
+				//A few more frames once the script's done, so that its last events have been read and applied
+				if (script.Finished() && ++framesAfter > 3)
 				{
-					camera.RenderShapeProjection(o, wireframe);
+					running = false;
 				}
 			}
+		};
+		ScriptedRun run(fps);
+		cmde::VEC3F startPosition = run.camera.position;
+		cmde::VEC2F startFacing = run.camera.facing;
+		run.Start();
+		float turned = run.camera.facing.x - startFacing.x;
+		float moved = Magnitude(run.camera.position - startPosition);
+		//The turn is timed off of when the events came in, so it's allowed a little scheduling jitter
+		bool passed = fabsf(turned + 0.5f * run.turnSpeed) < 0.5f && run.camera.facing.y == startFacing.y && fabsf(moved - 0.05f) < 0.001f;
+		wprintf(L"%ls Scripted input at %.0f FPS: turned %.2f degrees (Expected %.2f), moved %.3f (Expected 0.050)\n", (passed ? L"PASS" : L"FAIL"), fps, turned, -0.5f * run.turnSpeed, moved);
+		return passed;
+	}
 
-			Inputs();
-			DrawPallet(3, 0, 25, 10);
+	void SyncFrame()
+	{
+		for (std::function<void()>& edit : pendingEdits)
+		{
+			edit();
+		}
+		pendingEdits.clear();
+		packets.Swap();
+	}
+
+	void DrawGeometry(RenderPacket& packet)
+	{
+		for (std::atomic<int>& count : cullCounts)
+		{
+			count = 0;
+		}
+		drawnFaces = 0;
+		skippedFaces = 0;
+		//The draw commands (With their transforms and levels of detail) and which meshes they share are the same for every viewport, so only the camera's part gets redone per viewport
+		meshUses.clear();
+		size_t memory = 0;
+		cmde::ARENAVECTOR<const Mesh*> counted(FrameArena());
+		for (DrawCommand& d : packet.draws)
+		{
+			//Turned or scaled objects can't start from the shared projection (See Camera::ProjectInstance())
+			if (d.world.translationOnly)
+			{
+				meshUses[&d.mesh->Lod(d.lod)]++;
+			}
+			if (std::find(counted.begin(), counted.end(), d.mesh.get()) == counted.end())
+			{
+				counted.push_back(d.mesh.get());
+				memory += d.mesh->MemoryUsed();
+			}
+		}
+		meshMemory = memory;
+		cmde::ARENAVECTOR<Camera*> cameras(FrameArena());
+		cameras.push_back(&packet.camera);
+		for (Camera& view : packet.views)
+		{
+			cameras.push_back(&view);
+		}
+		viewportStates.resize(cameras.size());
+
+		//Viewports cover different cells, so they're drawn at the same time (Each one only draws inside its own, see Camera::DrawProjection())
+		jobs.ParallelFor(0, (int)cameras.size(), 1, [this, &packet, &cameras](int begin, int end)
+		{
+			for (int v = begin; v < end; v++)
+			{
+				DrawViewport(packet, *cameras[v], viewportStates[v]);
+			}
+		});
+	}
+
+					/// <summary>Draws the packet's draw commands through 'camera' into its viewport, using the occluders of the viewport first if occlusion culling is on</summary>
+	void DrawViewport(RenderPacket& packet, Camera& camera, ViewportState& view)
+	{
+		view.clippedObjects.resize(packet.draws.size());
+		view.occlusionStates.resize(packet.draws.size(), { ObjectHandle(), 0 });
+		view.sharedPoints.clear();
+		SortDraws(packet, camera, view);
+		//Objects entirely outside the camera get dropped in 1 sweep over the packed spheres, before they can take up an occluder's place or a clipping job
+		cmde::ARENAVECTOR<unsigned char> outside(FrameArena());
+		outside.resize(packet.draws.size());
+		CullSpheres(packet.spheres.data(), packet.spheres.size(), camera.inBounds, outside.data());
+
+		//The box test projects corners the same way DrawProjection() does, so it doesn't match the spherical renderer, and wireframes don't hide anything
+		bool occlusion = packet.occlusionCulling && !packet.myRenderingSystem && !packet.wireframe;
+		cmde::ARENAVECTOR<unsigned int> occluders(FrameArena());
+		cmde::ARENAVECTOR<unsigned int> others(FrameArena());
+		if (occlusion)
+		{
+			//The draw commands' sizes are from the main camera, so other viewports work out their own
+			cmde::ARENAVECTOR<float> cells(FrameArena());
+			cells.resize(packet.draws.size());
+			float minCells = OCCLUDER_MIN_COVERAGE * camera.screenSize.X * camera.screenSize.Y;
+			for (unsigned int i = 0; i < packet.draws.size(); i++)
+			{
+				DrawCommand& d = packet.draws[i];
+				cells[i] = (&camera == &packet.camera ? d.cells : camera.CoveredCells(d.world.Position(), d.world.radius));
+				if (!outside[i] && cells[i] >= minCells)
+				{
+					occluders.push_back(i);
+				}
+			}
+			std::sort(occluders.begin(), occluders.end(), [&cells](unsigned int a, unsigned int b) { return cells[a] > cells[b]; });
+			if (occluders.size() > OCCLUDER_COUNT)
+			{
+				occluders.resize(OCCLUDER_COUNT);
+			}
+		}
+		//Both lists keep the draw order, so the occluders also get drawn nearest first
+		cmde::ARENAVECTOR<unsigned int> picked(FrameArena());
+		picked.swap(occluders);
+		for (unsigned int i : view.drawOrder)
+		{
+			if (outside[i])
+			{
+				cullCounts[CULL_OUTSIDE]++;
+				continue;
+			}
+			(std::find(picked.begin(), picked.end(), i) == picked.end() ? others : occluders).push_back(i);
+		}
+
+		//The occluders get drawn like anything else, and then the depths they left behind are what the rest get tested against
+		ClipAndDraw(packet, camera, view, occluders, false);
+		if (!occluders.empty())
+		{
+			view.occlusionBuffer.Build(zBuffer, screenSize.X, screenSize.Y, camera.viewport);
+		}
+		ClipAndDraw(packet, camera, view, others, !occluders.empty());
+	}
+
+					/// <summary>Fills in the viewport's draw order, nearest object first along the camera's facing if the packet has depth sorting on (Keeping the last order while it's still close enough, see SORT_REUSE_ANGLE), or in the packet's order if not</summary>
+	void SortDraws(RenderPacket& packet, Camera& camera, ViewportState& view)
+	{
+		size_t count = packet.draws.size();
+		cmde::VEC3F forwards = camera.inBounds[4].normal;
+		if (packet.depthSorting && view.drawOrder.size() == count && view.sortAge > 0 && view.sortAge < SORT_REUSE_FRAMES && DotProduct(forwards, view.sortedFacing) >= cosf(SORT_REUSE_ANGLE * RAD))
+		{
+			view.sortAge++;
+			return;
+		}
+		view.drawOrder.resize(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			view.drawOrder[i] = (unsigned int)i;
+		}
+		view.sortAge = 0;
+		if (!packet.depthSorting)
+			return;
+		//Each object's key is how far along 'forwards' its world box's nearest corner is, as a fraction of the far plane's distance (Anything behind the camera is at 0, since it's culled anyways)
+		cmde::ARENAVECTOR<unsigned short> keys(FrameArena());
+		cmde::ARENAVECTOR<unsigned int> scratch(FrameArena());
+		keys.resize(count);
+		scratch.resize(count);
+		cmde::VEC3F reach(fabsf(forwards.x), fabsf(forwards.y), fabsf(forwards.z));
+		float scale = 65535.0f / camera.farPlane;
+		for (size_t i = 0; i < count; i++)
+		{
+			DrawCommand& d = packet.draws[i];
+			cmde::VEC3F center = (d.world.aabb[0] + d.world.aabb[1]) * 0.5f;
+			float depth = DotProduct(center - camera.position, forwards) - DotProduct((d.world.aabb[1] - d.world.aabb[0]) * 0.5f, reach);
+			keys[i] = (unsigned short)min(max(depth * scale, 0.0f), 65535.0f);
+		}
+		RadixSort(view.drawOrder.data(), count, keys.data(), scratch.data());
+		view.sortedFacing = forwards;
+		view.sortAge = 1;
+	}
 
-		Mirrors();
+					/// <summary>Culls and clips the packet's draw commands listed in 'draws' for 'camera' in parallel, and then draws them one after the other into its viewport (Skipping the ones hidden behind the viewport's occlusion buffer if 'testOcclusion' is set)</summary>
+	void ClipAndDraw(RenderPacket& packet, Camera& camera, ViewportState& view, const cmde::ARENAVECTOR<unsigned int>& draws, bool testOcclusion)
+	{
+		//Clipping only reads the objects, so every object gets clipped in parallel, and then they're drawn in order
+		jobs.ParallelFor(0, (int)draws.size(), 1, [this, &packet, &camera, &view, &draws, testOcclusion](int begin, int end)
+		{
+			for (int j = begin; j < end; j++)
+			{
+				unsigned int i = draws[j];
+				DrawCommand& d = packet.draws[i];
+				OcclusionState& state = view.occlusionStates[i];
+				if (state.object != d.object)
+				{
+					state = { d.object, 0 };
+				}
+				unsigned char planes;
+				CullResult result = CullObject(*d.mesh, d.world, camera.inBounds, &planes);
+				if (result != CULL_OUTSIDE && testOcclusion)
+				{
+					//Only a visible result gets reused, since drawing something that's hidden costs time but hiding something that's visible is wrong
+					if (state.skipTests > 0)
+					{
+						state.skipTests--;
+					}
+					else if (camera.BoxOccluded(d.world.aabb[0], d.world.aabb[1], view.occlusionBuffer))
+					{
+						result = CULL_OCCLUDED;
+					}
+					else
+					{
+						state.skipTests = OCCLUSION_REUSE_FRAMES;
+					}
+				}
+				const Mesh& mesh = d.mesh->Lod(d.lod);
+				ClippedMesh& clipped = view.clippedObjects[i];
+				if (result == CULL_OUTSIDE || result == CULL_OCCLUDED)
+				{
+					clipped.mesh = &mesh;
+					clipped.vertices.clear();
+					clipped.faces.clear();
+					clipped.skippedFaces = 0;
+				}
+				else
+				{
+					ClipTriangles(mesh, d.world, camera.inBounds, &clipped, planes, packet.depthSorting);
+					drawnFaces += (int)mesh.FaceCount();
+					skippedFaces += (int)clipped.skippedFaces;
+				}
+				clipped.colors = d.colors.get();
+				cullCounts[result]++;
+			}
+		});
+		for (unsigned int i : draws)
+		{
+			ClippedMesh& clipped = view.clippedObjects[i];
+			if (packet.myRenderingSystem)
+			{
+				camera.DrawSpherical(clipped, packet.wireframe);
+			}
+			else
+			{
+				//Meshes that more than 1 object draws only get taken to clip space once, by whichever of them gets drawn first (Turned or scaled objects still project their own, see DrawGeometry())
+				cmde::VEC4F* shared = nullptr;
+				std::unordered_map<const Mesh*, unsigned int>::iterator uses = meshUses.find(clipped.mesh);
+				if (!clipped.faces.empty() && clipped.world.translationOnly && uses != meshUses.end() && uses->second > 1)
+				{
+					cmde::VEC4F*& points = view.sharedPoints[clipped.mesh];
+					if (!points)
+					{
+						points = (cmde::VEC4F*)FrameArena().Allocate(sizeof(cmde::VEC4F) * clipped.mesh->positions.size());
+						camera.ProjectShared(*clipped.mesh, points);
+					}
+					shared = points;
+				}
+				camera.DrawProjection(clipped, packet.wireframe, shared);
+			}
+		}
+	}
 
-		DrawLineS(cmde::VEC2F(0.495f, 0.5f), cmde::VEC2F(0.51f, 0.5f), 0x00FF);
-		DrawLineS(cmde::VEC2F(0.5f, 0.495f), cmde::VEC2F(0.5f, 0.51f), 0x00FF);
+					/// <summary>Draws the crosshair on 'layer' in the middle of 'area' (The main camera's viewport, so that it stays on what the camera's pointing at)</summary>
+	void DrawCrosshair(cmde::LAYER layer, SMALL_RECT area)
+	{
+		float width = (float)(area.Right - area.Left + 1);
+		float height = (float)(area.Bottom - area.Top + 1);
+		DrawLineTo(layer, area.Left + width * 0.495f, area.Top + height * 0.5f, area.Left + width * 0.51f, area.Top + height * 0.5f, 0x00FF);
+		DrawLineTo(layer, area.Left + width * 0.5f, area.Top + height * 0.495f, area.Left + width * 0.5f, area.Top + height * 0.51f, 0x00FF);
+	}
 
-		printLength = swprintf(print, 128, L"Ray Count: %d", Test3D::rayCount);
+	void DrawStats()
+	{
+		wchar_t print[256] = {};
+		int printLength = 0;
+		printLength = swprintf(print, 256, L"Ray Count: %d", Test3D::rayCount.load());
 		WriteText(0, 15, print, printLength, 0x000F, -5);
+		cmde::JOBSYSTEM::STATS jobStats = jobs.GetStats();
+		printLength = swprintf(print, 256, L"Jobs: %d threads | %d queued | %lld steals | Input: %u dropped", jobStats.workerCount, jobStats.queueDepth, jobStats.steals, DroppedInputs());
+		WriteText(0, 16, print, printLength, 0x000F, -5);
+		cmde::FRAMEARENA& arena = FrameArena();
+		printLength = swprintf(print, 256, L"Frame arena: %zuKB used | %zuKB reserved | %zuKB peak | Meshes: %zuKB", arena.Used() / 1024, arena.Capacity() / 1024, arena.Peak() / 1024, meshMemory.load() / 1024);
+		WriteText(0, 20, print, printLength, 0x000F, -5);
+		printLength = swprintf(print, 256, L"Objects: %d culled | %d occluded | %d accepted | %d clipped | %d faces (%d skipped by meshlets)", cullCounts[CULL_OUTSIDE].load(), cullCounts[CULL_OCCLUDED].load(), cullCounts[CULL_INSIDE].load(), cullCounts[CULL_INTERSECTING].load(), drawnFaces.load(), skippedFaces.load());
+		WriteText(0, 21, print, printLength, 0x000F, -5);
+		//Every other pass has finished by now, so their timings are this frame's (This one's is from the last frame)
+		printLength = swprintf(print, 256, L"Passes:");
+		for (const cmde::RENDERGRAPH::PASS& p : renderGraph.Passes())
+		{
+			if (p.skipped)
+			{
+				printLength += swprintf(print + printLength, 256 - printLength, L" %ls skipped |", p.name);
+			}
+			else
+			{
+				printLength += swprintf(print + printLength, 256 - printLength, L" %ls %.2fms |", p.name, p.time * 1000.0f);
+			}
+		}
+		WriteText(0, 17, print, printLength - 2, 0x000F, -5);
+		printLength = swprintf(print, 256, L"Tuning: %d threads | grain %d | %ls clear | %ls present", tuning.threads, tuning.pixelGrain,
+			(tuning.clearKernel == cmde::CLEAR_SSE2 ? L"SSE2" : L"scalar"), (tuning.presentMode == cmde::PRESENT_SYNC ? L"sync" : L"async"));
+		WriteText(0, 18, print, printLength, 0x000F, -5);
+		if (mathBenchmark[0] > 0)
+		{
+#ifdef CMDE_SIMD_MATH
+			const wchar_t* mathKind = L"SSE";
+#else
+			const wchar_t* mathKind = L"scalar";
+#endif
+			printLength = swprintf(print, 256, L"Math (%ls): Clip %.1fns/face | PointInTriangle %.1fns (%.0f%% inside)", mathKind, mathBenchmark[0].load(), mathBenchmark[1].load(), mathBenchmark[2].load());
+			WriteText(0, 19, print, printLength, 0x000F, -5);
+		}
 
 		//Debug UI
 		/*
@@ -2538,30 +7047,30 @@ public:
 		*/
 	}
 
-	void DrawPallet(short topLeftX, short topLeftY, short bottomRightX, short bottomRightY)
+	void DrawPallet(cmde::LAYER layer, short topLeftX, short topLeftY, short bottomRightX, short bottomRightY, short selCol, short selPost)
 	{
 		short sizeX = bottomRightX - topLeftX - 1;
 		short offsetX = (short)ceilf(sizeX * 0.20f);
 		sizeX -= 2 * offsetX;
 		short sizeY = bottomRightY - topLeftY - 1;
-		DrawLine(topLeftX, topLeftY, bottomRightX, topLeftY, 0x0000, 0x2588, -1, -1);
-		DrawLine(topLeftX, topLeftY, topLeftX, bottomRightY, 0x0000, 0x2588, -1, -1);
-		DrawLine(bottomRightX, topLeftY, bottomRightX, bottomRightY, 0x0000, 0x2588, -1, -1);
-		DrawLine(topLeftX, bottomRightY, bottomRightX, bottomRightY, 0x0000, 0x2588, -1, -1);
+		DrawLineTo(layer, topLeftX, topLeftY, bottomRightX, topLeftY, 0x0000, 0x2588, -1, -1);
+		DrawLineTo(layer, topLeftX, topLeftY, topLeftX, bottomRightY, 0x0000, 0x2588, -1, -1);
+		DrawLineTo(layer, bottomRightX, topLeftY, bottomRightX, bottomRightY, 0x0000, 0x2588, -1, -1);
+		DrawLineTo(layer, topLeftX, bottomRightY, bottomRightX, bottomRightY, 0x0000, 0x2588, -1, -1);
 		for (short i = 0; i < sizeX; i++)
 		{
 			for (short j = 0; j < sizeY; j++)
 			{
-				Draw(topLeftX + 1 + 0			+ i,	topLeftY + 1 + j, 0x0080 + (selCol + 15) % 16,	0x2592);
-				Draw(topLeftX + 1 + offsetX		+ i,	topLeftY + 1 + j, selCol * 17,					0x2588, -2);
-				Draw(topLeftX + 1 + 2 * offsetX + i,	topLeftY + 1 + j, 0x0080 + (selCol + 1) % 16,	0x2592);
+				DrawTo(layer, topLeftX + 1 + 0			+ i,	topLeftY + 1 + j, 0x0080 + (selCol + 15) % 16,	0x2592);
+				DrawTo(layer, topLeftX + 1 + offsetX		+ i,	topLeftY + 1 + j, selCol * 17,					0x2588, -2);
+				DrawTo(layer, topLeftX + 1 + 2 * offsetX + i,	topLeftY + 1 + j, 0x0080 + (selCol + 1) % 16,	0x2592);
 			}
 		}
 		if (selPost == 0x0000)
 		{
 			wchar_t print[128] = {};
 			int printLength = swprintf(print, 128, L"Regular Mode");
-			WriteText(topLeftX, bottomRightY + 1, print, printLength);
+			WriteTextTo(layer, topLeftX, bottomRightY + 1, print, printLength);
 		}
 		else
 		{
@@ -2569,7 +7078,7 @@ public:
 			{
 				wchar_t print[128] = {};
 				int printLength = swprintf(print, 128, L"Mirror Mode");
-				WriteText(topLeftX, bottomRightY + 1, print, printLength);
+				WriteTextTo(layer, topLeftX, bottomRightY + 1, print, printLength);
 			}
 		}
 	}
@@ -2584,16 +7093,69 @@ public:
 		camera.position = camera.position + camera.up * (inputs[L'e'] >= 2 ? 0.05f : 0);
 
 		//Looking
-		camera.facing.x += (inputs[MOUSE_X] > 200 ? -0.4f : 0); // right
-		camera.facing.x += (inputs[MOUSE_X] < 50 ? 0.4f : 0); // left
-		camera.facing.y += (inputs[MOUSE_Y] > 200 ? -0.4f : 0); // bottom
-		camera.facing.y += (inputs[MOUSE_Y] < 50 ? 0.4f : 0); // top
+		//	Follows the mouse's moves in the order they happened, adding up how long it spent at each edge, so the turning is the same at any frame rate
+		float edgeTime[4] = { 0, 0, 0, 0 }; //Right, left, bottom, top
+		short mouse[2] = { lastMouse[0], lastMouse[1] };
+		std::chrono::steady_clock::time_point from = inputFrameStart;
+		auto AddEdgeTime = [&](std::chrono::steady_clock::time_point until)
+		{
+			float time = max(0.0f, std::chrono::duration<float>(until - from).count());
+			edgeTime[0] += (mouse[0] > 200 ? time : 0);
+			edgeTime[1] += (mouse[0] < 50 ? time : 0);
+			edgeTime[2] += (mouse[1] > 200 ? time : 0);
+			edgeTime[3] += (mouse[1] < 50 ? time : 0);
+			from = max(from, until);
+		};
+		for (const cmde::INPUTEVENT& e : inputEvents)
+		{
+			if (e.record.EventType == MOUSE_EVENT && e.record.Event.MouseEvent.dwEventFlags == MOUSE_MOVED)
+			{
+				AddEdgeTime(min(e.time, inputFrameEnd));
+				mouse[0] = e.record.Event.MouseEvent.dwMousePosition.X;
+				mouse[1] = e.record.Event.MouseEvent.dwMousePosition.Y;
+			}
+		}
+		AddEdgeTime(inputFrameEnd);
+		lastMouse[0] = mouse[0];
+		lastMouse[1] = mouse[1];
+		camera.facing.x += (edgeTime[1] - edgeTime[0]) * turnSpeed;
+		camera.facing.y += (edgeTime[3] - edgeTime[2]) * turnSpeed;
 
 		//Rendering
 		if (inputs[L'r'] == 2)
 		{
 			myRenderingSystem = !myRenderingSystem;
 		}
+		if (inputs[L'o'] == 2)
+		{
+			occlusionCulling = !occlusionCulling;
+		}
+		if (inputs[L'z'] == 2)
+		{
+			depthSorting = !depthSorting;
+		}
+		//Split screen, with a 2nd camera looking down on the cubes from the side
+		if (inputs[L'v'] == 2)
+		{
+			short half = screenSize.X / 2;
+			if (views.empty())
+			{
+				camera.SetViewport({ 0, 0, (short)(half - 1), (short)(screenSize.Y - 1) });
+				views.push_back(Camera({ 6, 3, 0.5f }, { -90, -25 }, { 90, 90 }, 0.1f, 200.0f, this));
+				views.back().SetViewport({ half, 0, (short)(screenSize.X - 1), (short)(screenSize.Y - 1) });
+			}
+			else
+			{
+				views.clear();
+				camera.SetViewport({ 0, 0, (short)(screenSize.X - 1), (short)(screenSize.Y - 1) });
+			}
+		}
+
+		//Benchmarking (Stalls this frame for a moment)
+		if (inputs[L'b'] == 2)
+		{
+			BenchmarkMath(200);
+		}
 
 		//Importing/Exporting
 		if (inputs[L'f'] == 2)
@@ -2603,19 +7165,13 @@ public:
 			{
 				if (file.HasExtension(L"obj"))
 				{
-					ObjFile output = ObjFile();
-					file.ProcessFile<ObjFile>(&output);
-					objects.at(1).mesh = Mesh(output.triangles);
-					objects.at(1).RecalculateAABB();
+					LoadObject<ObjFile>(file);
 				}
 				else
 				{
 					if (file.HasExtension(L"3D.cmde"))
 					{
-						CMDE3DFile output = CMDE3DFile();
-						file.ProcessFile<CMDE3DFile>(&output);
-						objects.at(1).mesh = Mesh(output.triangles);
-						objects.at(1).RecalculateAABB();
+						LoadObject<CMDE3DFile>(file);
 						//More data: sum = 0; frameAmount = 0; quickest = 100;
 					}
 				}
@@ -2626,7 +7182,11 @@ public:
 			cmde::FILE file;
 			if (PromptFileSave(&file, L"CMDE 3D", L"*.3D.cmde"))
 			{
-				CMDE3DFile::Export(file, objects.at(1).mesh);
+				unsigned int i = scene.Index(loadTarget);
+				if (i != UINT_MAX)
+				{
+					CMDE3DFile::Export(file, *scene.meshes[i], scene.colors[i].get());
+				}
 			}
 		}
 
@@ -2640,84 +7200,136 @@ public:
 		{
 			RaycastHit hit;
 			std::vector<Triangle> tempTriangles = std::vector<Triangle>();
-			if (hit.Raycast(camera.position, camera.forwards, objects))
+			if (hit.Raycast(camera.position, camera.forwards, scene, FrameArena()))
 			{
-				hit.triangle->color = selCol + selPost;
+				//Looked up again once the edit runs, in case an earlier edit this frame removes the object or replaces its mesh
+				ObjectHandle o = hit.object;
+				size_t f = hit.face;
+				short color = selCol + selPost;
+				pendingEdits.push_back([this, o, f, color]()
+				{
+					unsigned int i = scene.Index(o);
+					if (i != UINT_MAX && f < scene.meshes[i]->FaceCount())
+					{
+						scene.SetColor(o, f, color);
+					}
+				});
 			}
 		}
 	}
-	void Mirrors()
+	//Parses, builds, simplifies and bounds a mesh in the background, and then swaps it in for 'loadTarget' once it's done
+	template <class T>
+	void LoadObject(cmde::FILE& file)
+	{
+		std::shared_ptr<Object> loaded = std::make_shared<Object>();
+		tasks.Start(LoadObjectAsync<T>(file, loaded), [this, loaded]()
+		{
+			//Runs between frames, so nothing is drawing the old mesh (And the old colors were for its faces)
+			scene.SetMesh(loadTarget, loaded->mesh, loaded->aabb);
+		});
+	}
+	template <class T>
+	static cmde::TASK LoadObjectAsync(cmde::FILE file, std::shared_ptr<Object> output)
+	{
+		std::shared_ptr<T> parsed = std::make_shared<T>();
+		co_await cmde::FILE::ProcessFileAsync<T>(file, parsed);
+		//Only handed to the object once it's finished, since it can't change after it's shared
+		std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>();
+		co_await mesh->BuildAsync(parsed->triangles);
+		co_await mesh->GenerateLodsAsync();
+		output->mesh = mesh;
+		co_await output->RecalculateAABBAsync();
+	}
+	void Mirrors(RenderPacket& packet)
 	{
-		std::vector<Triangle> mirrorPolygons = std::vector<Triangle>();
-		for (Object& o : objects)
+		Test3D::rayCount = 0;
+		Camera& camera = packet.camera;
+		cmde::FRAMEARENA& arena = FrameArena();
+		cmde::ARENAVECTOR<FaceRef> mirrorFaces(arena);
+		for (size_t i = 0; i < packet.draws.size(); i++)
 		{
-			for (Triangle& t : o.mesh.triangles)
+			DrawCommand& d = packet.draws[i];
+			const Mesh& mesh = *d.mesh;
+			//Facing is checked in the mesh's space, so that only the camera needs moving there
+			cmde::VEC3F viewer = d.world.ToLocal(camera.position);
+			for (size_t f = 0; f < mesh.FaceCount(); f++)
 			{
-				Triangle t2 = t.GetWithOffset(o.position);
-				if ((t.color & 0x0F00) == 0x0200 && DotProduct(CrossProduct(t2.vertices[1] - t2.vertices[0], t2.vertices[2] - t2.vertices[0]), t2.vertices[0] - camera.position) < 0)
+				if ((d.Color(f) & 0x0F00) == 0x0200 && DotProduct(mesh.normals[f], mesh.positions[mesh.indices[f * 3]] - viewer) < 0)
 				{
 					//Triangle is a mirror and is facing the camera
-					mirrorPolygons.push_back(t.GetWithOffset(o.position));
+					mirrorFaces.push_back({ (unsigned int)i, (unsigned int)f });
 				}
 			}
 		}
-		Object mirrors = Object(*new Mesh(mirrorPolygons));
 
 		cmde::VEC3F leftStep = camera.left * ((tan(camera.fov.x * 0.5f * RAD) * camera.nearPlane) / (camera.screenSize.X * 0.5f) * -1.0f);
 		cmde::VEC3F upStep = camera.up * (tan(camera.fov.y * 0.5f * RAD) * camera.nearPlane) / (camera.screenSize.Y * 0.5f) * -1.0f;
 		cmde::VEC3F offset = (leftStep * (camera.screenSize.X * 0.5f - 0.5f) - camera.forwards * camera.nearPlane + upStep * (camera.screenSize.Y * 0.5f - 0.5f)) * -1.0f;
-		cmde::VEC3F worldPosX;
-		cmde::VEC3F dir;
-		RaycastHit hit;
-		for (int x = 0; x < camera.screenSize.X; x++)
+		//Every pixel only reads and writes itself, so the columns are split between the job system's threads
+		jobs.ParallelFor(0, camera.screenSize.X, 0, [&](int begin, int end)
 		{
-			worldPosX = leftStep * x + offset;
-			for (int y = 0; y < camera.screenSize.Y; y++)
+			cmde::VEC3F worldPosX;
+			cmde::VEC3F dir;
+			RaycastHit hit;
+			for (int x = begin; x < end; x++)
 			{
-				if (ScreenPosDrawnTo(x, y) && (ScreenPosColor(x, y) & 0x0F00) == 0x0200)
+				worldPosX = leftStep * x + offset;
+				for (int y = 0; y < camera.screenSize.Y; y++)
 				{
-					dir = worldPosX + upStep * y;
-					if (hit.Raycast(camera.position, dir, mirrors))
+					//'x' and 'y' are in the camera's viewport
+					short cellX = (short)(x + camera.viewport.Left);
+					short cellY = (short)(y + camera.viewport.Top);
+					if (ScreenPosDrawnTo(cellX, cellY) && (ScreenPosColor(cellX, cellY) & 0x0F00) == 0x0200)
 					{
-						
-						Draw(x, y,
-							//if
-							((hit.Raycast(hit.plane.point, dir + hit.plane.normal * -2.0f * DotProduct(dir, hit.plane.normal), objects)) ?
-								hit.triangle->color
-								: //else
-								emptyChar.Attributes)
-						);
-
-						/*
-						for (cmde::VEC3F v : Camera::points)
+						dir = worldPosX + upStep * y;
+						if (hit.Raycast(camera.position, dir, packet.draws, mirrorFaces))
 						{
-							cmde::VEC3F temp = v - camera.position;
+						
+							Draw(cellX, cellY,
+								//if
+								((hit.Raycast(hit.plane.point, dir + hit.plane.normal * -2.0f * DotProduct(dir, hit.plane.normal), packet.draws, arena)) ?
+									hit.Color()
+									: //else
+									emptyChar.Attributes)
+							);
+
+							/*
+							for (cmde::VEC3F v : Camera::points)
+							{
+								cmde::VEC3F temp = v - camera.position;
+								temp = { DotProduct(temp, camera.left), DotProduct(temp, camera.up), DotProduct(temp, camera.forwards) };
+								cmde::VEC2F screenPos = (camera.ProjectionMatrixify(temp) + cmde::VEC2F(1, 1)) * 0.5f * cmde::VEC2F(screenSize.X, screenSize.Y);
+								Draw(screenPos, 0x0033, 0x2588, -5);
+							}
+							cmde::VEC3F temp = hit.plane.point - camera.position;
 							temp = { DotProduct(temp, camera.left), DotProduct(temp, camera.up), DotProduct(temp, camera.forwards) };
 							cmde::VEC2F screenPos = (camera.ProjectionMatrixify(temp) + cmde::VEC2F(1, 1)) * 0.5f * cmde::VEC2F(screenSize.X, screenSize.Y);
 							Draw(screenPos, 0x0033, 0x2588, -5);
+							wchar_t print[128] = {};
+							swprintf(print, 128, L"Point: (%f;%f;%f)", hit.plane.point.x, hit.plane.point.y, hit.plane.point.z);
+							WriteText(0, 20, print, 41);
+							swprintf(print, 128, L"screenPos: (%f;%f)", screenPos.x, screenPos.y);
+							WriteText(0, 21, print, 41);
+							*/
 						}
-						cmde::VEC3F temp = hit.plane.point - camera.position;
-						temp = { DotProduct(temp, camera.left), DotProduct(temp, camera.up), DotProduct(temp, camera.forwards) };
-						cmde::VEC2F screenPos = (camera.ProjectionMatrixify(temp) + cmde::VEC2F(1, 1)) * 0.5f * cmde::VEC2F(screenSize.X, screenSize.Y);
-						Draw(screenPos, 0x0033, 0x2588, -5);
-						wchar_t print[128] = {};
-						swprintf(print, 128, L"Point: (%f;%f;%f)", hit.plane.point.x, hit.plane.point.y, hit.plane.point.z);
-						WriteText(0, 20, print, 41);
-						swprintf(print, 128, L"screenPos: (%f;%f)", screenPos.x, screenPos.y);
-						WriteText(0, 21, print, 41);
-						*/
 					}
 				}
 			}
-		}
+		});
 	}
 };
 
-int Test3D::rayCount = 0;
+std::atomic<int> Test3D::rayCount(0);
 //std::vector<cmde::VEC3F> Test3D::Camera::mirrorPoints = std::vector<cmde::VEC3F>();
 
-int main()
+int main(int argc, char** argv)
 {
+	//'--check' runs the headless checks instead of the game, exiting with how many failed
+	if (argc > 1 && strcmp(argv[1], "--check") == 0)
+	{
+		return Test3D::RunChecks();
+	}
+
 	//RotateShape game(120, 120, 1, 1);
 	//RotateShape game(400, 400, 2, 2);
 	Test3D game(250, 250, 3, 3);